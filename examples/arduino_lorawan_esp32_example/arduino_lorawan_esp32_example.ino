@@ -469,23 +469,13 @@ cMyLoRaWAN::setup() {
 
     this->RegisterListener(
         // use a lambda so we're "inside" the cMyLoRaWAN from public/private perspective
-        [](void *pClientInfo, uint32_t event) -> void {
-            auto const pThis = (cMyLoRaWAN *)pClientInfo;
-
-            // for tx start, we quickly capture the channel and the RPS
+        [](void * /* pClientInfo */, uint32_t event) -> void {
+            // for tx start, we quickly capture the channel and the RPS;
+            // the event's schema takes care of printing them.
             if (event == EV_TXSTART) {
-                // use another lambda to make log prints easy
-                myEventLog.logEvent(
-                    (void *) pThis,
+                myEventLog.logEvent<cEventLog::TxStartEvent>(
                     LMIC.txChnl,
-                    LMIC.rps,
-                    0,
-                    // the print-out function
-                    [](cEventLog::EventNode_t const *pEvent) -> void {
-                        Serial.print(F(" TX:"));
-                        myEventLog.printCh(std::uint8_t(pEvent->getData(0)));
-                        myEventLog.printRps(rps_t(pEvent->getData(1)));
-                    }
+                    LMIC.rps
                 );
             }
             // else if (event == some other), record with print-out function
@@ -697,13 +687,17 @@ cMyLoRaWAN::GetAbpProvisioningInfo(AbpProvisioningInfo *pAbpInfo) {
     if ((magicFlag1 != MAGIC1) || (magicFlag2 != MAGIC2)) {
          return false;
     }
+
+    // reject a damaged copy; convert one saved by an older library.
+    if (! rtcSavedSessionInfo.upgrade() || ! NetGetSessionState(state) || ! state.upgrade()) {
+         return false;
+    }
     DEBUG_PRINTF_TS("GetAbpProvisioningInfo()\n");
 
     pAbpInfo->DevAddr = rtcSavedSessionInfo.V2.DevAddr;
     pAbpInfo->NetID   = rtcSavedSessionInfo.V2.NetID;
     memcpy(pAbpInfo->NwkSKey, rtcSavedSessionInfo.V2.NwkSKey, 16);
     memcpy(pAbpInfo->AppSKey, rtcSavedSessionInfo.V2.AppSKey, 16);
-    NetGetSessionState(state);
     pAbpInfo->FCntUp   = state.V1.FCntUp;
     pAbpInfo->FCntDown = state.V1.FCntDown;
 
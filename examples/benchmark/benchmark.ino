@@ -0,0 +1,45 @@
+/*
+
+Module:  benchmark.ino
+
+Function:
+    Microbenchmarks for the per-event paths of arduino-lorawan.
+
+Copyright notice and License:
+    See LICENSE file accompanying this project.
+
+Author:
+    Terry Moore, MCCI Corporation	October 2026
+
+Notes:
+    Prints a table of times per operation on Serial at 115200 baud,
+    in cycles on Cortex-M3/M4/M7 and ESP32, otherwise in microseconds.
+    The device isn't provisioned and never transmits; the radio is
+    only initialized. The region is the one the LMIC is configured
+    for, so build once per region to compare them.
+
+    The same cases run on a host: see extras/host.
+
+*/
+
+#include "benchmark_cases.h"
+
+cBenchmarkLoRaWAN myLoRaWAN {};
+
+void setup() {
+    Serial.begin(115200);
+
+    // wait up to 5 seconds for USB serial to come up.
+    for (auto tStart = millis(); ! Serial && millis() - tStart < 5000; )
+        yield();
+
+    // not provisioned, so this returns false; the LMIC is set up anyway.
+    myLoRaWAN.begin();
+
+    Arduino_LoRaWAN_Benchmark bench(myLoRaWAN);
+
+    bench.run(Serial);
+}
+
+void loop() {
+}
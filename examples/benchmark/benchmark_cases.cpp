@@ -0,0 +1,414 @@
+/*
+
+Module:	benchmark_cases.cpp
+
+Function:
+	Arduino_LoRaWAN_Benchmark: the cases, and the harness that times them.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include "benchmark_cases.h"
+
+#include <Arduino_LoRaWAN_lmic.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+// a batch should take at least this many counts of the probe counter:
+// long enough that its resolution and the loop overhead don't matter.
+std::uint32_t getMinBatchCounts()
+    {
+    auto const pUnits = Arduino_LoRaWAN_Probes::getCounterUnits();
+
+    if (strcmp(pUnits, "us") == 0)
+        return 20000;
+    else if (strcmp(pUnits, "ns") == 0)
+        return 10000000;
+    else
+        return 2000000;
+    }
+
+// ... but never more than this many operations.
+constexpr unsigned kMaxIterations = 1u << 20;
+
+const std::uint8_t kPayload[12] = { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B };
+
+std::uint32_t readCounter()
+    {
+    return Arduino_LoRaWAN_Probes::readCounter();
+    }
+
+} // namespace
+
+/****************************************************************************\
+|
+|	The harness
+|
+\****************************************************************************/
+
+const Arduino_LoRaWAN_Benchmark::Case_t Arduino_LoRaWAN_Benchmark::kCases[] =
+    {
+    { "dispatch.txstart",       &Arduino_LoRaWAN_Benchmark::dispatchTxStart },
+    { "dispatch.txcomplete",    &Arduino_LoRaWAN_Benchmark::dispatchTxComplete },
+    { "session.build",          &Arduino_LoRaWAN_Benchmark::sessionBuild },
+    { "session.save.delta",     &Arduino_LoRaWAN_Benchmark::sessionSaveDelta },
+    { "session.save.full",      &Arduino_LoRaWAN_Benchmark::sessionSaveFull },
+    { "session.save.config",    &Arduino_LoRaWAN_Benchmark::sessionSaveConfig },
+    { "session.apply",          &Arduino_LoRaWAN_Benchmark::sessionApply },
+    { "sendbuffer.queue",       &Arduino_LoRaWAN_Benchmark::sendBufferQueue },
+#if ARDUINO_LORAWAN_BENCHMARK_HOST
+    { "sendbuffer.submit",      &Arduino_LoRaWAN_Benchmark::sendBufferSubmit },
+#endif
+    { "eventlog.enqueue",       &Arduino_LoRaWAN_Benchmark::eventLogEnqueue },
+    { "eventlog.drain",         &Arduino_LoRaWAN_Benchmark::eventLogDrain },
+    };
+
+void
+Arduino_LoRaWAN_Benchmark::print(
+    const char *s
+    )
+    {
+    this->m_pOut->write(reinterpret_cast<const std::uint8_t *>(s), strlen(s));
+    }
+
+void
+Arduino_LoRaWAN_Benchmark::run(
+    Print &out,
+    const char *pFilter
+    )
+    {
+    char line[96];
+    char region[16];
+
+    this->m_pOut = &out;
+    this->m_minBatchCounts = getMinBatchCounts();
+    Arduino_LoRaWAN_Probes::beginCounter();
+
+    this->m_eventLog.setSink(&this->m_sink);
+    this->m_eventLog.setDrainTimeLimit(1000);
+
+    snprintf(
+        line, sizeof(line),
+        "arduino-lorawan benchmark: region %s, times in %s, best and median of %u\n",
+        this->m_lorawan.GetRegionString(region, sizeof(region)),
+        Arduino_LoRaWAN_Probes::getCounterUnits(),
+        kBatches
+        );
+    this->print(line);
+
+    snprintf(line, sizeof(line), "%-24s %10s %10s %10s\n", "case", "iterations", "min/op", "median/op");
+    this->print(line);
+
+    for (auto const &c : kCases)
+        {
+        if (pFilter == nullptr || strstr(c.pName, pFilter) != nullptr)
+            this->runCase(c);
+        }
+    }
+
+void
+Arduino_LoRaWAN_Benchmark::runCase(
+    const Case_t &c
+    )
+    {
+    // warm up, then find how many operations make a batch long enough.
+    unsigned nIter = 1;
+
+    (this->*c.pFn)(nIter);
+    while (nIter < kMaxIterations && (this->*c.pFn)(nIter) < this->m_minBatchCounts)
+        nIter *= 2;
+
+    std::uint32_t counts[kBatches];
+
+    for (auto &count : counts)
+        count = (this->*c.pFn)(nIter);
+
+    // insertion sort: there are only a few.
+    for (unsigned i = 1; i < kBatches; ++i)
+        {
+        auto const v = counts[i];
+        unsigned j = i;
+
+        for (; j > 0 && counts[j - 1] > v; --j)
+            counts[j] = counts[j - 1];
+        counts[j] = v;
+        }
+
+    // per operation, in tenths.
+    auto const perOp = [nIter](std::uint32_t count) -> unsigned long
+        {
+        return (unsigned long) ((std::uint64_t(count) * 10 + nIter / 2) / nIter);
+        };
+    auto const best = perOp(counts[0]);
+    auto const median = perOp(counts[kBatches / 2]);
+    char line[96];
+
+    snprintf(
+        line, sizeof(line),
+        "%-24s %10u %8lu.%lu %8lu.%lu\n",
+        c.pName,
+        nIter,
+        best / 10, best % 10,
+        median / 10, median % 10
+        );
+    this->print(line);
+    }
+
+void
+Arduino_LoRaWAN_Benchmark::sendDone(
+    void *pCtx,
+    bool fSuccess
+    )
+    {
+    // nothing to do: the message is done, sent or not.
+    (void) pCtx;
+    (void) fSuccess;
+    }
+
+/****************************************************************************\
+|
+|	The cases
+|
+\****************************************************************************/
+
+// an event that changes nothing: DispatchEvent(), StandardEventProcessor(),
+// and UpdateFCntDown() finding FCntDown unchanged.
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::dispatchTxStart(
+    unsigned nIter
+    )
+    {
+    auto const tStart = readCounter();
+
+    for (unsigned i = 0; i < nIter; ++i)
+        this->m_lorawan.DispatchEvent(EV_TXSTART);
+
+    return readCounter() - tStart;
+    }
+
+// the end of every uplink: FCntUp has changed, so the session state is
+// built, compared with the last one, and saved as a delta.
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::dispatchTxComplete(
+    unsigned nIter
+    )
+    {
+    auto const tStart = readCounter();
+
+    for (unsigned i = 0; i < nIter; ++i)
+        {
+        ++LMIC.seqnoUp;
+        this->m_lorawan.DispatchEvent(EV_TXCOMPLETE);
+        }
+
+    return readCounter() - tStart;
+    }
+
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::sessionBuild(
+    unsigned nIter
+    )
+    {
+    Arduino_LoRaWAN::SessionState State;
+    auto const tStart = readCounter();
+
+    for (unsigned i = 0; i < nIter; ++i)
+        this->m_lorawan.BuildSessionState(State);
+
+    return readCounter() - tStart;
+    }
+
+// each save is marked as the event processor marks it: the counters
+// after an uplink, or everything after a downlink or join.
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::sessionSave(
+    unsigned nIter,
+    bool fAcceptDelta,
+    std::uint8_t dirty
+    )
+    {
+    this->m_lorawan.fAcceptDelta = fAcceptDelta;
+
+    auto const tStart = readCounter();
+
+    for (unsigned i = 0; i < nIter; ++i)
+        {
+        ++LMIC.seqnoUp;
+        this->m_lorawan.MarkSessionStateDirty(dirty);
+        this->m_lorawan.SaveSessionState();
+        }
+
+    auto const tEnd = readCounter();
+
+    this->m_lorawan.fAcceptDelta = true;
+    return tEnd - tStart;
+    }
+
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::sessionSaveDelta(
+    unsigned nIter
+    )
+    {
+    return this->sessionSave(nIter, true, Arduino_LoRaWAN::kSessionStateDirty_Counters);
+    }
+
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::sessionSaveFull(
+    unsigned nIter
+    )
+    {
+    return this->sessionSave(nIter, false, Arduino_LoRaWAN::kSessionStateDirty_Counters);
+    }
+
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::sessionSaveConfig(
+    unsigned nIter
+    )
+    {
+    return this->sessionSave(nIter, true, Arduino_LoRaWAN::kSessionStateDirty_Config);
+    }
+
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::sessionApply(
+    unsigned nIter
+    )
+    {
+    Arduino_LoRaWAN::SessionState State;
+
+    this->m_lorawan.BuildSessionState(State);
+
+    auto const tStart = readCounter();
+
+    for (unsigned i = 0; i < nIter; ++i)
+        this->m_lorawan.ApplySessionState(State);
+
+    return readCounter() - tStart;
+    }
+
+// the LMIC is busy, so each message is copied into the uplink queue; it
+// is then completed (unsent) by flushing the queue.
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::sendBufferQueue(
+    unsigned nIter
+    )
+    {
+    auto const opmode = LMIC.opmode;
+
+    LMIC.opmode |= OP_TXRXPEND;
+
+    auto const tStart = readCounter();
+
+    for (unsigned i = 0; i < nIter; ++i)
+        {
+        this->m_lorawan.SendBuffer(kPayload, sizeof(kPayload), sendDone, this, false);
+        this->m_lorawan.FlushUplinkQueue();
+        }
+
+    auto const tEnd = readCounter();
+
+    LMIC.opmode = opmode;
+    return tEnd - tStart;
+    }
+
+#if ARDUINO_LORAWAN_BENCHMARK_HOST
+// the LMIC is idle and joined, so each message goes straight to the
+// LMIC; it's then canceled, which completes it and saves the state.
+// Only on a host: on a board, the LMIC would start the radio.
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::sendBufferSubmit(
+    unsigned nIter
+    )
+    {
+    auto const devaddr = LMIC.devaddr;
+
+    LMIC.devaddr = 0x26000001;
+
+    auto const tStart = readCounter();
+
+    for (unsigned i = 0; i < nIter; ++i)
+        {
+        this->m_lorawan.SendBuffer(kPayload, sizeof(kPayload), sendDone, this, false);
+        LMIC_clrTxData();
+        }
+
+    auto const tEnd = readCounter();
+
+    LMIC.devaddr = devaddr;
+    return tEnd - tStart;
+    }
+#endif
+
+void
+Arduino_LoRaWAN_Benchmark::fillEventLog(
+    unsigned nEvents
+    )
+    {
+    for (unsigned i = 0; i < nEvents; ++i)
+        this->m_eventLog.logEvent<Arduino_LoRaWAN::cEventLogBase::TxStartEvent>(i & 7, 0x34);
+    }
+
+void
+Arduino_LoRaWAN_Benchmark::drainEventLog()
+    {
+    this->m_sink.clear();
+    this->m_eventLog.loop();
+    }
+
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::eventLogEnqueue(
+    unsigned nIter
+    )
+    {
+    std::uint32_t total = 0;
+
+    for (unsigned nDone = 0; nDone < nIter; )
+        {
+        auto const n = nIter - nDone < kEventLogCapacity ? nIter - nDone : kEventLogCapacity;
+        auto const tStart = readCounter();
+
+        this->fillEventLog(n);
+        total += readCounter() - tStart;
+
+        this->drainEventLog();
+        nDone += n;
+        }
+
+    return total;
+    }
+
+// to a binary sink in RAM, so this is the cost of the log, not of output.
+std::uint32_t
+Arduino_LoRaWAN_Benchmark::eventLogDrain(
+    unsigned nIter
+    )
+    {
+    std::uint32_t total = 0;
+
+    for (unsigned nDone = 0; nDone < nIter; )
+        {
+        auto const n = nIter - nDone < kEventLogCapacity ? nIter - nDone : kEventLogCapacity;
+
+        this->fillEventLog(n);
+
+        auto const tStart = readCounter();
+
+        this->drainEventLog();
+        total += readCounter() - tStart;
+        nDone += n;
+        }
+
+    return total;
+    }
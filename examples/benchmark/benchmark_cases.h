@@ -0,0 +1,153 @@
+/*
+
+Module:	benchmark_cases.h
+
+Function:
+	Microbenchmarks for the per-event paths of arduino-lorawan.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Notes:
+	The same cases run on a board (benchmark.ino) and on a host
+	(extras/host, target host_benchmark). Times are in counts of
+	the Arduino_LoRaWAN_Probes counter: CPU cycles on Cortex-M3/M4/M7
+	and ESP32, otherwise microseconds from micros(); nanoseconds on
+	a host.
+
+	Each case is calibrated so that a batch takes a few milliseconds,
+	then run in several batches. The minimum per operation is the
+	number to compare between runs; the median shows the noise.
+
+*/
+
+#ifndef _benchmark_cases_h_		/* prevent multiple includes */
+#define _benchmark_cases_h_
+
+#pragma once
+
+#include <Arduino_LoRaWAN_network.h>
+#include <Arduino_LoRaWAN_EventLog.h>
+
+///
+/// \brief the LoRaWAN object under test.
+///
+/// \details
+///     It isn't provisioned, so begin() only sets up the LMIC. Session
+///     state is saved nowhere, but the save is still built and compared.
+///
+class cBenchmarkLoRaWAN : public Arduino_LoRaWAN_network
+    {
+public:
+    cBenchmarkLoRaWAN() {}
+
+    /// \brief if true, accept delta saves; otherwise ask for full saves.
+    bool fAcceptDelta = true;
+
+protected:
+    virtual bool GetOtaaProvisioningInfo(OtaaProvisioningInfo *pInfo) override
+        {
+        (void) pInfo;
+        return false;
+        }
+
+    virtual void NetSaveSessionState(const SessionState &State) override
+        {
+        (void) State;
+        }
+
+    virtual bool NetSaveSessionStateDelta(
+        const SessionState &State,
+        size_t offset,
+        size_t nBytes
+        ) override
+        {
+        (void) State;
+        (void) offset;
+        (void) nBytes;
+        return this->fAcceptDelta;
+        }
+    };
+
+///
+/// \brief the benchmark suite.
+///
+/// \details
+///     Some cases call private members of Arduino_LoRaWAN, which
+///     names this class as a friend.
+///
+class Arduino_LoRaWAN_Benchmark
+    {
+public:
+    Arduino_LoRaWAN_Benchmark(cBenchmarkLoRaWAN &lorawan)
+        : m_lorawan(lorawan)
+        {}
+
+    ///
+    /// \brief run the cases and print the results.
+    ///
+    /// \param [in] out where to print.
+    /// \param [in] pFilter if not null, only run cases whose names
+    ///     contain this string.
+    ///
+    void run(Print &out, const char *pFilter = nullptr);
+
+private:
+    /// \brief a case: run \p nIter operations, and return the counts they took.
+    typedef std::uint32_t (Arduino_LoRaWAN_Benchmark::*CaseFn_t)(unsigned nIter);
+
+    struct Case_t
+        {
+        const char *pName;
+        CaseFn_t pFn;
+        };
+
+    static const Case_t kCases[];
+
+    /// \brief the number of timed batches for each case.
+    static constexpr unsigned kBatches = 11;
+
+    /// \brief the event log capacity for the event log cases.
+    static constexpr unsigned kEventLogCapacity = 32;
+
+    void runCase(const Case_t &c);
+    void print(const char *s);
+
+    std::uint32_t dispatchTxStart(unsigned nIter);
+    std::uint32_t dispatchTxComplete(unsigned nIter);
+    std::uint32_t sessionBuild(unsigned nIter);
+    std::uint32_t sessionSaveDelta(unsigned nIter);
+    std::uint32_t sessionSaveFull(unsigned nIter);
+    std::uint32_t sessionSaveConfig(unsigned nIter);
+    std::uint32_t sessionApply(unsigned nIter);
+    std::uint32_t sendBufferQueue(unsigned nIter);
+#if ARDUINO_LORAWAN_BENCHMARK_HOST
+    std::uint32_t sendBufferSubmit(unsigned nIter);
+#endif
+    std::uint32_t eventLogEnqueue(unsigned nIter);
+    std::uint32_t eventLogDrain(unsigned nIter);
+
+    std::uint32_t sessionSave(unsigned nIter, bool fAcceptDelta, std::uint8_t dirty);
+    void fillEventLog(unsigned nEvents);
+    void drainEventLog();
+
+    static void sendDone(void *pCtx, bool fSuccess);
+
+    cBenchmarkLoRaWAN &m_lorawan;
+    Print *m_pOut = nullptr;
+    std::uint32_t m_minBatchCounts = 0;
+    Arduino_LoRaWAN::cSizedEventLog<kEventLogCapacity> m_eventLog;
+    std::uint8_t m_sinkBuffer[kEventLogCapacity * Arduino_LoRaWAN_EventRecord::kMaxSize];
+    Arduino_LoRaWAN::cEventLogRamSink m_sink { m_sinkBuffer, sizeof(m_sinkBuffer) };
+    };
+
+#endif /* _benchmark_cases_h_ */
@@ -76,7 +76,6 @@ private:
     void doUplink();
 
     bool m_fUplinkRequest;              // set true when uplink is requested
-    bool m_fBusy;                       // set true while sending an uplink
     std::uint32_t m_uplinkPeriodMs;     // uplink period in milliseconds
     std::uint32_t m_tReference;         // time of last uplink
 
@@ -188,23 +187,13 @@ cMyLoRaWAN::setup() {
 
     this->RegisterListener(
         // use a lambda so we're "inside" the cMyLoRaWAN from public/private perspective
-        [](void *pClientInfo, uint32_t event) -> void {
-            auto const pThis = (cMyLoRaWAN *)pClientInfo;
-
-            // for tx start, we quickly capture the channel and the RPS
+        [](void * /* pClientInfo */, uint32_t event) -> void {
+            // for tx start, we quickly capture the channel and the RPS;
+            // the event's schema takes care of printing them.
             if (event == EV_TXSTART) {
-                // use another lambda to make log prints easy
-                myEventLog.logEvent(
-                    (void *) pThis,
+                myEventLog.logEvent<cEventLog::TxStartEvent>(
                     LMIC.txChnl,
-                    LMIC.rps,
-                    0,
-                    // the print-out function
-                    [](cEventLog::EventNode_t const *pEvent) -> void {
-                        Serial.print(F(" TX:"));
-                        myEventLog.printCh(std::uint8_t(pEvent->getData(0)));
-                        myEventLog.printRps(rps_t(pEvent->getData(1)));
-                    }
+                    LMIC.rps
                 );
             }
             // else if (event == some other), record with print-out function
@@ -311,11 +300,8 @@ cSensor::loop(void) {
 
 void
 cSensor::doUplink(void) {
-    // if busy uplinking, just skip
-    if (this->m_fBusy)
-        return;
-    // if LMIC is busy, just skip
-    if (LMIC.opmode & (OP_POLL | OP_TXDATA | OP_TXRXPEND))
+    // if the uplink queue is full, just skip
+    if (myLoRaWAN.GetUplinkQueueFree() == 0)
         return;
 
     // make a measurement on the BME280
@@ -346,21 +332,17 @@ cSensor::doUplink(void) {
     uplink[5] = std::uint8_t(up >> 8);
     uplink[6] = std::uint8_t(up);
 
-    this->m_fBusy = true;
-    
-    if (! myLoRaWAN.SendBuffer(
+    // SendBuffer() copies the data, so uplink[] can go out of scope; if
+    // the LMIC is busy, the message waits in the uplink queue.
+    myLoRaWAN.SendBuffer(
         uplink, sizeof(uplink),
         // this is the completion function:
-        [](void *pClientData, bool fSucccess) -> void {
-            auto const pThis = (cSensor *)pClientData;
-            pThis->m_fBusy = false;
+        [](void *pClientData, bool fSuccess) -> void {
+            if (! fSuccess)
+                Serial.println("uplink failed");
         },
         (void *)this,
         /* confirmed */ false,
         /* port */ 1
-        )) {
-        // sending failed; callback has not been called and will not
-        // be called. Reset busy flag.
-        this->m_fBusy = false;
-    }
+        );
 }
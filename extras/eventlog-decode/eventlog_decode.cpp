@@ -0,0 +1,198 @@
+/*
+
+Module:	eventlog_decode.cpp
+
+Function:
+	Host tool: decode binary Arduino_LoRaWAN event log records to text.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Usage:
+	c++ -std=c++11 -I ../../src -o eventlog_decode eventlog_decode.cpp
+	eventlog_decode [-u usPerTick] [file]
+
+	Reads records written by an Arduino_LoRaWAN::cEventLogSink from
+	file (or stdin), and prints them in the same format that
+	Arduino_LoRaWAN::cEventLog prints to Serial. usPerTick is the
+	LMIC's US_PER_OSTICK (default 16).
+
+*/
+
+#include <Arduino_LoRaWAN_EventLogFormat.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/****************************************************************************\
+|
+|	Formatting, as in Arduino_LoRaWAN::cEventLog
+|
+\****************************************************************************/
+
+// to decode an application's own typed events, compile with
+// -DEVENTLOG_DECODE_USER_HEADER='"myevents.h"', where myevents.h
+// declares the event types and defines EVENTLOG_DECODE_USER_SCHEMAS as
+// a list like: &MyEvent::getSchema(), &MyOtherEvent::getSchema(),
+#ifdef EVENTLOG_DECODE_USER_HEADER
+# include EVENTLOG_DECODE_USER_HEADER
+#endif
+
+static const Arduino_LoRaWAN_EventSchema * const kSchemas[] =
+    {
+    &Arduino_LoRaWAN_TxStartEvent::getSchema(),
+#ifdef EVENTLOG_DECODE_USER_SCHEMAS
+    EVENTLOG_DECODE_USER_SCHEMAS
+#endif
+    };
+
+static const Arduino_LoRaWAN_EventSchema *findSchema(
+    Arduino_LoRaWAN_EventRecord::Code_t code
+    )
+    {
+    for (auto pSchema : kSchemas)
+        {
+        if (pSchema->code == code)
+            return pSchema;
+        }
+
+    return nullptr;
+    }
+
+static void printRecord(
+    const Arduino_LoRaWAN_EventRecord &record,
+    unsigned usPerTick
+    )
+    {
+    using Code_t = Arduino_LoRaWAN_EventRecord::Code_t;
+
+    // same arithmetic as osticks2ms().
+    std::printf("%ld ms:",
+        long(std::int32_t(std::int64_t(record.time) * usPerTick / 1000))
+        );
+
+    auto const pSchema = findSchema(record.code);
+
+    if (pSchema != nullptr)
+        {
+        char buffer[256];
+
+        pSchema->format(record.data, buffer, sizeof(buffer));
+        std::printf("%s", buffer);
+        }
+    else if (record.code == Code_t::kBoot)
+        {
+        std::printf(" ** %s: generation %lu",
+            record.data[1] ? "restarted, log recovered" : "log started",
+            (unsigned long) record.data[0]
+            );
+        }
+    else if (record.code == Code_t::kLost)
+        {
+        std::printf(" ** %lu event(s) lost: log full", (unsigned long) record.data[0]);
+        }
+    else
+        {
+        std::printf(" event %u: 0x%lX 0x%lX 0x%lX",
+            unsigned(record.code),
+            (unsigned long) record.data[0],
+            (unsigned long) record.data[1],
+            (unsigned long) record.data[2]
+            );
+        }
+
+    std::printf("\n");
+    }
+
+/****************************************************************************\
+|
+|	The main program
+|
+\****************************************************************************/
+
+int main(int argc, char **argv)
+    {
+    unsigned usPerTick = 16;
+    std::FILE *pFile = stdin;
+    int iArg;
+
+    for (iArg = 1; iArg < argc && argv[iArg][0] == '-'; ++iArg)
+        {
+        if (std::strcmp(argv[iArg], "-u") == 0 && iArg + 1 < argc)
+            usPerTick = unsigned(std::strtoul(argv[++iArg], nullptr, 0));
+        else
+            {
+            std::fprintf(stderr, "usage: %s [-u usPerTick] [file]\n", argv[0]);
+            return 2;
+            }
+        }
+
+    if (iArg < argc)
+        {
+        pFile = std::fopen(argv[iArg], "rb");
+        if (pFile == nullptr)
+            {
+            std::perror(argv[iArg]);
+            return 1;
+            }
+        }
+
+    std::uint8_t buffer[4096];
+    std::size_t nBuffer = 0;
+    unsigned long nSkipped = 0;
+    bool fEof = false;
+
+    while (! fEof || nBuffer != 0)
+        {
+        if (! fEof)
+            {
+            auto const n = std::fread(buffer + nBuffer, 1, sizeof(buffer) - nBuffer, pFile);
+            if (n == 0)
+                fEof = true;
+            nBuffer += n;
+            }
+
+        std::size_t i = 0;
+        while (i < nBuffer)
+            {
+            Arduino_LoRaWAN_EventRecord record;
+            auto const n = record.decode(buffer + i, nBuffer - i);
+
+            if (n > 0)
+                {
+                printRecord(record, usPerTick);
+                i += n;
+                }
+            else if (n < 0 || fEof)
+                {
+                // not a record (or a truncated one at the end): resync.
+                ++nSkipped;
+                ++i;
+                }
+            else
+                {
+                // need more data.
+                break;
+                }
+            }
+
+        std::memmove(buffer, buffer + i, nBuffer - i);
+        nBuffer -= i;
+        }
+
+    if (nSkipped != 0)
+        std::fprintf(stderr, "%lu byte(s) skipped\n", nSkipped);
+
+    return nSkipped != 0;
+    }
@@ -0,0 +1,54 @@
+/*
+
+Module:	host_benchmark.cpp
+
+Function:
+	Host build of the microbenchmarks in examples/benchmark.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Usage:
+	host_benchmark [filter]
+
+	Runs the cases whose names contain filter (default all), and
+	prints the best and median time per operation in nanoseconds.
+	Build with -DARDUINO_LORAWAN_HOST_REGION=... to measure another
+	region.
+
+*/
+
+#include "benchmark_cases.h"
+
+#include <cstdio>
+
+static cBenchmarkLoRaWAN myLoRaWAN;
+
+int main(int argc, char **argv)
+    {
+    if (argc > 2)
+        {
+        std::fprintf(stderr, "usage: %s [filter]\n", argv[0]);
+        return 2;
+        }
+
+    // micros() is the simulated clock, which stands still here.
+    Arduino_LoRaWAN_Probes::setCounter(hostNanos, "ns");
+
+    // not provisioned, so this returns false; the LMIC is set up anyway.
+    (void) myLoRaWAN.begin();
+
+    Arduino_LoRaWAN_Benchmark bench(myLoRaWAN);
+
+    bench.run(Serial, argc > 1 ? argv[1] : nullptr);
+    return 0;
+    }
@@ -0,0 +1,207 @@
+/*
+
+Module:	host_uplink.cpp
+
+Function:
+	Host example: join, and send uplinks in simulated time.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Usage:
+	host_uplink [-n count] [-i seconds] [-c] [-v]
+
+	Joins (OTAA) with the simulated network, then sends count uplinks
+	(default 100), one every interval seconds (default 60) of simulated
+	time, confirmed if -c is given. -v turns on the library's log
+	messages. Prints a summary, including the CPU time used, so the
+	library can be profiled with perf or valgrind, and compares the
+	library's energy counters with the simulator's. If built with
+	-DARDUINO_LORAWAN_HOST_PROBES=ON, also prints the timing probes,
+	in nanoseconds of host time.
+
+*/
+
+#include <Arduino_LoRaWAN_network.h>
+#include <Arduino_LoRaWAN_lmic.h>
+#include <lmic_sim.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/****************************************************************************\
+|
+|	The device
+|
+\****************************************************************************/
+
+class cHostLoRaWAN : public Arduino_LoRaWAN_network
+    {
+protected:
+    virtual bool GetOtaaProvisioningInfo(OtaaProvisioningInfo *pInfo) override
+        {
+        if (pInfo != nullptr)
+            {
+            static const uint8_t kDevEUI[8] = { 0x01, 0x00, 0x00, 0x00, 0x00, 0xA3, 0x04, 0x00 };
+            static const uint8_t kAppEUI[8] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+            std::memset(pInfo->AppKey, 0x5A, sizeof(pInfo->AppKey));
+            std::memcpy(pInfo->DevEUI, kDevEUI, sizeof(kDevEUI));
+            std::memcpy(pInfo->AppEUI, kAppEUI, sizeof(kAppEUI));
+            }
+        return true;
+        }
+    };
+
+static cHostLoRaWAN myLoRaWAN;
+
+static unsigned nDone;
+static unsigned nSucceeded;
+
+static void sendDone(void *pCtx, bool fSuccess)
+    {
+    (void) pCtx;
+
+    ++nDone;
+    if (fSuccess)
+        ++nSucceeded;
+    }
+
+/****************************************************************************\
+|
+|	The main program
+|
+\****************************************************************************/
+
+int main(int argc, char **argv)
+    {
+    unsigned nMessages = 100;
+    unsigned interval = 60;
+    bool fConfirmed = false;
+    bool fVerbose = false;
+
+    for (int iArg = 1; iArg < argc; ++iArg)
+        {
+        if (std::strcmp(argv[iArg], "-n") == 0 && iArg + 1 < argc)
+            nMessages = unsigned(std::strtoul(argv[++iArg], nullptr, 0));
+        else if (std::strcmp(argv[iArg], "-i") == 0 && iArg + 1 < argc)
+            interval = unsigned(std::strtoul(argv[++iArg], nullptr, 0));
+        else if (std::strcmp(argv[iArg], "-c") == 0)
+            fConfirmed = true;
+        else if (std::strcmp(argv[iArg], "-v") == 0)
+            fVerbose = true;
+        else
+            {
+            std::fprintf(stderr, "usage: %s [-n count] [-i seconds] [-c] [-v]\n", argv[0]);
+            return 2;
+            }
+        }
+
+    myLoRaWAN.SetDebugMask(fVerbose ? Arduino_LoRaWAN::LOG_BASIC |
+                                      Arduino_LoRaWAN::LOG_ERRORS |
+                                      Arduino_LoRaWAN::LOG_VERBOSE
+                                    : 0);
+
+#if ARDUINO_LORAWAN_CFG_PROBES
+    // micros() is the simulated clock; time the probes with the host's.
+    Arduino_LoRaWAN_Probes::setCounter(hostNanos, "ns");
+#endif
+
+    if (! myLoRaWAN.begin())
+        {
+        std::fprintf(stderr, "begin() failed\n");
+        return 1;
+        }
+
+    auto const tCpuStart = std::chrono::steady_clock::now();
+    std::int64_t tNextSend = 0;
+    unsigned nSent = 0;
+
+    while (nDone < nMessages)
+        {
+        myLoRaWAN.loop();
+        if (nDone >= nMessages)
+            break;
+
+        // true if it's time to send, but the library can't take it yet.
+        bool fBlocked = false;
+
+        if (nSent < nMessages && LmicSim::getTicks() >= tNextSend)
+            {
+            uint8_t payload[] = { uint8_t(nSent >> 8), uint8_t(nSent), 0x12, 0x34, 0x56, 0x78 };
+
+            if (myLoRaWAN.GetTxReady() &&
+                myLoRaWAN.SendBuffer(payload, sizeof(payload), sendDone, nullptr, fConfirmed))
+                {
+                ++nSent;
+                tNextSend = LmicSim::getTicks() + sec2osticks(interval);
+                }
+            else
+                fBlocked = true;
+            }
+
+        // nothing more to do now: move the clock to the next thing to do.
+        std::int64_t tWake = nSent < nMessages && ! fBlocked ? tNextSend : INT64_MAX;
+        std::int64_t tJob;
+
+        if (LmicSim::getNextDeadline(tJob) && tJob < tWake)
+            tWake = tJob;
+
+        if (tWake == INT64_MAX)
+            {
+            std::fprintf(stderr, "stalled after %u of %u message(s)\n", nDone, nMessages);
+            return 1;
+            }
+
+        if (tWake > LmicSim::getTicks())
+            LmicSim::setTicks(tWake);
+        }
+
+    auto const tCpu = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - tCpuStart
+                        ).count();
+    auto const &device = LmicSim::getDevice();
+
+    std::printf("%u uplink(s) sent, %u succeeded; FCntUp %lu\n",
+        nDone, nSucceeded, (unsigned long) LMIC.seqnoUp
+        );
+    std::printf("simulated time %.1f s, time on air %.3f s (%lu transmission(s))\n",
+        double(LmicSim::getTicks()) / OSTICKS_PER_SEC,
+        double(device.tAirtime) / OSTICKS_PER_SEC,
+        (unsigned long) device.nUplinks
+        );
+    Arduino_LoRaWAN::EnergyCounters_t energy;
+
+    myLoRaWAN.GetEnergyCounters(energy);
+    std::printf("library estimate: time on air %.3f s (%lu transmission(s), %lu join(s)), "
+                "receiving %.3f s (%lu window(s)), charge %.1f mC, last message %lu uC, next %lu uC\n",
+        double(energy.txAirtimeUs) / 1e6,
+        (unsigned long) energy.nTransmissions,
+        (unsigned long) energy.nJoinAttempts,
+        double(energy.rxOpenUs) / 1e6,
+        (unsigned long) energy.nRxWindows,
+        double(energy.txChargeUc + energy.rxChargeUc) / 1000.0,
+        (unsigned long) energy.lastMessageChargeUc,
+        (unsigned long) myLoRaWAN.GetMessageChargeEstimate(6)
+        );
+    std::printf("simulated receiving %.3f s\n", double(device.tRxOpen) / OSTICKS_PER_SEC);
+    std::printf("cpu time %.3f ms\n", tCpu * 1000.0);
+
+#if ARDUINO_LORAWAN_CFG_PROBES
+    std::fflush(stdout);
+    myLoRaWAN.GetProbes().print(Serial);
+#endif
+
+    return nSucceeded == nMessages ? 0 : 1;
+    }
@@ -0,0 +1,110 @@
+/*
+
+Module:	Arduino.h
+
+Function:
+	Minimal Arduino core API for host-native builds of arduino-lorawan.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _ARDUINO_H_             /* prevent multiple includes */
+#define _ARDUINO_H_
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+
+#define DEC     10
+#define HEX     16
+
+class __FlashStringHelper;
+#define F(s)    (reinterpret_cast<const __FlashStringHelper *>(s))
+
+// the simulated clock; advanced by the host harness, not by wall-clock time.
+std::uint32_t millis(void);
+std::uint32_t micros(void);
+void delay(std::uint32_t ms);
+void yield(void);
+
+// there are no interrupts on the host.
+inline void noInterrupts(void) {}
+inline void interrupts(void) {}
+
+// the host's own clock, in nanoseconds: a counter for Arduino_LoRaWAN_Probes.
+std::uint32_t hostNanos(void);
+
+///
+/// \brief the byte-output interface of the Arduino core.
+///
+class Print
+        {
+public:
+        virtual std::size_t write(std::uint8_t c) = 0;
+        virtual std::size_t write(const std::uint8_t *pBuf, std::size_t nBuf)
+                {
+                std::size_t n = 0;
+                while (nBuf-- != 0)
+                        n += this->write(*pBuf++);
+                return n;
+                }
+        };
+
+///
+/// \brief a Serial object that writes to a host stdio stream.
+///
+/// \details
+///     Output can be discarded (for benchmarks) by calling \c setOutput(nullptr).
+///
+class HostSerial_t : public Print
+        {
+public:
+        void begin(unsigned long) {}
+        explicit operator bool() const { return true; }
+        void setOutput(std::FILE *pFile) { this->m_pFile = pFile; }
+        std::FILE *getOutput() const { return this->m_pFile; }
+
+        virtual std::size_t write(std::uint8_t c) override;
+        virtual std::size_t write(const std::uint8_t *pBuf, std::size_t nBuf) override;
+        void flush(void);
+
+        std::size_t print(const char *s);
+        std::size_t print(const __FlashStringHelper *s)
+                { return this->print(reinterpret_cast<const char *>(s)); }
+        std::size_t print(char c);
+        std::size_t print(unsigned char v, int base = DEC) { return this->print((unsigned long) v, base); }
+        std::size_t print(int v, int base = DEC) { return this->print((long) v, base); }
+        std::size_t print(unsigned v, int base = DEC) { return this->print((unsigned long) v, base); }
+        std::size_t print(long v, int base = DEC);
+        std::size_t print(unsigned long v, int base = DEC);
+        std::size_t print(long long v, int base = DEC);
+        std::size_t print(unsigned long long v, int base = DEC);
+        std::size_t print(double v, int digits = 2);
+
+        std::size_t println(void) { return this->print("\r\n"); }
+        template <typename T>
+        std::size_t println(T v) { auto n = this->print(v); return n + this->println(); }
+        template <typename T>
+        std::size_t println(T v, int base) { auto n = this->print(v, base); return n + this->println(); }
+
+private:
+        std::FILE *m_pFile = stdout;
+        };
+
+extern HostSerial_t Serial;
+
+#endif /* _ARDUINO_H_ */
@@ -0,0 +1,30 @@
+/*
+
+Module:	arduino_lmic.h
+
+Function:
+	Top-level include for the simulated LMIC.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _ARDUINO_LMIC_H_        /* prevent multiple includes */
+#define _ARDUINO_LMIC_H_
+
+#pragma once
+
+#include <lmic.h>
+#include <hal/hal.h>
+
+#endif /* _ARDUINO_LMIC_H_ */
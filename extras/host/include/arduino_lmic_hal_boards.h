@@ -0,0 +1,36 @@
+/*
+
+Module:	arduino_lmic_hal_boards.h
+
+Function:
+	Board pin-map lookup for the simulated LMIC.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _arduino_lmic_hal_boards_h_
+#define _arduino_lmic_hal_boards_h_
+
+#pragma once
+
+#include <arduino_lmic_hal_configuration.h>
+
+namespace Arduino_LMIC {
+
+/// \brief the simulated board has a pin-map with no pins.
+const HalPinmap_t *GetPinmap_ThisBoard(void);
+
+} // namespace Arduino_LMIC
+
+#endif /* _arduino_lmic_hal_boards_h_ */
@@ -0,0 +1,50 @@
+/*
+
+Module:	arduino_lmic_hal_configuration.h
+
+Function:
+	Pin-map types for the simulated LMIC.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _arduino_lmic_hal_configuration_h_
+#define _arduino_lmic_hal_configuration_h_
+
+#pragma once
+
+#include <cstdint>
+
+namespace Arduino_LMIC {
+
+class HalConfiguration_t;
+
+struct HalPinmap_t
+        {
+        static constexpr std::uint8_t LMIC_UNUSED_PIN = 0xff;
+        static constexpr unsigned NUM_DIO = 3;
+
+        std::uint8_t    nss;
+        std::uint8_t    rxtx;
+        std::uint8_t    rst;
+        std::uint8_t    dio[NUM_DIO];
+        std::uint8_t    rxtx_rx_active;
+        std::int8_t     rssi_cal;
+        std::uint32_t   spi_freq;
+        HalConfiguration_t *pConfig;
+        };
+
+} // namespace Arduino_LMIC
+
+#endif /* _arduino_lmic_hal_configuration_h_ */
@@ -0,0 +1,90 @@
+/*
+
+Module:	arduino_lmic_user_configuration.h
+
+Function:
+	Region and feature configuration for the simulated LMIC used by
+	host-native builds.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Notes:
+	This follows lmic_config_preconditions.h from arduino-lmic: exactly
+	one CFG_xxx region symbol selects the region, and the derived
+	CFG_region, CFG_LMIC_EU_like and CFG_LMIC_US_like symbols are
+	computed from it. If nothing is selected, we use eu868.
+
+*/
+
+#ifndef _arduino_lmic_user_configuration_h_
+#define _arduino_lmic_user_configuration_h_
+
+#pragma once
+
+#define LMIC_REGION_eu868       1
+#define LMIC_REGION_us915       2
+#define LMIC_REGION_cn783       3
+#define LMIC_REGION_eu433       4
+#define LMIC_REGION_au915       5
+#define LMIC_REGION_cn490       6
+#define LMIC_REGION_as923       7
+#define LMIC_REGION_kr920       8
+#define LMIC_REGION_in866       9
+
+#define LMIC_COUNTRY_CODE_NONE  0
+#define LMIC_COUNTRY_CODE_JP    (('J' << 8) | 'P')
+
+#if ! (defined(CFG_eu868) || defined(CFG_us915) || defined(CFG_au915) || \
+       defined(CFG_as923) || defined(CFG_kr920) || defined(CFG_in866))
+# define CFG_eu868 1
+#endif
+
+#if defined(CFG_eu868)
+# define CFG_region             LMIC_REGION_eu868
+#elif defined(CFG_us915)
+# define CFG_region             LMIC_REGION_us915
+#elif defined(CFG_au915)
+# define CFG_region             LMIC_REGION_au915
+#elif defined(CFG_as923)
+# define CFG_region             LMIC_REGION_as923
+#elif defined(CFG_kr920)
+# define CFG_region             LMIC_REGION_kr920
+#elif defined(CFG_in866)
+# define CFG_region             LMIC_REGION_in866
+#endif
+
+#if CFG_region == LMIC_REGION_us915 || CFG_region == LMIC_REGION_au915
+# define CFG_LMIC_US_like       1
+# define CFG_LMIC_EU_like       0
+#else
+# define CFG_LMIC_US_like       0
+# define CFG_LMIC_EU_like       1
+#endif
+
+#ifndef LMIC_COUNTRY_CODE
+# define LMIC_COUNTRY_CODE      LMIC_COUNTRY_CODE_NONE
+#endif
+
+#ifndef LMIC_ENABLE_TxParamSetupReq
+# if CFG_region == LMIC_REGION_as923
+#  define LMIC_ENABLE_TxParamSetupReq   1
+# else
+#  define LMIC_ENABLE_TxParamSetupReq   0
+# endif
+#endif
+
+#ifndef LMIC_ENABLE_DeviceTimeReq
+# define LMIC_ENABLE_DeviceTimeReq      0
+#endif
+
+#endif /* _arduino_lmic_user_configuration_h_ */
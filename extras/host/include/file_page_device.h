@@ -0,0 +1,189 @@
+/*
+
+Module:	file_page_device.h
+
+Function:
+	A cPageDevice stored in a host file, for testing cRingStore off
+	target.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _file_page_device_h_            /* prevent multiple includes */
+#define _file_page_device_h_
+
+#pragma once
+
+#include <Arduino_LoRaWAN_RingStore.h>
+#include <cstdio>
+
+///
+/// \brief a cPageDevice backed by a file, with NOR flash semantics.
+///
+/// \details
+///     Writes can only clear bits (the new data is ANDed with what is
+///     already in the file), just as with real flash; so code that
+///     writes over unerased bytes shows up as CRC failures. Erase
+///     counts are kept per page, so wear levelling can be checked.
+///
+///     setPowerFail() simulates a power failure: after the given number
+///     of bytes, writes stop part way and fail, and so do erases, until
+///     the device is opened again.
+///
+class cFilePageDevice : public Arduino_LoRaWAN::cPageDevice
+        {
+public:
+        /// \brief the largest number of pages we track erase counts for.
+        static constexpr unsigned kMaxPages = 64;
+
+        cFilePageDevice(std::size_t pageSize, unsigned nPages)
+                : m_pageSize(pageSize)
+                , m_nPages(nPages < kMaxPages ? nPages : kMaxPages)
+                {}
+
+        virtual ~cFilePageDevice()
+                {
+                this->close();
+                }
+
+        ///
+        /// \brief open (or create) the backing file.
+        ///
+        /// \details
+        ///     A new file, or a file that is too short, is extended with
+        ///     erased pages. Any simulated power failure is cleared.
+        ///
+        bool open(const char *pName)
+                {
+                this->close();
+                this->m_nPowerFail = -1;
+                this->m_pFile = std::fopen(pName, "r+b");
+                if (this->m_pFile == nullptr)
+                        this->m_pFile = std::fopen(pName, "w+b");
+                if (this->m_pFile == nullptr)
+                        return false;
+
+                std::fseek(this->m_pFile, 0, SEEK_END);
+                long const nHave = std::ftell(this->m_pFile);
+                long const nNeed = long(this->m_pageSize * this->m_nPages);
+
+                for (long i = nHave < 0 ? 0 : nHave; i < nNeed; ++i)
+                        std::fputc(0xFF, this->m_pFile);
+
+                return std::fflush(this->m_pFile) == 0;
+                }
+
+        /// \brief close the backing file.
+        void close()
+                {
+                if (this->m_pFile != nullptr)
+                        {
+                        std::fclose(this->m_pFile);
+                        this->m_pFile = nullptr;
+                        }
+                }
+
+        /// \brief fail after \p nBytes more bytes are written; -1 for never.
+        void setPowerFail(long nBytes)
+                {
+                this->m_nPowerFail = nBytes;
+                }
+
+        /// \brief return true if a simulated power failure has happened.
+        bool isPowerFailed() const
+                {
+                return this->m_nPowerFail == 0;
+                }
+
+        /// \brief return the number of times a page has been erased.
+        std::uint32_t getEraseCount(unsigned iPage) const
+                {
+                return iPage < this->m_nPages ? this->m_eraseCount[iPage] : 0;
+                }
+
+        virtual std::size_t getPageSize() const override
+                {
+                return this->m_pageSize;
+                }
+
+        virtual unsigned getPageCount() const override
+                {
+                return this->m_nPages;
+                }
+
+        virtual bool read(unsigned iPage, std::size_t offset, void *pBuffer, std::size_t nBuffer) override
+                {
+                return this->seek(iPage, offset, nBuffer) &&
+                       std::fread(pBuffer, 1, nBuffer, this->m_pFile) == nBuffer;
+                }
+
+        virtual bool write(unsigned iPage, std::size_t offset, const void *pBuffer, std::size_t nBuffer) override
+                {
+                auto const pData = static_cast<const std::uint8_t *>(pBuffer);
+
+                for (std::size_t i = 0; i < nBuffer; ++i)
+                        {
+                        std::uint8_t b;
+
+                        if (this->isPowerFailed())
+                                {
+                                std::fflush(this->m_pFile);
+                                return false;
+                                }
+
+                        if (! this->read(iPage, offset + i, &b, 1))
+                                return false;
+
+                        b &= pData[i];
+                        if (! this->seek(iPage, offset + i, 1) ||
+                            std::fputc(b, this->m_pFile) == EOF)
+                                return false;
+
+                        if (this->m_nPowerFail > 0)
+                                --this->m_nPowerFail;
+                        }
+
+                return std::fflush(this->m_pFile) == 0;
+                }
+
+        virtual bool erase(unsigned iPage) override
+                {
+                if (this->isPowerFailed() ||
+                    ! this->seek(iPage, 0, this->m_pageSize))
+                        return false;
+
+                for (std::size_t i = 0; i < this->m_pageSize; ++i)
+                        std::fputc(0xFF, this->m_pFile);
+
+                ++this->m_eraseCount[iPage];
+                return std::fflush(this->m_pFile) == 0;
+                }
+
+private:
+        std::FILE *m_pFile = nullptr;                   ///< the backing file
+        std::size_t m_pageSize;                         ///< bytes per page
+        unsigned m_nPages;                              ///< number of pages
+        long m_nPowerFail = -1;                         ///< bytes until power fails, or -1
+        std::uint32_t m_eraseCount[kMaxPages] {};       ///< erases per page
+
+        bool seek(unsigned iPage, std::size_t offset, std::size_t nBuffer)
+                {
+                return this->m_pFile != nullptr &&
+                       iPage < this->m_nPages &&
+                       offset + nBuffer <= this->m_pageSize &&
+                       std::fseek(this->m_pFile, long(iPage * this->m_pageSize + offset), SEEK_SET) == 0;
+                }
+        };
+
+#endif /* _file_page_device_h_ */
@@ -0,0 +1,29 @@
+/*
+
+Module:	hal/hal.h
+
+Function:
+	HAL declarations for the simulated LMIC.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _hal_hal_h_             /* prevent multiple includes */
+#define _hal_hal_h_
+
+#pragma once
+
+#include <arduino_lmic_hal_configuration.h>
+
+#endif /* _hal_hal_h_ */
@@ -0,0 +1,424 @@
+/*
+
+Module:	lmic.h
+
+Function:
+	The subset of the arduino-lmic API used by arduino-lorawan,
+	backed by a simulated MAC and a virtual clock.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Notes:
+	Names, types and numeric values follow arduino-lmic v4.1.1, so that
+	the library sources compile unchanged. Only the fields and functions
+	that the library (and the host tools) actually use are provided.
+
+	Unlike the real LMIC, `LMIC` is not a single global object; it names
+	the lmic_t inside the currently-selected simulation context. This
+	lets one process run many simulated devices. See lmic_sim.h.
+
+*/
+
+#ifndef _lmic_h_                /* prevent multiple includes */
+#define _lmic_h_
+
+#pragma once
+
+#include <arduino_lmic_user_configuration.h>
+#include <cstdint>
+#include <cstddef>
+
+#define ARDUINO_LMIC_VERSION_CALC(major, minor, patch, local)   \
+        ((((major)*UINT32_C(1)) << 24) | (((minor)*UINT32_C(1)) << 16) | \
+         (((patch)*UINT32_C(1)) << 8) | (((local)*UINT32_C(1)) << 0))
+
+#define ARDUINO_LMIC_VERSION    ARDUINO_LMIC_VERSION_CALC(4, 1, 1, 0)
+
+#define ARDUINO_LMIC_VERSION_GET_MAJOR(v)       ((((v)*UINT32_C(1)) >> 24u) & 0xFFu)
+#define ARDUINO_LMIC_VERSION_GET_MINOR(v)       ((((v)*UINT32_C(1)) >> 16u) & 0xFFu)
+#define ARDUINO_LMIC_VERSION_GET_PATCH(v)       ((((v)*UINT32_C(1)) >> 8u) & 0xFFu)
+#define ARDUINO_LMIC_VERSION_GET_LOCAL(v)       ((v) & 0xFFu)
+#define ARDUINO_LMIC_VERSION_TO_ORDINAL(v)      \
+        (((v) & 0xFFFFFF00u) | (((v) - 1) & 0xFFu))
+#define ARDUINO_LMIC_VERSION_COMPARE_LT(v1, v2) \
+        (ARDUINO_LMIC_VERSION_TO_ORDINAL(v1) < ARDUINO_LMIC_VERSION_TO_ORDINAL(v2))
+#define ARDUINO_LMIC_VERSION_COMPARE_LE(v1, v2) \
+        (ARDUINO_LMIC_VERSION_TO_ORDINAL(v1) <= ARDUINO_LMIC_VERSION_TO_ORDINAL(v2))
+#define ARDUINO_LMIC_VERSION_COMPARE_GT(v1, v2) \
+        (ARDUINO_LMIC_VERSION_TO_ORDINAL(v1) > ARDUINO_LMIC_VERSION_TO_ORDINAL(v2))
+#define ARDUINO_LMIC_VERSION_COMPARE_GE(v1, v2) \
+        (ARDUINO_LMIC_VERSION_TO_ORDINAL(v1) >= ARDUINO_LMIC_VERSION_TO_ORDINAL(v2))
+
+/****************************************************************************\
+|
+|       Basic types (oslmic.h)
+|
+\****************************************************************************/
+
+typedef std::uint8_t    bit_t;
+typedef std::uint8_t    u1_t;
+typedef std::int8_t     s1_t;
+typedef std::uint16_t   u2_t;
+typedef std::int16_t    s2_t;
+typedef std::uint32_t   u4_t;
+typedef std::int32_t    s4_t;
+typedef unsigned int    uint;
+typedef const char *    str_t;
+typedef u1_t *          xref2u1_t;
+typedef const u1_t *    xref2cu1_t;
+
+typedef s4_t            ostime_t;
+typedef u4_t            devaddr_t;
+typedef u1_t            cr_t;
+typedef u1_t            sf_t;
+typedef u1_t            bw_t;
+typedef u1_t            dr_t;
+typedef u2_t            rps_t;
+typedef u4_t            lmic_gpstime_t;
+
+#define US_PER_OSTICK_EXPONENT  4
+#define US_PER_OSTICK           (1 << US_PER_OSTICK_EXPONENT)
+#define OSTICKS_PER_SEC         (1000000 / US_PER_OSTICK)
+
+#define us2osticks(us)          ((ostime_t)( ((std::int64_t)(us) * OSTICKS_PER_SEC) / 1000000))
+#define us2osticksCeil(us)      ((ostime_t)( ((std::int64_t)(us) * OSTICKS_PER_SEC + 999999) / 1000000))
+#define us2osticksRound(us)     ((ostime_t)( ((std::int64_t)(us) * OSTICKS_PER_SEC + 500000) / 1000000))
+#define ms2osticks(ms)          ((ostime_t)( ((std::int64_t)(ms) * OSTICKS_PER_SEC) / 1000))
+#define sec2osticks(sec)        ((ostime_t)( (std::int64_t)(sec) * OSTICKS_PER_SEC))
+#define osticks2ms(os)          ((s4_t)(((os)*(std::int64_t)US_PER_OSTICK ) / 1000))
+#define osticks2us(os)          ((s4_t)((os)*(std::int64_t)US_PER_OSTICK ))
+#define ms2osticksCeil(ms)      ((ostime_t)( ((std::int64_t)(ms) * OSTICKS_PER_SEC + 999) / 1000))
+#define ms2osticksRound(ms)     ((ostime_t)( ((std::int64_t)(ms) * OSTICKS_PER_SEC + 500) / 1000))
+
+#if !defined(CFG_noassert)
+# define ASSERT(cond)   do { if (!(cond)) hal_failed(__FILE__, __LINE__); } while (0)
+#else
+# define ASSERT(cond)   do { } while (0)
+#endif
+
+struct osjob_t;
+typedef void osjobcbfn_t(struct osjob_t *);
+typedef osjobcbfn_t *osjobcb_t;
+
+struct osjob_t
+        {
+        struct osjob_t *next;
+        ostime_t        deadline;
+        osjobcb_t       func;
+        };
+typedef struct osjob_t osjob_t;
+
+extern "C" {
+void hal_failed(const char *file, u2_t line);
+
+int os_init_ex(const void *pPinmap);
+void os_init(void);
+void os_runloop_once(void);
+ostime_t os_getTime(void);
+void os_setCallback(osjob_t *job, osjobcb_t cb);
+void os_setTimedCallback(osjob_t *job, ostime_t time, osjobcb_t cb);
+void os_clearCallback(osjob_t *job);
+bit_t os_queryTimeCriticalJobs(ostime_t time);
+
+// supplied by the application (arduino-lorawan supplies these)
+void os_getArtEui(u1_t *buf);
+void os_getDevEui(u1_t *buf);
+void os_getDevKey(u1_t *buf);
+}
+
+/****************************************************************************\
+|
+|       Radio parameters (lorabase.h)
+|
+\****************************************************************************/
+
+enum _cr_t { CR_4_5 = 0, CR_4_6, CR_4_7, CR_4_8 };
+enum _sf_t { FSK = 0, SF7, SF8, SF9, SF10, SF11, SF12, SFrfu };
+enum _bw_t { BW125 = 0, BW250, BW500, BWrfu };
+
+inline sf_t  getSf    (rps_t params)            { return   (sf_t)(params &  0x7); }
+inline rps_t setSf    (rps_t params, sf_t sf)   { return (rps_t)((params & ~0x7) | sf); }
+inline bw_t  getBw    (rps_t params)            { return  (bw_t)((params >> 3) & 0x3); }
+inline rps_t setBw    (rps_t params, bw_t cr)   { return (rps_t)((params & ~0x18) | (cr<<3)); }
+inline cr_t  getCr    (rps_t params)            { return  (cr_t)((params >> 5) & 0x3); }
+inline rps_t setCr    (rps_t params, cr_t cr)   { return (rps_t)((params & ~0x60) | (cr<<5)); }
+inline int   getNocrc (rps_t params)            { return        ((params >> 7) & 0x1); }
+inline rps_t setNocrc (rps_t params, int nocrc) { return (rps_t)((params & ~0x80) | (nocrc<<7)); }
+inline int   getIh    (rps_t params)            { return        ((params >> 8) & 0xFF); }
+inline rps_t setIh    (rps_t params, int ih)    { return (rps_t)((params & ~0xFF00) | (ih<<8)); }
+inline rps_t makeRps  (sf_t sf, bw_t bw, cr_t cr, int ih, int nocrc)
+        {
+        return sf | (bw << 3) | (cr << 5) | (nocrc ? (1 << 7) : 0) | ((ih & 0xFF) << 8);
+        }
+#define MAKERPS(sf,bw,cr,ih,nocrc) ((rps_t)((sf) | ((bw)<<3) | ((cr)<<5) | ((nocrc)?(1<<7):0) | ((ih&0xFF)<<8)))
+
+enum _dr_eu868_t { EU868_DR_SF12 = 0, EU868_DR_SF11, EU868_DR_SF10, EU868_DR_SF9,
+                   EU868_DR_SF8, EU868_DR_SF7, EU868_DR_SF7B, EU868_DR_FSK, EU868_DR_NONE };
+enum _dr_us915_t { US915_DR_SF10 = 0, US915_DR_SF9, US915_DR_SF8, US915_DR_SF7, US915_DR_SF8C,
+                   US915_DR_NONE,
+                   US915_DR_SF12CR = 8, US915_DR_SF11CR, US915_DR_SF10CR, US915_DR_SF9CR,
+                   US915_DR_SF8CR, US915_DR_SF7CR };
+enum _dr_au915_t { AU915_DR_SF12 = 0, AU915_DR_SF11, AU915_DR_SF10, AU915_DR_SF9,
+                   AU915_DR_SF8, AU915_DR_SF7, AU915_DR_SF8C, AU915_DR_NONE,
+                   AU915_DR_SF12CR = 8, AU915_DR_SF11CR, AU915_DR_SF10CR, AU915_DR_SF9CR,
+                   AU915_DR_SF8CR, AU915_DR_SF7CR };
+enum _dr_as923_t { AS923_DR_SF12 = 0, AS923_DR_SF11, AS923_DR_SF10, AS923_DR_SF9,
+                   AS923_DR_SF8, AS923_DR_SF7, AS923_DR_SF7B, AS923_DR_FSK, AS923_DR_NONE };
+enum _dr_kr920_t { KR920_DR_SF12 = 0, KR920_DR_SF11, KR920_DR_SF10, KR920_DR_SF9,
+                   KR920_DR_SF8, KR920_DR_SF7, KR920_DR_NONE };
+enum _dr_in866_t { IN866_DR_SF12 = 0, IN866_DR_SF11, IN866_DR_SF10, IN866_DR_SF9,
+                   IN866_DR_SF8, IN866_DR_SF7, IN866_DR_SF7B_rfu, IN866_DR_FSK, IN866_DR_NONE };
+
+#if CFG_region == LMIC_REGION_eu868
+enum { DR_SF12 = EU868_DR_SF12, DR_SF11, DR_SF10, DR_SF9, DR_SF8, DR_SF7, DR_SF7B, DR_FSK, DR_NONE };
+enum { MAX_CHANNELS = 16, MAX_BANDS = 4 };
+#elif CFG_region == LMIC_REGION_us915
+enum { DR_SF10 = US915_DR_SF10, DR_SF9, DR_SF8, DR_SF7, DR_SF8C, DR_NONE };
+enum { MAX_XCHANNELS = 2 };
+#elif CFG_region == LMIC_REGION_au915
+enum { DR_SF12 = AU915_DR_SF12, DR_SF11, DR_SF10, DR_SF9, DR_SF8, DR_SF7, DR_SF8C, DR_NONE };
+enum { MAX_XCHANNELS = 2 };
+#elif CFG_region == LMIC_REGION_as923
+enum { DR_SF12 = AS923_DR_SF12, DR_SF11, DR_SF10, DR_SF9, DR_SF8, DR_SF7, DR_SF7B, DR_FSK, DR_NONE };
+enum { MAX_CHANNELS = 16, MAX_BANDS = 4 };
+#elif CFG_region == LMIC_REGION_kr920
+enum { DR_SF12 = KR920_DR_SF12, DR_SF11, DR_SF10, DR_SF9, DR_SF8, DR_SF7, DR_NONE };
+enum { MAX_CHANNELS = 16, MAX_BANDS = 4 };
+#elif CFG_region == LMIC_REGION_in866
+enum { DR_SF12 = IN866_DR_SF12, DR_SF11, DR_SF10, DR_SF9, DR_SF8, DR_SF7, DR_SF7B_rfu, DR_FSK, DR_NONE };
+enum { MAX_CHANNELS = 16, MAX_BANDS = 4 };
+#endif
+
+enum { LORAWAN_DR0 = 0, LORAWAN_DR1, LORAWAN_DR2, LORAWAN_DR3, LORAWAN_DR4, LORAWAN_DR5,
+       LORAWAN_DR6, LORAWAN_DR7, LORAWAN_DR8, LORAWAN_DR9, LORAWAN_DR10, LORAWAN_DR11,
+       LORAWAN_DR12, LORAWAN_DR13, LORAWAN_DR14, LORAWAN_DR15 };
+
+#define MAX_LEN_FRAME           255
+#define MAX_LEN_PAYLOAD         (MAX_LEN_FRAME - 13)
+
+/****************************************************************************\
+|
+|       MAC state (lmic.h)
+|
+\****************************************************************************/
+
+enum _ev_t { EV_SCAN_TIMEOUT=1, EV_BEACON_FOUND,
+             EV_BEACON_MISSED, EV_BEACON_TRACKED, EV_JOINING,
+             EV_JOINED, EV_RFU1, EV_JOIN_FAILED, EV_REJOIN_FAILED,
+             EV_TXCOMPLETE, EV_LOST_TSYNC, EV_RESET,
+             EV_RXCOMPLETE, EV_LINK_DEAD, EV_LINK_ALIVE, EV_SCAN_FOUND,
+             EV_TXSTART, EV_TXCANCELED, EV_RXSTART, EV_JOIN_TXCOMPLETE };
+typedef enum _ev_t ev_t;
+
+enum {
+        OP_NONE     = 0x0000,
+        OP_SCAN     = 0x0001,
+        OP_TRACK    = 0x0002,
+        OP_JOINING  = 0x0004,
+        OP_TXDATA   = 0x0008,
+        OP_POLL     = 0x0010,
+        OP_REJOIN   = 0x0020,
+        OP_SHUTDOWN = 0x0040,
+        OP_TXRXPEND = 0x0080,
+        OP_RNDTX    = 0x0100,
+        OP_PINGINI  = 0x0200,
+        OP_PINGABLE = 0x0400,
+        OP_NEXTCHNL = 0x0800,
+        OP_LINKDEAD = 0x1000,
+        OP_TESTMODE = 0x2000,
+        OP_UNJOIN   = 0x4000,
+};
+
+enum {
+        TXRX_ACK    = 0x80,
+        TXRX_NACK   = 0x40,
+        TXRX_NOPORT = 0x20,
+        TXRX_PORT   = 0x10,
+        TXRX_LENERR = 0x08,
+        TXRX_PING   = 0x04,
+        TXRX_DNW2   = 0x02,
+        TXRX_DNW1   = 0x01,
+};
+
+enum {
+        LINK_CHECK_CONT  =  0,
+        LINK_CHECK_DEAD  =  32,
+        LINK_CHECK_UNJOIN_MIN = LINK_CHECK_DEAD + 4,
+        LINK_CHECK_INIT  = -64,
+        LINK_CHECK_OFF   = -128,
+};
+
+enum lmic_tx_error_e {
+        LMIC_ERROR_SUCCESS = 0,
+        LMIC_ERROR_TX_BUSY = -1,
+        LMIC_ERROR_TX_TOO_LARGE = -2,
+        LMIC_ERROR_TX_NOT_FEASIBLE = -3,
+        LMIC_ERROR_TX_FAILED = -4,
+};
+typedef int lmic_tx_error_t;
+
+typedef void lmic_txmessage_cb_t(void *pUserData, int fSuccess);
+typedef void lmic_event_cb_t(void *pUserData, ev_t e);
+
+struct lmic_client_data_s
+        {
+        lmic_event_cb_t         *eventCb;
+        void                    *eventUserData;
+        lmic_txmessage_cb_t     *txMessageCb;
+        void                    *txMessageUserData;
+        };
+
+#if CFG_LMIC_EU_like
+struct band_t
+        {
+        u2_t     txcap;         // duty cycle limitation: 1/txcap
+        s1_t     txpow;         // maximum TX power
+        u1_t     lastchnl;      // last used channel
+        ostime_t avail;         // band is blocked until this time
+        };
+typedef struct band_t band_t;
+#endif
+
+#if !defined(DISABLE_PING)
+struct lmic_ping_s
+        {
+        u4_t    freq;
+        u1_t    dr;
+        u1_t    intvExp;
+        u1_t    slot;
+        u1_t    rsv;
+        };
+#endif
+
+typedef struct lmic_time_reference_s
+        {
+        ostime_t        tLocal;         // our local time
+        lmic_gpstime_t  tNetwork;       // network time, seconds since GPS epoch
+        } lmic_time_reference_t;
+
+struct lmic_t
+        {
+        osjob_t         osjob;
+        struct lmic_client_data_s client;
+
+        ostime_t        txend;
+        ostime_t        globalDutyAvail;
+        u4_t            freq;
+        u4_t            netid;
+        devaddr_t       devaddr;
+        u4_t            seqnoDn;
+        u4_t            seqnoUp;
+        u4_t            dn2Freq;
+#if !defined(DISABLE_PING)
+        struct lmic_ping_s ping;
+#endif
+        u2_t            opmode;
+        rps_t           rps;
+        s2_t            adrAckReq;
+        s1_t            txpow;
+        s1_t            adrTxPow;
+        u1_t            datarate;
+        u1_t            globalDutyRate;
+        u1_t            upRepeat;
+        u1_t            rx1DrOffset;
+        u1_t            dn2Dr;
+        u1_t            dn2Ans;
+        u1_t            rxDelay;
+        u1_t            txParam;
+        u1_t            macDlChannelAns;
+        u1_t            macRxTimingSetupAns;
+        u1_t            txChnl;
+        u1_t            adrEnabled;
+#if !defined(DISABLE_BEACONS)
+        u1_t            bcnChnl;
+#endif
+
+#if CFG_LMIC_EU_like
+        band_t          bands[MAX_BANDS];
+        u4_t            channelFreq[MAX_CHANNELS];
+# if !defined(DISABLE_MCMD_DlChannelReq)
+        u4_t            channelDlFreq[MAX_CHANNELS];
+# endif
+        u2_t            channelDrMap[MAX_CHANNELS];
+        u2_t            channelMap;
+        u2_t            channelShuffleMap;
+#elif CFG_LMIC_US_like
+        u2_t            channelMap[(72 + MAX_XCHANNELS + 15) / 16];
+        u2_t            channelShuffleMap[(72 + 15) / 16];
+        u1_t            activeChannels125khz;
+        u1_t            activeChannels500khz;
+#endif
+
+        u1_t            nwkKey[16];
+        u1_t            artKey[16];
+
+        u1_t            pendTxPort;
+        u1_t            pendTxConf;
+        u1_t            pendTxLen;
+        u1_t            pendTxData[MAX_LEN_PAYLOAD];
+
+        u1_t            txrxFlags;
+        u1_t            dataBeg;
+        u1_t            dataLen;
+        u1_t            frame[MAX_LEN_FRAME];
+
+        u1_t            lastDnConf;
+        u1_t            txCnt;
+        u1_t            rxsyms;
+        u1_t            joinAttempts;
+        };
+typedef struct lmic_t lmic_t;
+
+#if CFG_LMIC_US_like
+# define ENABLED_CHANNEL(chnl)  ((LMIC.channelMap[(chnl) >> 4] & (1 << ((chnl) & 0x0F))) != 0)
+#endif
+
+// see lmic_sim.h: LMIC is the state of the device selected in this thread.
+// __thread, not thread_local: every LMIC access would otherwise call a
+// TLS wrapper function.
+extern __thread lmic_t *LmicSim_pLMIC;
+#define LMIC    (*LmicSim_pLMIC)
+
+extern "C" {
+void LMIC_reset(void);
+void LMIC_shutdown(void);
+void LMIC_startJoining(void);
+void LMIC_tryRejoin(void);
+void LMIC_unjoin(void);
+void LMIC_setSession(u4_t netid, devaddr_t devaddr, xref2u1_t nwkKey, xref2u1_t artKey);
+void LMIC_getSessionKeys(u4_t *netid, devaddr_t *devaddr, xref2u1_t nwkKey, xref2u1_t artKey);
+bit_t LMIC_setupChannel(u1_t channel, u4_t freq, u2_t drmap, s1_t band);
+bit_t LMIC_enableChannel(u1_t channel);
+bit_t LMIC_disableChannel(u1_t channel);
+bit_t LMIC_selectSubBand(u1_t band);
+void LMIC_setDrTxpow(dr_t dr, s1_t txpow);
+void LMIC_setAdrMode(bit_t enabled);
+void LMIC_setLinkCheckMode(bit_t enabled);
+void LMIC_setClockError(u2_t error);
+lmic_tx_error_t LMIC_setTxData2(u1_t port, xref2u1_t data, u1_t dlen, u1_t confirmed);
+lmic_tx_error_t LMIC_sendWithCallback(
+        u1_t port, xref2u1_t data, u1_t dlen, u1_t confirmed,
+        lmic_txmessage_cb_t *pCb, void *pUserData
+        );
+void LMIC_clrTxData(void);
+bit_t LMIC_queryTxReady(void);
+int LMIC_registerEventCb(lmic_event_cb_t *pEventCb, void *pUserData);
+int LMIC_getNetworkTimeReference(lmic_time_reference_t *pReference);
+
+// supplied by the application (arduino-lorawan supplies this)
+void onEvent(ev_t e);
+}
+
+#define MAX_CLOCK_ERROR 65536
+
+#endif /* _lmic_h_ */
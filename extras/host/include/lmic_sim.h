@@ -0,0 +1,214 @@
+/*
+
+Module:	lmic_sim.h
+
+Function:
+	Control of the simulated LMIC used by host-native builds.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Notes:
+	The simulation has one virtual clock, which only moves when the
+	harness moves it (or the code under test calls delay()). Each
+	simulated device has its own lmic_t and job queue; `LMIC` and the
+	os_xxx()/LMIC_xxx() functions refer to the selected device. The
+	clock, the selected device and the network are per-thread, so
+	separate threads can run separate simulations.
+
+	The MAC is a model, not a port: it produces the same events, in
+	the same order, with the same LMIC fields updated, as the real
+	LMIC does for joins and uplinks, with realistic time-on-air and
+	receive-window timing. What happens to each uplink is decided by
+	a LmicSim::Network_t; the default network hears everything,
+	accepts every join, and acknowledges confirmed uplinks in RX1.
+	Join requests are retried with a growing back-off, lowering the
+	data rate every second attempt. Unacknowledged confirmed uplinks
+	are retried as the LMIC does, up to 8 attempts, lowering the data
+	rate; unconfirmed uplinks are
+	repeated NbTrans times; LinkADRReq and the ADR back-off are
+	modeled. Other MAC commands are not.
+
+*/
+
+#ifndef _lmic_sim_h_            /* prevent multiple includes */
+#define _lmic_sim_h_
+
+#pragma once
+
+#include <lmic.h>
+#include <cstdint>
+
+namespace LmicSim {
+
+class Device_t;
+
+///
+/// \brief an uplink, as seen by the network.
+///
+struct Uplink_t
+        {
+        bool            fJoin;          ///< true for a join request.
+        bool            fConfirmed;     ///< true for a confirmed data uplink.
+        u1_t            port;           ///< FPort (data uplinks).
+        u1_t            nData;          ///< FRMPayload size.
+        const u1_t      *pData;         ///< FRMPayload.
+        devaddr_t       devaddr;        ///< device address (0 for joins).
+        u4_t            seqno;          ///< FCntUp.
+        u4_t            freq;           ///< frequency, in Hz.
+        rps_t           rps;            ///< radio parameters.
+        dr_t            dr;             ///< data rate.
+        u1_t            txChnl;         ///< channel.
+        s1_t            txpow;          ///< transmit power, dBm.
+        u1_t            txCnt;          ///< number of earlier attempts at this frame.
+        bool            fAdr;           ///< ADR is enabled.
+        bool            fAdrAckReq;     ///< ADRACKReq is set.
+        std::int64_t    tStart;         ///< start of transmission, ticks.
+        std::int64_t    tEnd;           ///< end of transmission, ticks.
+        };
+
+///
+/// \brief the network's answer to an uplink.
+///
+struct Downlink_t
+        {
+        bool            fHeard;         ///< the uplink was received (a join is accepted).
+        bool            fSend;          ///< send a downlink.
+        u1_t            rxWindow;       ///< 1 or 2.
+        bool            fAck;           ///< the downlink acknowledges a confirmed uplink.
+        u1_t            port;           ///< FPort for data, or 0.
+        u1_t            nData;          ///< FRMPayload size.
+        u1_t            data[MAX_LEN_PAYLOAD]; ///< FRMPayload.
+
+        bool            fLinkAdrReq;    ///< the downlink carries a LinkADRReq...
+        dr_t            adrDr;          ///< ... with this data rate,
+        s1_t            adrTxPow;       ///< ... transmit power (dBm),
+        u1_t            adrNbTrans;     ///< ... and NbTrans (0 to leave unchanged).
+        };
+
+///
+/// \brief the model of the network (gateways and network server).
+///
+/// \details
+///     transmit() is called as each uplink starts, and uplink() at the
+///     start of its first receive window. So by the time uplink() is
+///     called, every transmission that overlapped it has been reported
+///     to transmit(). The default receives everything; it accepts joins,
+///     and answers confirmed uplinks and ADRACKReq, in RX1.
+///
+class Network_t
+        {
+public:
+        virtual ~Network_t() {}
+        virtual void transmit(Device_t &device, const Uplink_t &uplink)
+                {
+                (void) device;
+                (void) uplink;
+                }
+        virtual void uplink(Device_t &device, const Uplink_t &uplink, Downlink_t &downlink);
+        };
+
+///
+/// \brief one simulated device: its LMIC state and job queue.
+///
+class Device_t
+        {
+public:
+        Device_t();
+
+        /// \brief a device with a given id, so that a simulation with
+        ///     many threads is repeatable.
+        explicit Device_t(std::uint32_t id);
+
+        // neither copyable nor movable: the LMIC keeps pointers into it.
+        Device_t(const Device_t &) = delete;
+        Device_t &operator=(const Device_t &) = delete;
+
+        lmic_t          lmic;           ///< what `LMIC` refers to when selected.
+
+        /// \brief a number identifying the device, used for its DevAddr.
+        std::uint32_t   id;
+
+        /// \brief for the harness: anything it wants to find from the device.
+        void            *pUserData = nullptr;
+
+        /// \brief number of uplinks started (joins and data).
+        std::uint32_t   nUplinks = 0;
+        /// \brief number of join requests sent.
+        std::uint32_t   nJoinRequests = 0;
+        /// \brief total time on air, in ticks.
+        std::int64_t    tAirtime = 0;
+        /// \brief total time receive windows were open, in ticks.
+        std::int64_t    tRxOpen = 0;
+
+private:
+        friend struct DeviceAccess;
+
+        osjob_t         *m_pJobs = nullptr;     ///< scheduled jobs, by deadline.
+        Uplink_t        m_uplink;               ///< the uplink in progress.
+        Downlink_t      m_downlink;             ///< the answer to it.
+        unsigned        m_iChannel = 0;         ///< for round-robin channel choice.
+        std::uint32_t   m_rng;                  ///< random number state.
+        };
+
+/// \brief select the device that `LMIC` and the LMIC APIs refer to in
+///     this thread.
+void select(Device_t &device);
+
+/// \brief return the selected device.
+Device_t &getDevice();
+
+/// \brief set the network model; nullptr restores the default.
+void setNetwork(Network_t *pNetwork);
+
+/// \brief return the current time, in ticks (never wraps).
+std::int64_t getTicks();
+
+/// \brief set the current time, in ticks. Time should only go forward.
+void setTicks(std::int64_t ticks);
+
+/// \brief move time forward.
+void advance(std::int64_t ticks);
+
+///
+/// \brief find when the selected device's next job is due.
+///
+/// \param [out] ticks set to the deadline, in ticks.
+///
+/// \return \c false if no jobs are scheduled.
+///
+bool getNextDeadline(std::int64_t &ticks);
+
+///
+/// \brief time on air of a LoRa or FSK frame.
+///
+/// \param [in] rps radio parameters.
+/// \param [in] nPhyPayload bytes of PHY payload (MHDR to MIC).
+///
+/// \return time on air, in ticks.
+///
+ostime_t getAirtime(rps_t rps, unsigned nPhyPayload);
+
+/// \brief the radio parameters of a data rate, in the configured region.
+rps_t getRpsForDr(dr_t dr);
+
+///
+/// \brief time on air of the answer to an uplink of the selected device.
+///
+/// \param [in] uplink the uplink.
+/// \param [in] downlink the answer; \c rxWindow selects the data rate.
+///
+ostime_t getDownlinkAirtime(const Uplink_t &uplink, const Downlink_t &downlink);
+
+} // namespace LmicSim
+
+#endif /* _lmic_sim_h_ */
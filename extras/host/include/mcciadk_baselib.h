@@ -0,0 +1,48 @@
+/*
+
+Module:	mcciadk_baselib.h
+
+Function:
+	Minimal MCCI ADK base library for host-native builds.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _MCCIADK_BASELIB_H_     /* prevent multiple includes */
+#define _MCCIADK_BASELIB_H_
+
+#pragma once
+
+#include <mcciadk_env.h>
+#include <cstddef>
+
+MCCIADK_BEGIN_DECLS
+
+const char *
+McciAdkLib_MultiSzIndex(
+        const char *pMultiSz,
+        unsigned iString
+        );
+
+size_t
+McciAdkLib_SafeCopyString(
+        char *pBuffer,
+        size_t nBuffer,
+        size_t iBuffer,
+        const char *pString
+        );
+
+MCCIADK_END_DECLS
+
+#endif /* _MCCIADK_BASELIB_H_ */
@@ -0,0 +1,44 @@
+/*
+
+Module:	mcciadk_env.h
+
+Function:
+	Minimal MCCI ADK environment definitions for host-native builds.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _MCCIADK_ENV_H_         /* prevent multiple includes */
+#define _MCCIADK_ENV_H_
+
+#pragma once
+
+#include <cstddef>
+
+#ifndef MCCIADK_DEBUG
+# define MCCIADK_DEBUG  0
+#endif
+
+#ifdef __cplusplus
+# define MCCIADK_BEGIN_DECLS    extern "C" {
+# define MCCIADK_END_DECLS      }
+#else
+# define MCCIADK_BEGIN_DECLS    /* nothing */
+# define MCCIADK_END_DECLS      /* nothing */
+#endif
+
+#define MCCIADK_LENOF(a)                (sizeof(a) / sizeof((a)[0]))
+#define MCCIADK_API_PARAMETER(v)        ((void)(v))
+
+#endif /* _MCCIADK_ENV_H_ */
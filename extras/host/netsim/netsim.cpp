@@ -0,0 +1,339 @@
+/*
+
+Module:	netsim.cpp
+
+Function:
+	Discrete-event network simulator for arduino-lorawan: main program.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Usage:
+	netsim [-n nodes] [-c cells] [-j threads] [-t hours] [-i seconds]
+	       [-p bytes] [-r meters] [-s seed] [--jitter fraction]
+	       [--confirmed] [--no-adr]
+	       [--volts V] [--tx-ma mA] [--rx-ma mA] [--sleep-ua uA]
+	       [--csv file]
+
+	Simulates cells of nodes (default 1 cell of 1000 nodes), each
+	node sending a payload-byte uplink every interval seconds, for the
+	given number of simulated hours. Cells run in parallel, one per
+	thread (default: one thread per core). Prints delivery ratio,
+	losses, airtime and energy for each cell and in total, and how
+	much faster than real time the simulation ran. --csv writes one
+	line per node.
+
+	The current profile defaults to an SX1276 board: transmit current
+	by power (from the datasheet), 11.5 mA receiving, 1.5 uA asleep
+	at 3.3 V. --tx-ma sets a fixed transmit current instead.
+
+*/
+
+#include "netsim.h"
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace NetSim;
+
+/****************************************************************************\
+|
+|	Reporting
+|
+\****************************************************************************/
+
+namespace {
+
+struct Totals_t
+    {
+    std::uint64_t nNodes = 0;
+    std::uint64_t nOffered = 0;
+    std::uint64_t nSubmitted = 0;
+    std::uint64_t nCompleted = 0;
+    std::uint64_t nDelivered = 0;
+    std::uint64_t nTransmissions = 0;
+    std::uint64_t nJoinRequests = 0;
+    std::uint64_t nCollisions = 0;
+    std::uint64_t nWeak = 0;
+    std::uint64_t nGatewayBusy = 0;
+    std::uint64_t nDownlinks = 0;
+    std::uint64_t nDownlinksDropped = 0;
+    std::uint64_t nEvents = 0;
+    std::uint64_t nByDr[16] = {};
+    double airtime = 0;
+    double energy = 0;
+    double simSeconds = 0;
+    double cpuSeconds = 0;
+
+    void add(const Config_t &config, const CellStats_t &cell)
+        {
+        for (auto const &node : cell.nodes)
+            {
+            ++this->nNodes;
+            this->nOffered += node.nOffered;
+            this->nSubmitted += node.nSubmitted;
+            this->nCompleted += node.nCompleted;
+            this->nDelivered += node.nDelivered;
+            this->nTransmissions += node.nTransmissions;
+            this->nJoinRequests += node.nJoinRequests;
+            this->nCollisions += node.nCollisions;
+            this->nWeak += node.nWeak;
+            this->nGatewayBusy += node.nGatewayBusy;
+            this->nByDr[node.dr & 15] += 1;
+            this->airtime += node.airtime;
+            this->energy += getEnergy(config, cell, node);
+            }
+        this->nDownlinks += cell.nDownlinks;
+        this->nDownlinksDropped += cell.nDownlinksDropped;
+        this->nEvents += cell.nEvents;
+        this->simSeconds = std::max(this->simSeconds, cell.simSeconds);
+        this->cpuSeconds += cell.cpuSeconds;
+        }
+
+    void print(const char *pName) const
+        {
+        auto const ratio = [](std::uint64_t n, std::uint64_t d)
+            {
+            return d == 0 ? 0.0 : 100.0 * double(n) / double(d);
+            };
+        auto const nLost = this->nCollisions + this->nWeak + this->nGatewayBusy;
+        auto const nUplinks = this->nTransmissions + this->nJoinRequests;
+        auto const perNode = this->nNodes == 0 ? 0.0 : 1.0 / double(this->nNodes);
+
+        std::printf("%s: %llu node(s), %llu message(s) offered, %llu submitted, %llu delivered\n",
+            pName,
+            (unsigned long long) this->nNodes,
+            (unsigned long long) this->nOffered,
+            (unsigned long long) this->nSubmitted,
+            (unsigned long long) this->nDelivered
+            );
+        std::printf("  delivery ratio %.2f%% of offered (%.2f%% of submitted)\n",
+            ratio(this->nDelivered, this->nOffered),
+            ratio(this->nDelivered, this->nSubmitted)
+            );
+        std::printf("  %llu uplink(s) incl. %llu join(s); lost %.2f%%: collision %llu, weak %llu, gateway busy %llu\n",
+            (unsigned long long) nUplinks,
+            (unsigned long long) this->nJoinRequests,
+            ratio(nLost, nUplinks),
+            (unsigned long long) this->nCollisions,
+            (unsigned long long) this->nWeak,
+            (unsigned long long) this->nGatewayBusy
+            );
+        std::printf("  %llu downlink(s), %llu dropped\n",
+            (unsigned long long) this->nDownlinks,
+            (unsigned long long) this->nDownlinksDropped
+            );
+        std::printf("  per node: airtime %.3f s, energy %.3f J\n",
+            this->airtime * perNode,
+            this->energy * perNode / 1000.0
+            );
+        std::printf("  final DR:");
+        for (unsigned dr = 0; dr < 16; ++dr)
+            {
+            if (this->nByDr[dr] != 0)
+                std::printf(" DR%u=%llu", dr, (unsigned long long) this->nByDr[dr]);
+            }
+        std::printf("\n");
+        }
+    };
+
+bool writeCsv(const char *pFile, const Config_t &config, const std::vector<CellStats_t> &cells)
+    {
+    std::FILE *fp = std::fopen(pFile, "w");
+
+    if (fp == nullptr)
+        return false;
+
+    std::fprintf(fp, "cell,node,distance,dr,txpow,offered,submitted,completed,delivered,"
+                     "transmissions,joins,collisions,weak,gateway_busy,airtime_s,rx_s,energy_mj\n");
+
+    for (unsigned iCell = 0; iCell < cells.size(); ++iCell)
+        {
+        auto const &cell = cells[iCell];
+
+        for (unsigned iNode = 0; iNode < cell.nodes.size(); ++iNode)
+            {
+            auto const &node = cell.nodes[iNode];
+
+            std::fprintf(fp, "%u,%u,%.1f,%u,%d,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%.4f,%.4f,%.3f\n",
+                iCell, iNode, node.distance, node.dr, node.txpow,
+                (unsigned long) node.nOffered,
+                (unsigned long) node.nSubmitted,
+                (unsigned long) node.nCompleted,
+                (unsigned long) node.nDelivered,
+                (unsigned long) node.nTransmissions,
+                (unsigned long) node.nJoinRequests,
+                (unsigned long) node.nCollisions,
+                (unsigned long) node.nWeak,
+                (unsigned long) node.nGatewayBusy,
+                node.airtime, node.rxTime,
+                getEnergy(config, cell, node)
+                );
+            }
+        }
+
+    return std::fclose(fp) == 0;
+    }
+
+} // namespace
+
+/****************************************************************************\
+|
+|	The main program
+|
+\****************************************************************************/
+
+static int usage(const char *pName)
+    {
+    std::fprintf(stderr,
+        "usage: %s [-n nodes] [-c cells] [-j threads] [-t hours] [-i seconds]\n"
+        "       [-p bytes] [-r meters] [-s seed] [--jitter fraction]\n"
+        "       [--confirmed] [--no-adr]\n"
+        "       [--volts V] [--tx-ma mA] [--rx-ma mA] [--sleep-ua uA]\n"
+        "       [--csv file]\n",
+        pName
+        );
+    return 2;
+    }
+
+int main(int argc, char **argv)
+    {
+    Config_t config;
+    const char *pCsv = nullptr;
+
+    for (int iArg = 1; iArg < argc; ++iArg)
+        {
+        const char *pArg = argv[iArg];
+        const char *pValue = iArg + 1 < argc ? argv[iArg + 1] : nullptr;
+        auto const is = [pArg, pValue, &iArg](const char *pOption)
+            {
+            if (std::strcmp(pArg, pOption) != 0 || pValue == nullptr)
+                return false;
+            ++iArg;
+            return true;
+            };
+
+        if (is("-n"))
+            config.nNodes = unsigned(std::strtoul(pValue, nullptr, 0));
+        else if (is("-c"))
+            config.nCells = unsigned(std::strtoul(pValue, nullptr, 0));
+        else if (is("-j"))
+            config.nThreads = unsigned(std::strtoul(pValue, nullptr, 0));
+        else if (is("-t"))
+            config.hours = std::strtod(pValue, nullptr);
+        else if (is("-i"))
+            config.interval = std::strtod(pValue, nullptr);
+        else if (is("-p"))
+            config.payload = unsigned(std::strtoul(pValue, nullptr, 0));
+        else if (is("-r"))
+            config.radius = std::strtod(pValue, nullptr);
+        else if (is("-s"))
+            config.seed = std::uint32_t(std::strtoul(pValue, nullptr, 0));
+        else if (is("--jitter"))
+            config.jitter = std::strtod(pValue, nullptr);
+        else if (is("--volts"))
+            config.volts = std::strtod(pValue, nullptr);
+        else if (is("--tx-ma"))
+            config.txMilliamps = std::strtod(pValue, nullptr);
+        else if (is("--rx-ma"))
+            config.rxMilliamps = std::strtod(pValue, nullptr);
+        else if (is("--sleep-ua"))
+            config.sleepMicroamps = std::strtod(pValue, nullptr);
+        else if (is("--csv"))
+            pCsv = pValue;
+        else if (std::strcmp(pArg, "--confirmed") == 0)
+            config.fConfirmed = true;
+        else if (std::strcmp(pArg, "--no-adr") == 0)
+            config.fAdr = false;
+        else
+            return usage(argv[0]);
+        }
+
+    if (config.nNodes == 0 || config.nCells == 0 || config.interval <= 0 ||
+        config.payload == 0 || config.payload > 222)
+        return usage(argv[0]);
+
+    unsigned nThreads = config.nThreads;
+
+    if (nThreads == 0)
+        nThreads = std::max(1u, std::thread::hardware_concurrency());
+    nThreads = std::min(nThreads, config.nCells);
+
+    // the nodes log nothing, but make sure.
+    Serial.setOutput(nullptr);
+
+    std::vector<CellStats_t> cells(config.nCells);
+    std::atomic<unsigned> iNextCell { 0 };
+    std::vector<std::thread> threads;
+    auto const tStart = std::chrono::steady_clock::now();
+
+    for (unsigned i = 0; i < nThreads; ++i)
+        {
+        threads.emplace_back(
+            [&config, &cells, &iNextCell]()
+                {
+                for (unsigned iCell; (iCell = iNextCell++) < config.nCells; )
+                    cells[iCell] = runCell(config, iCell);
+                }
+            );
+        }
+
+    for (auto &thread : threads)
+        thread.join();
+
+    auto const wallSeconds = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - tStart
+                                ).count();
+
+    Totals_t total;
+
+    for (unsigned iCell = 0; iCell < cells.size(); ++iCell)
+        {
+        if (cells.size() > 1)
+            {
+            Totals_t cell;
+            char name[24];
+
+            cell.add(config, cells[iCell]);
+            std::snprintf(name, sizeof(name), "cell %u", iCell);
+            cell.print(name);
+            }
+        total.add(config, cells[iCell]);
+        }
+
+    total.print("total");
+    std::printf("simulated %.1f h of %u cell(s) in %.3f s on %u thread(s): %.0fx real time; %llu activation(s), %.0f/s\n",
+        total.simSeconds / 3600.0,
+        config.nCells,
+        wallSeconds,
+        nThreads,
+        wallSeconds == 0 ? 0.0 : total.simSeconds * config.nCells / wallSeconds,
+        (unsigned long long) total.nEvents,
+        wallSeconds == 0 ? 0.0 : total.nEvents / wallSeconds
+        );
+
+    if (pCsv != nullptr && ! writeCsv(pCsv, config, cells))
+        {
+        std::fprintf(stderr, "can't write %s\n", pCsv);
+        return 1;
+        }
+
+    return 0;
+    }
@@ -0,0 +1,129 @@
+/*
+
+Module:	netsim.h
+
+Function:
+	Discrete-event simulation of many arduino-lorawan devices.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Notes:
+	A cell is one gateway and its network server, with a number of
+	nodes (each an Arduino_LoRaWAN_network with its own simulated LMIC)
+	placed at random around it. Cells don't interfere with each other,
+	so each one runs in a single thread, and cells run in parallel.
+
+	The radio model is deliberately simple:
+
+	- path loss is log-distance, fitted to measurements around a
+	  gateway 24 m up (Petajajarvi et al., "On the Coverage of
+	  LPWANs: Range Evaluation and Channel Attenuation Model for
+	  LoRa Technology", 2015), with log-normal shadowing fixed per
+	  node;
+	- an uplink is heard if its SNR meets the demodulator floor for
+	  its spreading factor;
+	- an uplink is lost if it overlaps another on the same frequency
+	  and spreading factor, unless it is at least 6 dB stronger than
+	  each of them (capture), or if it overlaps a downlink from the
+	  gateway (which is half-duplex);
+	- the gateway sends at most one downlink at a time, and obeys
+	  the regional duty cycle (EU-like regions) in each window.
+
+	Collisions and capture follow Bor et al., "Do LoRa Low-Power
+	Wide-Area Networks Scale?", 2016.
+
+	The network server accepts joins, acknowledges confirmed uplinks,
+	answers ADRACKReq, and runs ADR with LinkADRReq (the Semtech
+	algorithm, on the best SNR of the last 20 uplinks).
+
+*/
+
+#ifndef _netsim_h_		/* prevent multiple includes */
+#define _netsim_h_
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace NetSim {
+
+///
+/// \brief what to simulate.
+///
+struct Config_t
+    {
+    unsigned nNodes = 1000;             ///< nodes per cell.
+    unsigned nCells = 1;                ///< independent cells.
+    unsigned nThreads = 0;              ///< worker threads; 0 for one per core.
+    double hours = 24.0;                ///< simulated time.
+    double interval = 600.0;            ///< seconds between uplinks from a node.
+    double jitter = 0.1;                ///< random +/- fraction of the interval.
+    unsigned payload = 12;              ///< uplink size, bytes.
+    bool fConfirmed = false;            ///< send confirmed uplinks.
+    bool fAdr = true;                   ///< network server runs ADR.
+    double radius = 2000.0;             ///< cell radius, meters.
+    double shadowing = 7.8;             ///< shadowing sigma, dB.
+    std::uint32_t seed = 1;             ///< random seed.
+
+    // the current profile for energy estimates.
+    double volts = 3.3;                 ///< supply voltage.
+    double txMilliamps = 0.0;           ///< transmit current; 0 to use a table by power.
+    double rxMilliamps = 11.5;          ///< receive current.
+    double sleepMicroamps = 1.5;        ///< current between radio operations.
+    };
+
+///
+/// \brief the results for one node.
+///
+struct NodeStats_t
+    {
+    double distance = 0;                ///< from the gateway, meters.
+    unsigned dr = 0;                    ///< data rate at the end.
+    int txpow = 0;                      ///< transmit power at the end, dBm.
+    std::uint32_t nOffered = 0;         ///< messages the application tried to send.
+    std::uint32_t nSubmitted = 0;       ///< ... that SendBuffer() accepted.
+    std::uint32_t nCompleted = 0;       ///< ... that completed.
+    std::uint32_t nDelivered = 0;       ///< ... that the network server received.
+    std::uint32_t nTransmissions = 0;   ///< data frames sent, counting repeats.
+    std::uint32_t nJoinRequests = 0;    ///< join requests sent.
+    std::uint32_t nCollisions = 0;      ///< transmissions lost to collisions.
+    std::uint32_t nWeak = 0;            ///< transmissions below sensitivity.
+    std::uint32_t nGatewayBusy = 0;     ///< transmissions lost while the gateway sent.
+    double airtime = 0;                 ///< time on air, seconds.
+    double rxTime = 0;                  ///< receive windows open, seconds.
+    double charge = 0;                  ///< millicoulombs.
+    };
+
+///
+/// \brief the results for one cell.
+///
+struct CellStats_t
+    {
+    std::vector<NodeStats_t> nodes;
+    std::uint64_t nDownlinks = 0;       ///< downlinks sent by the gateway.
+    std::uint64_t nDownlinksDropped = 0; ///< downlinks not sent (gateway busy or duty cycle).
+    double simSeconds = 0;              ///< simulated time.
+    double cpuSeconds = 0;              ///< time taken to simulate.
+    std::uint64_t nEvents = 0;          ///< node activations.
+    };
+
+/// \brief simulate one cell.
+CellStats_t runCell(const Config_t &config, unsigned iCell);
+
+/// \brief the energy used by a node, in millijoules.
+double getEnergy(const Config_t &config, const CellStats_t &cell, const NodeStats_t &node);
+
+} // namespace NetSim
+
+#endif /* _netsim_h_ */
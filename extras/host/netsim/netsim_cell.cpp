@@ -0,0 +1,648 @@
+/*
+
+Module:	netsim_cell.cpp
+
+Function:
+	NetSim::runCell(): one gateway, its network server, and its nodes.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include "netsim.h"
+
+#include <Arduino_LoRaWAN_network.h>
+#include <Arduino_LoRaWAN_lmic.h>
+#include <lmic_sim.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <new>
+#include <queue>
+#include <random>
+
+namespace NetSim {
+
+namespace {
+
+/****************************************************************************\
+|
+|	The radio model
+|
+\****************************************************************************/
+
+// log-distance path loss at 868 MHz (Petajajarvi et al.)
+constexpr double kRefDistance = 1000.0;
+constexpr double kRefPathLoss = 128.95;
+constexpr double kPathLossExponent = 2.32;
+
+constexpr double kNoiseFigure = 6.0;            // dB
+constexpr double kCaptureThreshold = 6.0;       // dB
+
+// ADR, as in Semtech's network server.
+constexpr unsigned kAdrHistory = 20;
+constexpr double kAdrInstallMargin = 10.0;      // dB
+constexpr int kAdrMinTxPow = 2;                 // dBm
+
+// time allowed after the last send for messages to finish.
+constexpr double kDrainSeconds = 600.0;
+
+// gateway duty cycle in each receive window, as 1/n (EU-like regions).
+constexpr unsigned kRx1DutyCap = 100;
+constexpr unsigned kRx2DutyCap = 10;
+
+/// \brief demodulator SNR floor for a spreading factor.
+double getSnrFloor(sf_t sf)
+    {
+    return sf == FSK ? 10.0 : -7.5 - 2.5 * (sf - SF7);
+    }
+
+/// \brief receiver noise floor for a bandwidth, dBm.
+double getNoiseFloor(bw_t bw)
+    {
+    return -174.0 + 10.0 * std::log10(125000.0 * (1 << bw)) + kNoiseFigure;
+    }
+
+/// \brief SX1276 supply current when transmitting, by power.
+double getTxCurrent(const Config_t &config, int txpow)
+    {
+    if (config.txMilliamps > 0)
+        return config.txMilliamps;
+
+    struct Point_t { int dBm; double mA; };
+    static const Point_t kTable[] =
+        {
+        { 2, 24.0 }, { 5, 25.0 }, { 8, 26.0 }, { 11, 31.0 },
+        { 14, 44.0 }, { 17, 87.0 }, { 20, 120.0 },
+        };
+
+    if (txpow <= kTable[0].dBm)
+        return kTable[0].mA;
+
+    for (std::size_t i = 1; i < sizeof(kTable) / sizeof(kTable[0]); ++i)
+        {
+        if (txpow <= kTable[i].dBm)
+            {
+            auto const &lo = kTable[i - 1];
+            auto const &hi = kTable[i];
+
+            return lo.mA + (hi.mA - lo.mA) * (txpow - lo.dBm) / (hi.dBm - lo.dBm);
+            }
+        }
+
+    return kTable[sizeof(kTable) / sizeof(kTable[0]) - 1].mA;
+    }
+
+double ticksToSeconds(std::int64_t ticks)
+    {
+    return double(ticks) / OSTICKS_PER_SEC;
+    }
+
+std::int64_t secondsToTicks(double seconds)
+    {
+    return std::int64_t(seconds * OSTICKS_PER_SEC);
+    }
+
+/// \brief an uplink on the air.
+struct Transmission_t
+    {
+    const void *pNode;
+    u4_t freq;
+    sf_t sf;
+    bw_t bw;
+    std::int64_t tStart;
+    std::int64_t tEnd;
+    double rssi;
+    };
+
+/// \brief a downlink from the gateway.
+struct GatewayTx_t
+    {
+    std::int64_t tStart;
+    std::int64_t tEnd;
+    };
+
+bool overlaps(std::int64_t aStart, std::int64_t aEnd, std::int64_t bStart, std::int64_t bEnd)
+    {
+    return aStart < bEnd && bStart < aEnd;
+    }
+
+/****************************************************************************\
+|
+|	The nodes
+|
+\****************************************************************************/
+
+class Cell_t;
+
+class Node_t : public Arduino_LoRaWAN_network
+    {
+public:
+    Node_t(std::uint32_t id, unsigned index)
+        : device(id)
+        , m_index(index)
+        {}
+
+    // Arduino_LoRaWAN objects are normally static, and the library
+    // counts on their starting out zeroed.
+    static void *operator new(std::size_t size)
+        {
+        void *const p = std::calloc(1, size);
+
+        if (p == nullptr)
+            throw std::bad_alloc();
+        return p;
+        }
+
+    static void operator delete(void *p)
+        {
+        std::free(p);
+        }
+
+    LmicSim::Device_t device;           ///< the simulated LMIC.
+    NodeStats_t stats;
+    double pathLoss = 0;                ///< dB.
+
+    // the application.
+    bool fBegun = false;
+    std::int64_t tNextSend = 0;
+
+    // the network server's view of the node.
+    bool fSeen = false;                 ///< lastSeqno is valid.
+    u4_t lastSeqno = 0;
+    int maxTxPow = 0;                   ///< the power of its join request.
+    double snrHistory[kAdrHistory];
+    unsigned nHistory = 0;
+
+    static void sendDone(void *pCtx, bool fSuccess)
+        {
+        (void) fSuccess;
+        ++static_cast<Node_t *>(pCtx)->stats.nCompleted;
+        }
+
+protected:
+    virtual bool GetOtaaProvisioningInfo(OtaaProvisioningInfo *pInfo) override
+        {
+        if (pInfo != nullptr)
+            {
+            std::memset(pInfo, 0, sizeof(*pInfo));
+            std::memset(pInfo->AppKey, 0x5A, sizeof(pInfo->AppKey));
+            std::memcpy(pInfo->DevEUI, &this->device.id, sizeof(this->device.id));
+            std::memcpy(pInfo->DevEUI + 4, &this->m_index, sizeof(this->m_index));
+            }
+        return true;
+        }
+
+private:
+    unsigned m_index;
+    };
+
+/****************************************************************************\
+|
+|	The cell: gateway, network server, and scheduler
+|
+\****************************************************************************/
+
+class Cell_t : public LmicSim::Network_t
+    {
+public:
+    Cell_t(const Config_t &config, unsigned iCell);
+
+    CellStats_t run();
+
+    virtual void transmit(LmicSim::Device_t &device, const LmicSim::Uplink_t &uplink) override;
+    virtual void uplink(
+        LmicSim::Device_t &device,
+        const LmicSim::Uplink_t &uplink,
+        LmicSim::Downlink_t &downlink
+        ) override;
+
+private:
+    static Node_t &getNode(LmicSim::Device_t &device)
+        {
+        return *static_cast<Node_t *>(device.pUserData);
+        }
+
+    std::int64_t runNode(Node_t &node);
+    void runAdr(Node_t &node, const LmicSim::Uplink_t &uplink, LmicSim::Downlink_t &downlink);
+    bool scheduleDownlink(const LmicSim::Uplink_t &uplink, LmicSim::Downlink_t &downlink);
+    std::int64_t getSendInterval();
+
+    const Config_t &m_config;
+    std::mt19937 m_rng;
+    std::vector<std::unique_ptr<Node_t>> m_nodes;
+    std::deque<Transmission_t> m_air;
+    std::deque<GatewayTx_t> m_gatewayTx;
+    std::int64_t m_rx1Avail = 0;
+    std::int64_t m_rx2Avail = 0;
+    std::int64_t m_tEndSend;
+    dr_t m_maxAdrDr = 0;
+    CellStats_t m_stats;
+    };
+
+Cell_t::Cell_t(const Config_t &config, unsigned iCell)
+    : m_config(config)
+    , m_rng(config.seed * 1000003u + iCell)
+    {
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::normal_distribution<double> shadowing(0.0, config.shadowing);
+
+    this->m_tEndSend = secondsToTicks(config.hours * 3600.0);
+
+    for (unsigned i = 0; i < config.nNodes; ++i)
+        {
+        std::unique_ptr<Node_t> pNode(new Node_t(iCell * config.nNodes + i + 1, i));
+
+        // uniform over the area of the cell.
+        pNode->stats.distance = std::max(1.0, config.radius * std::sqrt(uniform(this->m_rng)));
+        pNode->pathLoss = kRefPathLoss +
+                          10.0 * kPathLossExponent * std::log10(pNode->stats.distance / kRefDistance) +
+                          shadowing(this->m_rng);
+        pNode->device.pUserData = pNode.get();
+        // nodes power up (and send) at random in the first interval.
+        pNode->tNextSend = secondsToTicks(config.interval * uniform(this->m_rng));
+        pNode->SetDebugMask(0);
+
+        this->m_nodes.push_back(std::move(pNode));
+        }
+
+    // ADR uses the 125 kHz LoRa data rates.
+    while (this->m_maxAdrDr < 15)
+        {
+        auto const rps = LmicSim::getRpsForDr(dr_t(this->m_maxAdrDr + 1));
+
+        if (getSf(rps) == FSK || getBw(rps) != BW125)
+            break;
+        ++this->m_maxAdrDr;
+        }
+    }
+
+std::int64_t Cell_t::getSendInterval()
+    {
+    std::uniform_real_distribution<double> jitter(-this->m_config.jitter, this->m_config.jitter);
+
+    return std::max<std::int64_t>(
+        1,
+        secondsToTicks(this->m_config.interval * (1.0 + jitter(this->m_rng)))
+        );
+    }
+
+///
+/// \brief run a node until it has nothing to do now.
+///
+/// \return when it next needs to run, or -1 if never.
+///
+std::int64_t Cell_t::runNode(Node_t &node)
+    {
+    LmicSim::select(node.device);
+    Arduino_LoRaWAN::SetInstance(&node);
+
+    if (! node.fBegun)
+        {
+        node.fBegun = true;
+        node.begin();
+        }
+
+    auto const runDueJobs = [&node]()
+        {
+        std::int64_t tJob;
+
+        while (LmicSim::getNextDeadline(tJob) && tJob <= LmicSim::getTicks())
+            node.loop();
+        };
+
+    runDueJobs();
+
+    auto const now = LmicSim::getTicks();
+
+    if (node.tNextSend <= now && node.tNextSend < this->m_tEndSend)
+        {
+        std::vector<uint8_t> payload(this->m_config.payload, uint8_t(node.stats.nOffered));
+
+        ++node.stats.nOffered;
+        if (node.SendBuffer(
+                payload.data(), payload.size(),
+                Node_t::sendDone, &node,
+                this->m_config.fConfirmed
+                ))
+            ++node.stats.nSubmitted;
+
+        node.tNextSend = now + this->getSendInterval();
+        runDueJobs();
+        }
+
+    std::int64_t tWake = node.tNextSend < this->m_tEndSend ? node.tNextSend : -1;
+    std::int64_t tJob;
+
+    if (LmicSim::getNextDeadline(tJob) && (tWake < 0 || tJob < tWake))
+        tWake = tJob;
+
+    return tWake;
+    }
+
+CellStats_t Cell_t::run()
+    {
+    auto const tStart = std::chrono::steady_clock::now();
+    auto const tStop = this->m_tEndSend + secondsToTicks(kDrainSeconds);
+
+    struct Wake_t
+        {
+        std::int64_t t;
+        unsigned iNode;
+
+        bool operator>(const Wake_t &other) const
+            {
+            return this->t != other.t ? this->t > other.t : this->iNode > other.iNode;
+            }
+        };
+
+    std::priority_queue<Wake_t, std::vector<Wake_t>, std::greater<Wake_t>> wakeups;
+
+    LmicSim::setTicks(0);
+    LmicSim::setNetwork(this);
+
+    for (unsigned i = 0; i < this->m_nodes.size(); ++i)
+        wakeups.push(Wake_t { this->m_nodes[i]->tNextSend, i });
+
+    // each node is in the queue once: it only changes when it runs.
+    while (! wakeups.empty() && wakeups.top().t <= tStop)
+        {
+        auto const wake = wakeups.top();
+        wakeups.pop();
+
+        if (wake.t > LmicSim::getTicks())
+            LmicSim::setTicks(wake.t);
+
+        ++this->m_stats.nEvents;
+
+        auto const tNext = this->runNode(*this->m_nodes[wake.iNode]);
+        if (tNext >= 0)
+            wakeups.push(Wake_t { std::max(tNext, LmicSim::getTicks()), wake.iNode });
+        }
+
+    LmicSim::setNetwork(nullptr);
+    Arduino_LoRaWAN::SetInstance(nullptr);
+
+    for (auto &pNode : this->m_nodes)
+        {
+        LmicSim::select(pNode->device);
+
+        pNode->stats.dr = LMIC.datarate;
+        pNode->stats.txpow = LMIC.adrTxPow;
+        pNode->stats.airtime = ticksToSeconds(pNode->device.tAirtime);
+        pNode->stats.rxTime = ticksToSeconds(pNode->device.tRxOpen);
+        pNode->stats.charge += this->m_config.rxMilliamps * pNode->stats.rxTime;
+        this->m_stats.nodes.push_back(pNode->stats);
+        }
+
+    this->m_stats.simSeconds = ticksToSeconds(LmicSim::getTicks());
+    this->m_stats.cpuSeconds = std::chrono::duration<double>(
+                                    std::chrono::steady_clock::now() - tStart
+                                    ).count();
+    return this->m_stats;
+    }
+
+/****************************************************************************\
+|
+|	The network
+|
+\****************************************************************************/
+
+void Cell_t::transmit(LmicSim::Device_t &device, const LmicSim::Uplink_t &uplink)
+    {
+    Node_t &node = getNode(device);
+
+    if (uplink.fJoin)
+        {
+        ++node.stats.nJoinRequests;
+        node.maxTxPow = uplink.txpow;
+        }
+    else
+        ++node.stats.nTransmissions;
+
+    node.stats.charge += getTxCurrent(this->m_config, uplink.txpow) *
+                         ticksToSeconds(uplink.tEnd - uplink.tStart);
+
+    this->m_air.push_back(
+        Transmission_t
+            {
+            &node,
+            uplink.freq,
+            getSf(uplink.rps),
+            getBw(uplink.rps),
+            uplink.tStart,
+            uplink.tEnd,
+            uplink.txpow - node.pathLoss
+            }
+        );
+    }
+
+void Cell_t::uplink(
+    LmicSim::Device_t &device,
+    const LmicSim::Uplink_t &uplink,
+    LmicSim::Downlink_t &downlink
+    )
+    {
+    Node_t &node = getNode(device);
+    auto const now = LmicSim::getTicks();
+
+    // forget what can no longer overlap anything still to be judged.
+    auto const tForget = now - secondsToTicks(20.0);
+
+    while (! this->m_air.empty() && this->m_air.front().tEnd < tForget)
+        this->m_air.pop_front();
+    while (! this->m_gatewayTx.empty() && this->m_gatewayTx.front().tEnd < tForget)
+        this->m_gatewayTx.pop_front();
+
+    auto const pSelf = std::find_if(
+        this->m_air.begin(), this->m_air.end(),
+        [&node, &uplink](const Transmission_t &t)
+            {
+            return t.pNode == &node && t.tStart == uplink.tStart;
+            }
+        );
+
+    if (pSelf == this->m_air.end())
+        return;
+
+    auto const &self = *pSelf;
+    double const snr = self.rssi - getNoiseFloor(self.bw);
+
+    if (snr < getSnrFloor(self.sf))
+        {
+        ++node.stats.nWeak;
+        return;
+        }
+
+    for (auto const &tx : this->m_gatewayTx)
+        {
+        if (overlaps(self.tStart, self.tEnd, tx.tStart, tx.tEnd))
+            {
+            ++node.stats.nGatewayBusy;
+            return;
+            }
+        }
+
+    for (auto const &other : this->m_air)
+        {
+        if (&other != &self &&
+            other.freq == self.freq && other.sf == self.sf && other.bw == self.bw &&
+            overlaps(self.tStart, self.tEnd, other.tStart, other.tEnd) &&
+            self.rssi - other.rssi < kCaptureThreshold)
+            {
+            ++node.stats.nCollisions;
+            return;
+            }
+        }
+
+    downlink.fHeard = true;
+
+    bool fWant;
+
+    if (uplink.fJoin)
+        {
+        node.fSeen = false;
+        node.nHistory = 0;
+        fWant = true;
+        }
+    else
+        {
+        if (! node.fSeen || uplink.seqno != node.lastSeqno)
+            {
+            ++node.stats.nDelivered;
+            node.fSeen = true;
+            node.lastSeqno = uplink.seqno;
+            }
+
+        node.snrHistory[node.nHistory % kAdrHistory] = snr;
+        ++node.nHistory;
+
+        downlink.fAck = uplink.fConfirmed;
+        if (this->m_config.fAdr && uplink.fAdr)
+            this->runAdr(node, uplink, downlink);
+
+        fWant = uplink.fConfirmed || uplink.fAdrAckReq || downlink.fLinkAdrReq;
+        }
+
+    if (fWant)
+        downlink.fSend = this->scheduleDownlink(uplink, downlink);
+    }
+
+///
+/// \brief run ADR for a node, and add a LinkADRReq to the downlink if
+///     its data rate or power should change.
+///
+void Cell_t::runAdr(Node_t &node, const LmicSim::Uplink_t &uplink, LmicSim::Downlink_t &downlink)
+    {
+    if (node.nHistory < kAdrHistory)
+        return;
+
+    double const snrMax = *std::max_element(node.snrHistory, node.snrHistory + kAdrHistory);
+    double const margin = snrMax - getSnrFloor(getSf(uplink.rps)) - kAdrInstallMargin;
+    int nStep = int(std::floor(margin / 3.0));
+    int dr = uplink.dr;
+    int txpow = uplink.txpow;
+
+    for (; nStep > 0; --nStep)
+        {
+        if (dr < this->m_maxAdrDr)
+            ++dr;
+        else if (txpow - 2 >= kAdrMinTxPow)
+            txpow -= 2;
+        else
+            break;
+        }
+
+    for (; nStep < 0 && txpow + 2 <= node.maxTxPow; ++nStep)
+        txpow += 2;
+
+    if (dr != uplink.dr || txpow != uplink.txpow)
+        {
+        downlink.fLinkAdrReq = true;
+        downlink.adrDr = dr_t(dr);
+        downlink.adrTxPow = s1_t(txpow);
+
+        // judge the new setting on new uplinks.
+        node.nHistory = 0;
+        }
+    }
+
+///
+/// \brief find a window for the downlink, if the gateway is free and
+///     within its duty cycle.
+///
+bool Cell_t::scheduleDownlink(const LmicSim::Uplink_t &uplink, LmicSim::Downlink_t &downlink)
+    {
+    auto const now = LmicSim::getTicks();
+
+    for (u1_t window = 1; window <= 2; ++window)
+        {
+        downlink.rxWindow = window;
+
+        std::int64_t const tStart = now + (window == 1 ? 0 : OSTICKS_PER_SEC);
+        std::int64_t const tEnd = tStart + LmicSim::getDownlinkAirtime(uplink, downlink);
+        bool fBusy = false;
+
+        for (auto const &tx : this->m_gatewayTx)
+            fBusy = fBusy || overlaps(tStart, tEnd, tx.tStart, tx.tEnd);
+
+        if (fBusy)
+            continue;
+
+#if CFG_LMIC_EU_like
+        auto &avail = window == 1 ? this->m_rx1Avail : this->m_rx2Avail;
+
+        if (tStart < avail)
+            continue;
+
+        avail = tStart + (tEnd - tStart) * (window == 1 ? kRx1DutyCap : kRx2DutyCap);
+#endif
+
+        this->m_gatewayTx.push_back(GatewayTx_t { tStart, tEnd });
+        ++this->m_stats.nDownlinks;
+        return true;
+        }
+
+    ++this->m_stats.nDownlinksDropped;
+    return false;
+    }
+
+} // namespace
+
+/****************************************************************************\
+|
+|	The public interface
+|
+\****************************************************************************/
+
+CellStats_t runCell(const Config_t &config, unsigned iCell)
+    {
+    Cell_t cell(config, iCell);
+
+    return cell.run();
+    }
+
+double getEnergy(const Config_t &config, const CellStats_t &cell, const NodeStats_t &node)
+    {
+    double const sleepSeconds = std::max(0.0, cell.simSeconds - node.airtime - node.rxTime);
+
+    return config.volts * (node.charge + config.sleepMicroamps / 1000.0 * sleepSeconds);
+    }
+
+} // namespace NetSim
@@ -0,0 +1,152 @@
+/*
+
+Module:	arduino_core.cpp
+
+Function:
+	The Arduino core functions for host-native builds.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino.h>
+#include <lmic_sim.h>
+
+#include <chrono>
+
+/****************************************************************************\
+|
+|	Time: the simulated clock
+|
+\****************************************************************************/
+
+std::uint32_t millis(void)
+        {
+        return std::uint32_t(LmicSim::getTicks() * US_PER_OSTICK / 1000);
+        }
+
+std::uint32_t micros(void)
+        {
+        return std::uint32_t(LmicSim::getTicks() * US_PER_OSTICK);
+        }
+
+void delay(std::uint32_t ms)
+        {
+        LmicSim::advance(us2osticksCeil(std::int64_t(ms) * 1000));
+        }
+
+void yield(void)
+        {
+        }
+
+std::uint32_t hostNanos(void)
+        {
+        return std::uint32_t(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()
+                        ).count()
+                );
+        }
+
+/****************************************************************************\
+|
+|	Serial
+|
+\****************************************************************************/
+
+HostSerial_t Serial;
+
+std::size_t HostSerial_t::write(std::uint8_t c)
+        {
+        if (this->m_pFile == nullptr)
+                return 1;
+
+        return std::fputc(c, this->m_pFile) == EOF ? 0 : 1;
+        }
+
+std::size_t HostSerial_t::write(const std::uint8_t *pBuf, std::size_t nBuf)
+        {
+        if (this->m_pFile == nullptr)
+                return nBuf;
+
+        return std::fwrite(pBuf, 1, nBuf, this->m_pFile);
+        }
+
+void HostSerial_t::flush(void)
+        {
+        if (this->m_pFile != nullptr)
+                std::fflush(this->m_pFile);
+        }
+
+std::size_t HostSerial_t::print(const char *s)
+        {
+        return this->write(reinterpret_cast<const std::uint8_t *>(s), std::strlen(s));
+        }
+
+std::size_t HostSerial_t::print(char c)
+        {
+        return this->write(std::uint8_t(c));
+        }
+
+// as Print::printNumber() in the Arduino core.
+static std::size_t printNumber(HostSerial_t &serial, unsigned long long v, int base)
+        {
+        char buf[8 * sizeof(v) + 1];
+        char *p = &buf[sizeof(buf) - 1];
+
+        if (base < 2)
+                base = 10;
+
+        *p = '\0';
+        do      {
+                auto const digit = unsigned(v % unsigned(base));
+
+                v /= unsigned(base);
+                *--p = char(digit < 10 ? '0' + digit : 'A' + digit - 10);
+                } while (v != 0);
+
+        return serial.print(p);
+        }
+
+std::size_t HostSerial_t::print(long long v, int base)
+        {
+        // like the Arduino core, only base 10 prints a sign.
+        if (base == 10 && v < 0)
+                return this->print('-') + printNumber(*this, 0ull - (unsigned long long) v, 10);
+
+        return printNumber(*this, base == 10 ? (unsigned long long) v
+                                             : (unsigned long) v, base);
+        }
+
+std::size_t HostSerial_t::print(unsigned long long v, int base)
+        {
+        return printNumber(*this, v, base);
+        }
+
+std::size_t HostSerial_t::print(long v, int base)
+        {
+        return this->print((long long) v, base);
+        }
+
+std::size_t HostSerial_t::print(unsigned long v, int base)
+        {
+        return printNumber(*this, v, base);
+        }
+
+std::size_t HostSerial_t::print(double v, int digits)
+        {
+        char buf[64];
+
+        std::snprintf(buf, sizeof(buf), "%.*f", digits, v);
+        return this->print(buf);
+        }
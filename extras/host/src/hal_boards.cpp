@@ -0,0 +1,47 @@
+/*
+
+Module:	hal_boards.cpp
+
+Function:
+	The pin-map of the simulated board.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <arduino_lmic_hal_boards.h>
+
+namespace Arduino_LMIC {
+
+static const HalPinmap_t kPinmap =
+        {
+        HalPinmap_t::LMIC_UNUSED_PIN,
+        HalPinmap_t::LMIC_UNUSED_PIN,
+        HalPinmap_t::LMIC_UNUSED_PIN,
+                {
+                HalPinmap_t::LMIC_UNUSED_PIN,
+                HalPinmap_t::LMIC_UNUSED_PIN,
+                HalPinmap_t::LMIC_UNUSED_PIN,
+                },
+        0,
+        0,
+        8000000,
+        nullptr
+        };
+
+const HalPinmap_t *GetPinmap_ThisBoard(void)
+        {
+        return &kPinmap;
+        }
+
+} // namespace Arduino_LMIC
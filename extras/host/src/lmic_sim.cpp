@@ -0,0 +1,1141 @@
+/*
+
+Module:	lmic_sim.cpp
+
+Function:
+	The simulated LMIC: virtual clock, job queue, and MAC model.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <lmic_sim.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/****************************************************************************\
+|
+|	The simulation state
+|
+\****************************************************************************/
+
+namespace LmicSim {
+
+struct DeviceAccess
+        {
+        static osjob_t *&jobs(Device_t &d) { return d.m_pJobs; }
+        static Uplink_t &uplink(Device_t &d) { return d.m_uplink; }
+        static Downlink_t &downlink(Device_t &d) { return d.m_downlink; }
+        static unsigned &channel(Device_t &d) { return d.m_iChannel; }
+        static std::uint32_t &rng(Device_t &d) { return d.m_rng; }
+        };
+
+namespace {
+
+std::atomic<std::uint32_t> s_nextId { 1 };
+
+// the simulation state of this thread.
+thread_local std::int64_t s_ticks;
+thread_local Network_t s_defaultNetwork;
+thread_local Network_t *s_pNetwork;
+thread_local Device_t *s_pDevice;
+
+/// \brief the selected device; the first use in a thread selects a default.
+Device_t &current()
+        {
+        if (s_pDevice == nullptr)
+                {
+                static thread_local Device_t s_defaultDevice;
+
+                select(s_defaultDevice);
+                }
+
+        return *s_pDevice;
+        }
+
+/// \brief the network of this thread.
+Network_t &network()
+        {
+        return s_pNetwork != nullptr ? *s_pNetwork : s_defaultNetwork;
+        }
+
+} // namespace
+
+Device_t::Device_t()
+        : Device_t(s_nextId++)
+        {
+        }
+
+Device_t::Device_t(std::uint32_t id)
+        : lmic()
+        , id(id)
+        {
+        // xorshift32 needs a non-zero seed.
+        this->m_rng = 0x9E3779B9u * this->id;
+        if (this->m_rng == 0)
+                this->m_rng = 1;
+        }
+
+void select(Device_t &device)
+        {
+        s_pDevice = &device;
+        LmicSim_pLMIC = &device.lmic;
+        }
+
+Device_t &getDevice()
+        {
+        return current();
+        }
+
+void setNetwork(Network_t *pNetwork)
+        {
+        s_pNetwork = pNetwork;
+        }
+
+std::int64_t getTicks()
+        {
+        return s_ticks;
+        }
+
+void setTicks(std::int64_t ticks)
+        {
+        s_ticks = ticks;
+        }
+
+void advance(std::int64_t ticks)
+        {
+        if (ticks > 0)
+                s_ticks += ticks;
+        }
+
+// ostime_t wraps; this is the (signed) time from now until t.
+static std::int32_t ticksUntil(ostime_t t)
+        {
+        return std::int32_t(std::uint32_t(t) - std::uint32_t(s_ticks));
+        }
+
+bool getNextDeadline(std::int64_t &ticks)
+        {
+        auto const pJob = DeviceAccess::jobs(current());
+
+        if (pJob == nullptr)
+                return false;
+
+        ticks = s_ticks + ticksUntil(pJob->deadline);
+        return true;
+        }
+
+void Network_t::uplink(Device_t &device, const Uplink_t &uplink, Downlink_t &downlink)
+        {
+        (void) device;
+
+        downlink.fHeard = true;
+        if (uplink.fJoin || uplink.fConfirmed || uplink.fAdrAckReq)
+                {
+                downlink.fSend = true;
+                downlink.rxWindow = 1;
+                downlink.fAck = uplink.fConfirmed;
+                }
+        }
+
+/****************************************************************************\
+|
+|	Time on air (as calcAirTime() in the LMIC's lmic.c)
+|
+\****************************************************************************/
+
+ostime_t getAirtime(rps_t rps, unsigned nPhyPayload)
+        {
+        sf_t const sf = getSf(rps);
+
+        if (sf == FSK)
+                {
+                // 50 kbps; preamble 5, sync word 3, length 1, CRC 2.
+                return ostime_t(
+                        std::int64_t(nPhyPayload + 5 + 3 + 1 + 2) * 8 * OSTICKS_PER_SEC / 50000
+                        );
+                }
+
+        int const sfBits = 7 + (sf - SF7);
+        long const bwHz = 125000L << getBw(rps);
+        bool const fLowDataRate = sfBits >= 11 && getBw(rps) == BW125;
+
+        int nPayloadSyms = 8;
+        int const num = 8 * int(nPhyPayload) - 4 * sfBits + 28 +
+                        (getNocrc(rps) ? 0 : 16) - (getIh(rps) ? 20 : 0);
+
+        if (num > 0)
+                {
+                int const den = 4 * (sfBits - (fLowDataRate ? 2 : 0));
+
+                nPayloadSyms += (num + den - 1) / den * (getCr(rps) + 5);
+                }
+
+        // 4 * (preamble of 8 + 4.25, plus payload); then 2^sf / bw per symbol.
+        std::int64_t const quarterSyms = 49 + 4 * std::int64_t(nPayloadSyms);
+
+        return ostime_t(
+                ((quarterSyms << sfBits) * OSTICKS_PER_SEC + 2 * bwHz) / (4 * bwHz)
+                );
+        }
+
+} // namespace LmicSim
+
+using namespace LmicSim;
+
+__thread lmic_t *LmicSim_pLMIC;
+
+/****************************************************************************\
+|
+|	The job queue (oslmic.c)
+|
+\****************************************************************************/
+
+static void unlinkJob(osjob_t *pJob)
+        {
+        for (osjob_t **ppJob = &DeviceAccess::jobs(current());
+             *ppJob != nullptr;
+             ppJob = &(*ppJob)->next)
+                {
+                if (*ppJob == pJob)
+                        {
+                        *ppJob = pJob->next;
+                        return;
+                        }
+                }
+        }
+
+void os_setTimedCallback(osjob_t *job, ostime_t time, osjobcb_t cb)
+        {
+        unlinkJob(job);
+
+        job->deadline = time;
+        job->func = cb;
+
+        // after every job that's due no later; jobs due at the same time run
+        // in the order they were scheduled.
+        osjob_t **ppJob = &DeviceAccess::jobs(current());
+        while (*ppJob != nullptr &&
+               std::int32_t(std::uint32_t((*ppJob)->deadline) - std::uint32_t(time)) <= 0)
+                ppJob = &(*ppJob)->next;
+
+        job->next = *ppJob;
+        *ppJob = job;
+        }
+
+void os_setCallback(osjob_t *job, osjobcb_t cb)
+        {
+        os_setTimedCallback(job, os_getTime(), cb);
+        }
+
+void os_clearCallback(osjob_t *job)
+        {
+        unlinkJob(job);
+        }
+
+void os_runloop_once(void)
+        {
+        osjob_t * const pJob = DeviceAccess::jobs(current());
+
+        if (pJob != nullptr && ticksUntil(pJob->deadline) <= 0)
+                {
+                DeviceAccess::jobs(current()) = pJob->next;
+                pJob->next = nullptr;
+                pJob->func(pJob);
+                }
+        }
+
+ostime_t os_getTime(void)
+        {
+        return ostime_t(std::uint32_t(s_ticks));
+        }
+
+bit_t os_queryTimeCriticalJobs(ostime_t time)
+        {
+        auto const pJob = DeviceAccess::jobs(current());
+
+        return pJob != nullptr && ticksUntil(pJob->deadline) < time;
+        }
+
+int os_init_ex(const void *pPinmap)
+        {
+        (void) pPinmap;
+
+        // also makes sure LMIC refers to something.
+        DeviceAccess::jobs(current()) = nullptr;
+        LMIC = lmic_t();
+        LMIC.opmode = OP_SHUTDOWN;
+        return 1;
+        }
+
+void os_init(void)
+        {
+        (void) os_init_ex(nullptr);
+        }
+
+void hal_failed(const char *file, u2_t line)
+        {
+        std::fflush(stdout);
+        std::fprintf(stderr, "%s:%u: LMIC assertion failed\n", file, unsigned(line));
+        std::abort();
+        }
+
+/****************************************************************************\
+|
+|	Regional parameters
+|
+\****************************************************************************/
+
+namespace {
+
+#if CFG_region == LMIC_REGION_eu868
+constexpr u4_t kDefaultChannels[] = { 868100000, 868300000, 868500000 };
+constexpr u4_t kRx2Freq = 869525000;
+#elif CFG_region == LMIC_REGION_as923
+constexpr u4_t kDefaultChannels[] = { 923200000, 923400000 };
+constexpr u4_t kRx2Freq = 923200000;
+#elif CFG_region == LMIC_REGION_kr920
+constexpr u4_t kDefaultChannels[] = { 922100000, 922300000, 922500000 };
+constexpr u4_t kRx2Freq = 921900000;
+#elif CFG_region == LMIC_REGION_in866
+constexpr u4_t kDefaultChannels[] = { 865062500, 865402500, 865985000 };
+constexpr u4_t kRx2Freq = 866550000;
+#elif CFG_region == LMIC_REGION_us915
+constexpr u4_t kBase125kHz = 902300000;
+constexpr u4_t kBase500kHz = 903000000;
+constexpr u4_t kRx2Freq = 923300000;
+#elif CFG_region == LMIC_REGION_au915
+constexpr u4_t kBase125kHz = 915200000;
+constexpr u4_t kBase500kHz = 915900000;
+constexpr u4_t kRx2Freq = 923300000;
+#endif
+
+#if CFG_LMIC_EU_like
+constexpr dr_t kDefaultDr = DR_SF7;
+constexpr dr_t kRx2Dr = DR_SF12;
+constexpr s1_t kDefaultTxPow = 14;
+#elif CFG_region == LMIC_REGION_us915
+constexpr dr_t kDefaultDr = DR_SF7;
+constexpr dr_t kRx2Dr = US915_DR_SF12CR;
+constexpr s1_t kDefaultTxPow = 21;
+#elif CFG_region == LMIC_REGION_au915
+constexpr dr_t kDefaultDr = DR_SF7;
+constexpr dr_t kRx2Dr = AU915_DR_SF12CR;
+constexpr s1_t kDefaultTxPow = 21;
+#endif
+
+constexpr s2_t kKeepTxPow = -128;
+
+// confirmed uplinks: attempts, and when to lower the data rate (lmic.c).
+constexpr u1_t kConfirmedAttempts = 8;
+constexpr u1_t kDrAdjust[kConfirmedAttempts + 1] = { 0, 0, 1, 0, 1, 0, 1, 0, 0 };
+constexpr int kRetryPeriodSecs = 3;
+
+} // namespace
+
+rps_t LmicSim::getRpsForDr(dr_t dr)
+        {
+#if CFG_LMIC_EU_like
+        if (dr <= 5)
+                return makeRps(sf_t(SF12 - dr), BW125, CR_4_5, 0, 0);
+        else if (dr == 6)
+                return makeRps(SF7, BW250, CR_4_5, 0, 0);
+        else
+                return makeRps(FSK, BW125, CR_4_5, 0, 0);
+#else
+# if CFG_region == LMIC_REGION_us915
+        if (dr <= 3)
+                return makeRps(sf_t(SF10 - dr), BW125, CR_4_5, 0, 0);
+        else if (dr == 4)
+# else
+        if (dr <= 5)
+                return makeRps(sf_t(SF12 - dr), BW125, CR_4_5, 0, 0);
+        else if (dr == 6)
+# endif
+                return makeRps(SF8, BW500, CR_4_5, 0, 0);
+        else
+                return makeRps(sf_t(SF12 - std::min(dr - 8, 5)), BW500, CR_4_5, 0, 0);
+#endif
+        }
+
+namespace {
+
+/// \brief the data rate of the first receive window.
+dr_t getRx1Dr(dr_t dr)
+        {
+#if CFG_LMIC_EU_like
+        return dr_t(std::max(int(dr) - int(LMIC.rx1DrOffset), 0));
+#elif CFG_region == LMIC_REGION_us915
+        return dr_t(std::max(std::min(10 + int(dr), 13) - int(LMIC.rx1DrOffset), 8));
+#else
+        return dr_t(std::max(std::min(8 + int(dr), 13) - int(LMIC.rx1DrOffset), 8));
+#endif
+        }
+
+/// \brief the symbol time, in ticks.
+ostime_t getSymbolTime(rps_t rps)
+        {
+        return ostime_t((std::int64_t(OSTICKS_PER_SEC) << (7 + getSf(rps) - SF7)) /
+                        (125000L << getBw(rps)));
+        }
+
+/// \brief the next lower data rate, as lowerDR() in lmic.c.
+dr_t getLowerDr(dr_t dr, u1_t n)
+        {
+        return dr_t(std::max(int(dr) - int(n), 0));
+        }
+
+/// \brief a random number of ticks in [0, range), from the selected device.
+ostime_t getRandomTicks(ostime_t range)
+        {
+        auto &x = DeviceAccess::rng(current());
+
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return range <= 0 ? 0 : ostime_t(x % std::uint32_t(range));
+        }
+
+#if CFG_LMIC_EU_like
+void initDefaultChannels()
+        {
+        unsigned i = 0;
+
+        for (auto freq : kDefaultChannels)
+                {
+                LMIC.channelFreq[i] = freq;
+                LMIC.channelDrMap[i] = u2_t((1u << (DR_SF7 + 1)) - 1);
+                ++i;
+                }
+
+        LMIC.channelMap = u2_t((1u << i) - 1);
+
+        for (auto &band : LMIC.bands)
+                {
+                band.txcap = 100;
+                band.txpow = kDefaultTxPow;
+                band.avail = os_getTime();
+                }
+        }
+#else
+void countActiveChannels()
+        {
+        LMIC.activeChannels125khz = 0;
+        LMIC.activeChannels500khz = 0;
+
+        for (unsigned chnl = 0; chnl < 72; ++chnl)
+                {
+                if (ENABLED_CHANNEL(chnl))
+                        {
+                        if (chnl < 64)
+                                ++LMIC.activeChannels125khz;
+                        else
+                                ++LMIC.activeChannels500khz;
+                        }
+                }
+        }
+#endif
+
+/****************************************************************************\
+|
+|	The MAC model
+|
+\****************************************************************************/
+
+void runEngine(osjob_t *pJob);
+
+/// \brief report an event, as reportEventNoUpdate() in lmic.c.
+void reportEvent(ev_t ev)
+        {
+        onEvent(ev);
+
+        if (LMIC.client.eventCb != nullptr)
+                LMIC.client.eventCb(LMIC.client.eventUserData, ev);
+
+        if (ev == EV_TXCOMPLETE || ev == EV_TXCANCELED || ev == EV_JOIN_FAILED)
+                {
+                auto const pTxMessageCb = LMIC.client.txMessageCb;
+
+                if (pTxMessageCb != nullptr)
+                        {
+                        LMIC.client.txMessageCb = nullptr;
+                        pTxMessageCb(
+                                LMIC.client.txMessageUserData,
+                                ev == EV_TXCOMPLETE && (LMIC.txrxFlags & TXRX_NACK) == 0
+                                );
+                        }
+                }
+        }
+
+#if CFG_LMIC_EU_like
+/// \brief how long until a band (or the global duty cycle) allows a transmission.
+std::int32_t getDutyWait(ostime_t avail)
+        {
+        auto const wait = ticksUntil(avail);
+
+        // ostime_t wraps every 9.5 hours, so an old \p avail can look like
+        // one far in the future; real waits are much shorter than this.
+        if (wait <= 0 || wait > (std::int32_t(1) << 30))
+                return 0;
+
+        return wait;
+        }
+
+/// \brief bring a past availability time up to now, so that it can't age
+///     enough to wrap and look like one in the future.
+void refreshDutyAvail(ostime_t &avail)
+        {
+        if (getDutyWait(avail) == 0)
+                avail = os_getTime();
+        }
+#endif
+
+/// \brief choose the channel for the next uplink, and say when it can start.
+ostime_t chooseChannel()
+        {
+        Device_t &device = getDevice();
+        unsigned &iChannel = DeviceAccess::channel(device);
+        ostime_t tTx = os_getTime();
+
+#if CFG_LMIC_EU_like
+        // the enabled channel (for this data rate) whose band is free first;
+        // ties go round-robin.
+        int iBest = -1;
+        std::int32_t bestWait = 0;
+
+        for (auto &band : LMIC.bands)
+                refreshDutyAvail(band.avail);
+        refreshDutyAvail(LMIC.globalDutyAvail);
+
+        for (unsigned n = 0; n < MAX_CHANNELS; ++n)
+                {
+                unsigned const chnl = (iChannel + 1 + n) % MAX_CHANNELS;
+
+                if ((LMIC.channelMap & (1u << chnl)) == 0 ||
+                    (LMIC.channelDrMap[chnl] & (1u << LMIC.datarate)) == 0)
+                        continue;
+
+                auto const &band = LMIC.bands[LMIC.channelFreq[chnl] & 0x3];
+                auto const wait = getDutyWait(band.avail);
+
+                if (iBest < 0 || wait < bestWait)
+                        {
+                        iBest = int(chnl);
+                        bestWait = wait;
+                        }
+                }
+
+        ASSERT(iBest >= 0);
+        iChannel = unsigned(iBest);
+        LMIC.txChnl = u1_t(iChannel);
+        LMIC.freq = LMIC.channelFreq[iChannel] & ~u4_t(0x3);
+        tTx += std::max(bestWait, getDutyWait(LMIC.globalDutyAvail));
+#else
+        // 500 kHz channels for the 500 kHz data rate, otherwise 125 kHz.
+        bool const f500 = getBw(getRpsForDr(LMIC.datarate)) == BW500;
+        unsigned const first = f500 ? 64 : 0;
+        unsigned const count = f500 ? 8 : 64;
+
+        for (unsigned n = 0; n < count; ++n)
+                {
+                unsigned const chnl = first + (iChannel + 1 + n) % count;
+
+                if (ENABLED_CHANNEL(chnl))
+                        {
+                        iChannel = chnl - first;
+                        LMIC.txChnl = u1_t(chnl);
+                        LMIC.freq = f500 ? kBase500kHz + 1600000 * (chnl - 64)
+                                         : kBase125kHz + 200000 * chnl;
+                        break;
+                        }
+                }
+#endif
+
+        return tTx;
+        }
+
+/// \brief the end of the receive windows.
+void runRxDone(osjob_t *pJob)
+        {
+        (void) pJob;
+
+        Device_t &device = getDevice();
+        Uplink_t const &uplink = DeviceAccess::uplink(device);
+        Downlink_t const &downlink = DeviceAccess::downlink(device);
+        bool const fDownlink = downlink.fHeard && downlink.fSend;
+
+        LMIC.opmode &= ~OP_TXRXPEND;
+
+        if (uplink.fJoin)
+                {
+                if (fDownlink)
+                        {
+                        LMIC.netid = 0x13;
+                        LMIC.devaddr = 0x26000000u | (device.id & 0x01FFFFFFu);
+                        std::memset(LMIC.nwkKey, 0x11, sizeof(LMIC.nwkKey));
+                        std::memset(LMIC.artKey, 0x22, sizeof(LMIC.artKey));
+                        std::memcpy(LMIC.nwkKey, &device.id, sizeof(device.id));
+                        std::memcpy(LMIC.artKey, &device.id, sizeof(device.id));
+                        LMIC.seqnoUp = 0;
+                        LMIC.seqnoDn = 0;
+                        LMIC.opmode &= ~(OP_JOINING | OP_REJOIN);
+                        LMIC.opmode |= OP_NEXTCHNL;
+                        if (LMIC.adrAckReq != LINK_CHECK_OFF)
+                                LMIC.adrAckReq = LINK_CHECK_INIT;
+
+                        reportEvent(EV_JOINED);
+
+                        if (LMIC.opmode & OP_TXDATA)
+                                os_setCallback(&LMIC.osjob, runEngine);
+                        }
+                else
+                        {
+                        // no join accept: back off, and try again.
+                        if (LMIC.joinAttempts < 0xFF)
+                                ++LMIC.joinAttempts;
+
+                        // every second attempt, lower the data rate; after
+                        // the lowest, start again from the default.
+                        if ((LMIC.joinAttempts & 1) == 0)
+                                {
+                                LMIC.datarate = LMIC.datarate == 0
+                                                        ? kDefaultDr
+                                                        : getLowerDr(LMIC.datarate, 1);
+                                LMIC.rps = getRpsForDr(LMIC.datarate);
+                                }
+
+                        reportEvent(EV_JOIN_TXCOMPLETE);
+                        os_setTimedCallback(
+                                &LMIC.osjob,
+                                os_getTime() +
+                                    sec2osticks(6 * std::min<unsigned>(LMIC.joinAttempts, 10)) +
+                                    getRandomTicks(sec2osticks(kRetryPeriodSecs)),
+                                runEngine
+                                );
+                        }
+                return;
+                }
+
+        LMIC.txrxFlags = 0;
+        LMIC.dataBeg = 0;
+        LMIC.dataLen = 0;
+
+        if (fDownlink)
+                {
+                ++LMIC.seqnoDn;
+                LMIC.txrxFlags = downlink.rxWindow == 1 ? TXRX_DNW1 : TXRX_DNW2;
+
+                if (downlink.fAck)
+                        LMIC.txrxFlags |= TXRX_ACK;
+                else if (uplink.fConfirmed)
+                        LMIC.txrxFlags |= TXRX_NACK;
+
+                if (downlink.port != 0)
+                        {
+                        // MHDR, FHDR and FPort come first.
+                        LMIC.txrxFlags |= TXRX_PORT;
+                        LMIC.dataBeg = 9;
+                        LMIC.dataLen = downlink.nData;
+                        LMIC.frame[LMIC.dataBeg - 1] = downlink.port;
+                        std::memcpy(LMIC.frame + LMIC.dataBeg, downlink.data, downlink.nData);
+                        }
+                else
+                        LMIC.txrxFlags |= TXRX_NOPORT;
+
+                if (downlink.fLinkAdrReq && LMIC.adrEnabled)
+                        {
+                        LMIC.datarate = downlink.adrDr;
+                        LMIC.adrTxPow = downlink.adrTxPow;
+                        if (downlink.adrNbTrans != 0)
+                                LMIC.upRepeat = u1_t(downlink.adrNbTrans - 1);
+                        }
+
+                if (LMIC.adrAckReq != LINK_CHECK_OFF)
+                        LMIC.adrAckReq = LINK_CHECK_INIT;
+
+                if (LMIC.opmode & OP_LINKDEAD)
+                        {
+                        LMIC.opmode &= ~OP_LINKDEAD;
+                        reportEvent(EV_LINK_ALIVE);
+                        }
+                }
+        else
+                {
+                if (uplink.fConfirmed)
+                        LMIC.txrxFlags = TXRX_NACK;
+
+                // no answer to ADRACKReq: lower the data rate, and keep asking.
+                if (LMIC.adrAckReq >= LINK_CHECK_DEAD)
+                        {
+                        if (LMIC.adrEnabled)
+                                LMIC.datarate = getLowerDr(LMIC.datarate, 1);
+                        LMIC.adrAckReq = LINK_CHECK_CONT;
+                        if ((LMIC.opmode & OP_LINKDEAD) == 0)
+                                {
+                                LMIC.opmode |= OP_LINKDEAD;
+                                reportEvent(EV_LINK_DEAD);
+                                }
+                        }
+                }
+
+        // send the same frame again?
+        bool fRepeat = false;
+
+        if (uplink.fConfirmed)
+                {
+                if ((LMIC.txrxFlags & TXRX_ACK) == 0 && LMIC.txCnt + 1 < kConfirmedAttempts)
+                        {
+                        ++LMIC.txCnt;
+                        LMIC.datarate = getLowerDr(LMIC.datarate, kDrAdjust[LMIC.txCnt]);
+                        fRepeat = true;
+                        }
+                }
+        else if (! fDownlink && LMIC.txCnt < LMIC.upRepeat)
+                {
+                ++LMIC.txCnt;
+                fRepeat = true;
+                }
+
+        if (fRepeat)
+                {
+                os_setTimedCallback(
+                        &LMIC.osjob,
+                        os_getTime() + getRandomTicks(sec2osticks(kRetryPeriodSecs)),
+                        runEngine
+                        );
+                return;
+                }
+
+        ++LMIC.seqnoUp;
+        LMIC.txCnt = 0;
+        LMIC.pendTxLen = 0;
+        LMIC.opmode &= ~(OP_TXDATA | OP_POLL);
+
+        reportEvent(EV_TXCOMPLETE);
+
+        if (LMIC.opmode & OP_TXDATA)
+                os_setCallback(&LMIC.osjob, runEngine);
+        }
+
+/// \brief receive the downlink, if any, in a window.
+void receive(u1_t window, dr_t dr, u4_t freq)
+        {
+        Downlink_t const &downlink = DeviceAccess::downlink(getDevice());
+        rps_t const rps = getRpsForDr(dr);
+
+        (void) freq;
+        LMIC.rps = rps;
+        LMIC.rxsyms = 8;
+        reportEvent(EV_RXSTART);
+
+        if (downlink.fHeard && downlink.fSend && downlink.rxWindow == window)
+                {
+                ostime_t const tRx = getDownlinkAirtime(DeviceAccess::uplink(current()), downlink);
+
+                current().tRxOpen += tRx;
+                os_setTimedCallback(&LMIC.osjob, os_getTime() + tRx, runRxDone);
+                }
+        else if (window == 1)
+                {
+                ostime_t const tRx2 = LMIC.txend +
+                        sec2osticks((DeviceAccess::uplink(current()).fJoin ? 5 : LMIC.rxDelay) + 1);
+
+                current().tRxOpen += LMIC.rxsyms * getSymbolTime(rps);
+
+                os_setTimedCallback(&LMIC.osjob, tRx2, [](osjob_t *) {
+                        receive(2, LMIC.dn2Dr, LMIC.dn2Freq);
+                        });
+                }
+        else
+                {
+                ostime_t const tRx = LMIC.rxsyms * getSymbolTime(rps);
+
+                current().tRxOpen += tRx;
+                os_setTimedCallback(&LMIC.osjob, os_getTime() + tRx, runRxDone);
+                }
+        }
+
+/// \brief the first receive window: the network decides what happened.
+void runRx1(osjob_t *pJob)
+        {
+        (void) pJob;
+
+        Device_t &device = getDevice();
+        Uplink_t const &uplink = DeviceAccess::uplink(device);
+        Downlink_t &downlink = DeviceAccess::downlink(device);
+
+        downlink = Downlink_t();
+        network().uplink(device, uplink, downlink);
+
+        receive(1, getRx1Dr(uplink.dr), uplink.freq);
+        }
+
+/// \brief start an uplink now.
+void startTx()
+        {
+        Device_t &device = getDevice();
+        Uplink_t &uplink = DeviceAccess::uplink(device);
+        bool const fJoin = (LMIC.opmode & OP_JOINING) != 0;
+
+        uplink = Uplink_t();
+        uplink.fJoin = fJoin;
+        if (! fJoin)
+                {
+                uplink.fConfirmed = LMIC.pendTxConf != 0;
+                uplink.port = LMIC.pendTxPort;
+                uplink.nData = LMIC.pendTxLen;
+                uplink.pData = LMIC.pendTxData;
+                uplink.devaddr = LMIC.devaddr;
+                uplink.seqno = LMIC.seqnoUp;
+                uplink.txCnt = LMIC.txCnt;
+                uplink.fAdr = LMIC.adrEnabled != 0;
+
+                if (LMIC.txCnt == 0 && LMIC.adrAckReq != LINK_CHECK_OFF)
+                        ++LMIC.adrAckReq;
+                uplink.fAdrAckReq = uplink.fAdr && LMIC.adrAckReq >= LINK_CHECK_CONT;
+                }
+
+        LMIC.rps = getRpsForDr(LMIC.datarate);
+        LMIC.txpow = LMIC.adrTxPow;     // the LMIC's updateTx() does this.
+        uplink.freq = LMIC.freq;
+        uplink.rps = LMIC.rps;
+        uplink.dr = LMIC.datarate;
+        uplink.txChnl = LMIC.txChnl;
+        uplink.txpow = LMIC.adrTxPow;
+
+        // the LMIC has built the frame by now; FOpts aren't simulated.
+        LMIC.dataLen = u1_t(fJoin ? 23
+                                  : 12 + (LMIC.pendTxLen != 0 ? LMIC.pendTxLen + 1 : 0));
+
+        reportEvent(EV_TXSTART);
+
+        // the MAC ignores changes until the receive windows are done.
+        LMIC.opmode |= OP_TXRXPEND;
+        LMIC.opmode &= ~OP_NEXTCHNL;
+
+        ostime_t const tStart = os_getTime();
+        ostime_t const airtime = getAirtime(LMIC.rps, fJoin ? 23 : 13 + uplink.nData);
+
+        LMIC.txend = tStart + airtime;
+        uplink.tStart = getTicks();
+        uplink.tEnd = uplink.tStart + airtime;
+        ++device.nUplinks;
+        if (fJoin)
+                ++device.nJoinRequests;
+        device.tAirtime += airtime;
+
+#if CFG_LMIC_EU_like
+        auto &band = LMIC.bands[LMIC.channelFreq[LMIC.txChnl] & 0x3];
+        band.avail = tStart + airtime * band.txcap;
+        band.lastchnl = LMIC.txChnl;
+        if (LMIC.globalDutyRate != 0)
+                LMIC.globalDutyAvail = tStart + (airtime << LMIC.globalDutyRate);
+#endif
+
+        network().transmit(device, uplink);
+
+        os_setTimedCallback(
+                &LMIC.osjob,
+                LMIC.txend + sec2osticks(fJoin ? 5 : LMIC.rxDelay),
+                runRx1
+                );
+        }
+
+/// \brief decide what to do next, as engineUpdate() in lmic.c.
+void runEngine(osjob_t *pJob)
+        {
+        (void) pJob;
+
+        if (LMIC.opmode & (OP_SHUTDOWN | OP_TXRXPEND))
+                return;
+
+        if ((LMIC.opmode & OP_JOINING) == 0 &&
+            ! ((LMIC.opmode & OP_TXDATA) && LMIC.devaddr != 0))
+                return;
+
+        ostime_t const tTx = chooseChannel();
+
+        if (ticksUntil(tTx) > 0)
+                os_setTimedCallback(&LMIC.osjob, tTx, runEngine);
+        else
+                startTx();
+        }
+
+} // namespace
+
+ostime_t LmicSim::getDownlinkAirtime(const Uplink_t &uplink, const Downlink_t &downlink)
+        {
+        dr_t const dr = downlink.rxWindow == 1 ? getRx1Dr(uplink.dr) : dr_t(LMIC.dn2Dr);
+        unsigned const nPhy = uplink.fJoin
+                ? 17
+                : 12 + (downlink.fLinkAdrReq ? 5 : 0) +
+                  (downlink.port != 0 ? 1 + downlink.nData : 0);
+
+        return getAirtime(getRpsForDr(dr), nPhy);
+        }
+
+/****************************************************************************\
+|
+|	The LMIC APIs
+|
+\****************************************************************************/
+
+void LMIC_reset(void)
+        {
+        os_clearCallback(&LMIC.osjob);
+
+        // the client registrations survive a reset.
+        auto const client = LMIC.client;
+
+        LMIC = lmic_t();
+        LMIC.client = client;
+
+        LMIC.opmode = OP_NONE;
+        LMIC.adrAckReq = LINK_CHECK_INIT;
+        LMIC.adrEnabled = 1;
+        LMIC.rxDelay = 1;
+        LMIC.dn2Dr = kRx2Dr;
+        LMIC.dn2Freq = kRx2Freq;
+        LMIC.datarate = kDefaultDr;
+        LMIC.txpow = kDefaultTxPow;
+        LMIC.adrTxPow = kDefaultTxPow;
+        LMIC.rps = getRpsForDr(kDefaultDr);
+        LMIC.globalDutyAvail = os_getTime();
+
+#if CFG_LMIC_EU_like
+        initDefaultChannels();
+#else
+        for (auto &map : LMIC.channelMap)
+                map = 0xFFFF;
+        countActiveChannels();
+#endif
+        }
+
+void LMIC_shutdown(void)
+        {
+        os_clearCallback(&LMIC.osjob);
+        LMIC.opmode |= OP_SHUTDOWN;
+        }
+
+void LMIC_startJoining(void)
+        {
+        if (LMIC.devaddr != 0 || (LMIC.opmode & (OP_JOINING | OP_SHUTDOWN)))
+                return;
+
+        LMIC.opmode |= OP_JOINING;
+        LMIC.joinAttempts = 0;
+        reportEvent(EV_JOINING);
+        os_setCallback(&LMIC.osjob, runEngine);
+        }
+
+void LMIC_tryRejoin(void)
+        {
+        // rejoins are not modeled.
+        }
+
+void LMIC_unjoin(void)
+        {
+        os_clearCallback(&LMIC.osjob);
+        LMIC.devaddr = 0;
+        LMIC.opmode &= ~(OP_JOINING | OP_REJOIN | OP_TXRXPEND | OP_LINKDEAD);
+        }
+
+void LMIC_setSession(u4_t netid, devaddr_t devaddr, xref2u1_t nwkKey, xref2u1_t artKey)
+        {
+        LMIC.netid = netid;
+        LMIC.devaddr = devaddr;
+        if (nwkKey != nullptr)
+                std::memcpy(LMIC.nwkKey, nwkKey, sizeof(LMIC.nwkKey));
+        if (artKey != nullptr)
+                std::memcpy(LMIC.artKey, artKey, sizeof(LMIC.artKey));
+
+        LMIC.seqnoUp = 0;
+        LMIC.seqnoDn = 0;
+        LMIC.opmode &= ~(OP_JOINING | OP_REJOIN | OP_TXRXPEND | OP_SHUTDOWN);
+        LMIC.opmode |= OP_NEXTCHNL;
+        }
+
+void LMIC_getSessionKeys(u4_t *netid, devaddr_t *devaddr, xref2u1_t nwkKey, xref2u1_t artKey)
+        {
+        *netid = LMIC.netid;
+        *devaddr = LMIC.devaddr;
+        std::memcpy(nwkKey, LMIC.nwkKey, sizeof(LMIC.nwkKey));
+        std::memcpy(artKey, LMIC.artKey, sizeof(LMIC.artKey));
+        }
+
+bit_t LMIC_setupChannel(u1_t channel, u4_t freq, u2_t drmap, s1_t band)
+        {
+#if CFG_LMIC_EU_like
+        if (channel >= MAX_CHANNELS)
+                return 0;
+
+        LMIC.channelFreq[channel] = (freq & ~u4_t(0x3)) | u4_t(band < 0 ? 0 : band & 0x3);
+        LMIC.channelDrMap[channel] = drmap;
+        LMIC.channelMap |= u2_t(1u << channel);
+        return 1;
+#else
+        (void) channel; (void) freq; (void) drmap; (void) band;
+        return 0;
+#endif
+        }
+
+bit_t LMIC_enableChannel(u1_t channel)
+        {
+#if CFG_LMIC_EU_like
+        if (channel >= MAX_CHANNELS)
+                return 0;
+        LMIC.channelMap |= u2_t(1u << channel);
+#else
+        if (channel >= 72)
+                return 0;
+        LMIC.channelMap[channel >> 4] |= u2_t(1u << (channel & 0xF));
+        countActiveChannels();
+#endif
+        return 1;
+        }
+
+bit_t LMIC_disableChannel(u1_t channel)
+        {
+#if CFG_LMIC_EU_like
+        if (channel >= MAX_CHANNELS)
+                return 0;
+        LMIC.channelMap &= u2_t(~(1u << channel));
+#else
+        if (channel >= 72)
+                return 0;
+        LMIC.channelMap[channel >> 4] &= u2_t(~(1u << (channel & 0xF)));
+        countActiveChannels();
+#endif
+        return 1;
+        }
+
+bit_t LMIC_selectSubBand(u1_t band)
+        {
+#if CFG_LMIC_US_like
+        if (band >= 8)
+                return 0;
+
+        for (unsigned chnl = 0; chnl < 72; ++chnl)
+                {
+                if (chnl / 8 == band || chnl == 64u + band)
+                        LMIC.channelMap[chnl >> 4] |= u2_t(1u << (chnl & 0xF));
+                else
+                        LMIC.channelMap[chnl >> 4] &= u2_t(~(1u << (chnl & 0xF)));
+                }
+        countActiveChannels();
+        return 1;
+#else
+        (void) band;
+        return 0;
+#endif
+        }
+
+void LMIC_setDrTxpow(dr_t dr, s1_t txpow)
+        {
+        if (txpow != kKeepTxPow)
+                LMIC.adrTxPow = txpow;
+
+        LMIC.datarate = dr;
+        LMIC.rps = getRpsForDr(dr);
+        }
+
+void LMIC_setAdrMode(bit_t enabled)
+        {
+        LMIC.adrEnabled = enabled ? 1 : 0;
+        }
+
+void LMIC_setLinkCheckMode(bit_t enabled)
+        {
+        LMIC.adrAckReq = enabled ? s2_t(LINK_CHECK_INIT) : s2_t(LINK_CHECK_OFF);
+        }
+
+void LMIC_setClockError(u2_t error)
+        {
+        // the simulated clock is perfect.
+        (void) error;
+        }
+
+lmic_tx_error_t LMIC_sendWithCallback(
+        u1_t port, xref2u1_t data, u1_t dlen, u1_t confirmed,
+        lmic_txmessage_cb_t *pCb, void *pUserData
+        )
+        {
+        if (LMIC.opmode & OP_SHUTDOWN)
+                return LMIC_ERROR_TX_FAILED;
+        if (LMIC.opmode & (OP_TXDATA | OP_TXRXPEND))
+                return LMIC_ERROR_TX_BUSY;
+        if (dlen > sizeof(LMIC.pendTxData))
+                return LMIC_ERROR_TX_TOO_LARGE;
+
+        LMIC.client.txMessageCb = pCb;
+        LMIC.client.txMessageUserData = pUserData;
+
+        if (data != nullptr)
+                std::memcpy(LMIC.pendTxData, data, dlen);
+        LMIC.pendTxPort = port;
+        LMIC.pendTxConf = confirmed;
+        LMIC.pendTxLen = dlen;
+        LMIC.txCnt = 0;
+        LMIC.opmode |= OP_TXDATA;
+
+        if (LMIC.devaddr == 0)
+                LMIC_startJoining();
+        else
+                os_setCallback(&LMIC.osjob, runEngine);
+
+        return LMIC_ERROR_SUCCESS;
+        }
+
+lmic_tx_error_t LMIC_setTxData2(u1_t port, xref2u1_t data, u1_t dlen, u1_t confirmed)
+        {
+        return LMIC_sendWithCallback(port, data, dlen, confirmed, nullptr, nullptr);
+        }
+
+void LMIC_clrTxData(void)
+        {
+        if ((LMIC.opmode & OP_TXDATA) == 0)
+                return;
+
+        LMIC.pendTxLen = 0;
+        LMIC.opmode &= ~(OP_TXDATA | OP_POLL);
+        if ((LMIC.opmode & OP_JOINING) == 0)
+                {
+                LMIC.opmode &= ~OP_TXRXPEND;
+                os_clearCallback(&LMIC.osjob);
+                }
+
+        reportEvent(EV_TXCANCELED);
+        }
+
+bit_t LMIC_queryTxReady(void)
+        {
+        return (LMIC.opmode & OP_TXDATA) == 0;
+        }
+
+int LMIC_registerEventCb(lmic_event_cb_t *pEventCb, void *pUserData)
+        {
+        LMIC.client.eventCb = pEventCb;
+        LMIC.client.eventUserData = pUserData;
+        return 1;
+        }
+
+int LMIC_getNetworkTimeReference(lmic_time_reference_t *pReference)
+        {
+        // DeviceTimeReq is not modeled.
+        (void) pReference;
+        return 0;
+        }
@@ -0,0 +1,58 @@
+/*
+
+Module:	mcciadk_baselib.cpp
+
+Function:
+	The parts of the MCCI ADK base library used by arduino-lorawan.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <mcciadk_baselib.h>
+
+#include <cstring>
+
+const char *
+McciAdkLib_MultiSzIndex(
+        const char *pMultiSz,
+        unsigned iString
+        )
+        {
+        for (; iString != 0 && *pMultiSz != '\0'; --iString)
+                pMultiSz += std::strlen(pMultiSz) + 1;
+
+        return pMultiSz;
+        }
+
+size_t
+McciAdkLib_SafeCopyString(
+        char *pBuffer,
+        size_t nBuffer,
+        size_t iBuffer,
+        const char *pString
+        )
+        {
+        if (pBuffer == nullptr || iBuffer >= nBuffer)
+                return 0;
+
+        size_t nCopy = pString == nullptr ? 0 : std::strlen(pString);
+
+        if (nCopy > nBuffer - iBuffer - 1)
+                nCopy = nBuffer - iBuffer - 1;
+
+        if (nCopy != 0)
+                std::memcpy(pBuffer + iBuffer, pString, nCopy);
+        pBuffer[iBuffer + nCopy] = '\0';
+        return nCopy;
+        }
@@ -0,0 +1,252 @@
+/*
+
+Module:	test_fcnt_journal.cpp
+
+Function:
+	Host test: count the session-state writes made in FCnt journal mode.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Usage:
+	test_fcnt_journal [-n count] [-j interval]
+
+	Joins with the simulated network, then sends count unconfirmed
+	uplinks (default 50) with the given journal interval (default 16;
+	0 turns journaling off). Each save, whether made with
+	NetSaveSessionState() or NetSaveSessionStateDelta(), is applied to
+	a copy of the stored state, as a flash or EEPROM client would.
+
+	With journaling, there must be no more than count / interval
+	saves, plus those made for the join. Without it, there must be a
+	save for every uplink. In both cases, the stored copy must match
+	the last state saved, and the stored FCntUp must never be below
+	the LMIC's. Exits with status 0 if all is well.
+
+*/
+
+#include <Arduino_LoRaWAN_network.h>
+#include <Arduino_LoRaWAN_lmic.h>
+#include <lmic_sim.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/****************************************************************************\
+|
+|	The device
+|
+\****************************************************************************/
+
+class cJournalLoRaWAN : public Arduino_LoRaWAN_network
+    {
+public:
+    /// \brief number of saves: one or more calls with the same state.
+    unsigned nSaves = 0;
+    /// \brief number of calls to NetSaveSessionState().
+    unsigned nFullSaves = 0;
+    /// \brief number of calls to NetSaveSessionStateDelta().
+    unsigned nDeltaSaves = 0;
+
+    /// \brief the state as stored.
+    SessionState stored {};
+    /// \brief the state most recently passed to a save.
+    SessionState last {};
+
+protected:
+    virtual bool GetOtaaProvisioningInfo(OtaaProvisioningInfo *pInfo) override
+        {
+        if (pInfo != nullptr)
+            {
+            static const uint8_t kDevEUI[8] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0xA3, 0x04, 0x00 };
+            static const uint8_t kAppEUI[8] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+            std::memset(pInfo->AppKey, 0x5A, sizeof(pInfo->AppKey));
+            std::memcpy(pInfo->DevEUI, kDevEUI, sizeof(kDevEUI));
+            std::memcpy(pInfo->AppEUI, kAppEUI, sizeof(kAppEUI));
+            }
+        return true;
+        }
+
+    virtual void NetSaveSessionState(const SessionState &State) override
+        {
+        ++this->nFullSaves;
+        this->noteSave(State);
+        this->stored = State;
+        }
+
+    virtual bool NetSaveSessionStateDelta(
+        const SessionState &State,
+        size_t offset,
+        size_t nBytes
+        ) override
+        {
+        ++this->nDeltaSaves;
+        this->noteSave(State);
+        std::memcpy(
+            reinterpret_cast<uint8_t *>(&this->stored) + offset,
+            reinterpret_cast<const uint8_t *>(&State) + offset,
+            nBytes
+            );
+        return true;
+        }
+
+private:
+    // each save has a new CRC, so a change of CRC starts a new save.
+    void noteSave(const SessionState &State)
+        {
+        if (this->nSaves == 0 || State.V2.Crc != this->last.V2.Crc)
+            ++this->nSaves;
+
+        this->last = State;
+        }
+    };
+
+static cJournalLoRaWAN myLoRaWAN;
+
+static unsigned nDone;
+
+static void sendDone(void *pCtx, bool fSuccess)
+    {
+    (void) pCtx;
+    (void) fSuccess;
+
+    ++nDone;
+    }
+
+/****************************************************************************\
+|
+|	The main program
+|
+\****************************************************************************/
+
+// saves made for the join: at EV_JOINED, and the first reservation at
+// the first EV_TXCOMPLETE.
+static constexpr unsigned kJoinSaves = 2;
+
+static bool checkStored(unsigned iUplink)
+    {
+    if (std::memcmp(&myLoRaWAN.stored, &myLoRaWAN.last, sizeof(myLoRaWAN.stored)) != 0)
+        {
+        std::printf("FAIL: uplink %u: the stored state doesn't match the last state saved\n", iUplink);
+        return false;
+        }
+
+    if (myLoRaWAN.nSaves != 0 &&
+        int32_t(myLoRaWAN.stored.V1.FCntUp - LMIC.seqnoUp) < 0)
+        {
+        std::printf("FAIL: uplink %u: stored FCntUp %lu is below LMIC.seqnoUp %lu\n",
+            iUplink,
+            (unsigned long) myLoRaWAN.stored.V1.FCntUp,
+            (unsigned long) LMIC.seqnoUp
+            );
+        return false;
+        }
+
+    return true;
+    }
+
+int main(int argc, char **argv)
+    {
+    unsigned nMessages = 50;
+    unsigned interval = 16;
+
+    for (int iArg = 1; iArg < argc; ++iArg)
+        {
+        if (std::strcmp(argv[iArg], "-n") == 0 && iArg + 1 < argc)
+            nMessages = unsigned(std::strtoul(argv[++iArg], nullptr, 0));
+        else if (std::strcmp(argv[iArg], "-j") == 0 && iArg + 1 < argc)
+            interval = unsigned(std::strtoul(argv[++iArg], nullptr, 0));
+        else
+            {
+            std::fprintf(stderr, "usage: %s [-n count] [-j interval]\n", argv[0]);
+            return 2;
+            }
+        }
+
+    myLoRaWAN.SetDebugMask(0);
+    myLoRaWAN.SetFCntJournalInterval(interval);
+
+    if (! myLoRaWAN.begin())
+        {
+        std::fprintf(stderr, "begin() failed\n");
+        return 1;
+        }
+
+    bool fOk = true;
+    unsigned nSent = 0;
+    unsigned nChecked = 0;
+
+    while (nDone < nMessages && fOk)
+        {
+        myLoRaWAN.loop();
+
+        if (nDone != nChecked)
+            {
+            nChecked = nDone;
+            fOk = checkStored(nChecked);
+            }
+
+        if (nDone >= nMessages || ! fOk)
+            break;
+
+        if (nSent == nDone && nSent < nMessages && myLoRaWAN.GetTxReady())
+            {
+            uint8_t payload[] = { uint8_t(nSent >> 8), uint8_t(nSent), 0x12, 0x34 };
+
+            if (myLoRaWAN.SendBuffer(payload, sizeof(payload), sendDone, nullptr, false))
+                ++nSent;
+            }
+
+        std::int64_t tJob;
+
+        if (! LmicSim::getNextDeadline(tJob))
+            {
+            std::printf("FAIL: stalled after %u of %u message(s)\n", nDone, nMessages);
+            return 1;
+            }
+
+        if (tJob > LmicSim::getTicks())
+            LmicSim::setTicks(tJob);
+        }
+
+    if (! fOk)
+        return 1;
+
+    auto const nSaves = myLoRaWAN.nSaves;
+
+    std::printf("%u uplink(s), journal interval %u: %u save(s) "
+                "(%u full, %u delta write(s))\n",
+        nMessages, interval, nSaves,
+        myLoRaWAN.nFullSaves, myLoRaWAN.nDeltaSaves
+        );
+
+    if (interval != 0)
+        {
+        auto const nMaxSaves = kJoinSaves + nMessages / interval;
+
+        if (nSaves > nMaxSaves)
+            {
+            std::printf("FAIL: expected at most %u save(s), got %u\n", nMaxSaves, nSaves);
+            return 1;
+            }
+        }
+    else if (nSaves < nMessages)
+        {
+        std::printf("FAIL: expected a save for each of %u uplink(s), got %u\n", nMessages, nSaves);
+        return 1;
+        }
+
+    std::printf("PASS\n");
+    return 0;
+    }
@@ -0,0 +1,342 @@
+/*
+
+Module:	test_ringstore.cpp
+
+Function:
+	Host test: cRingStore over a file-backed page device.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Usage:
+	test_ringstore [-f file] [-n count]
+
+	Runs cRingStore over a cFilePageDevice of four 512-byte pages kept
+	in the given file (default test_ringstore.bin, removed at the end):
+
+	- records of each kind are appended and read back, and are
+	  recovered by a new cRingStore at begin();
+	- count records (default 500) are appended, so the store wraps
+	  many times; the latest of each kind must always read back, and
+	  the erases must be spread evenly over the pages;
+	- a power failure is simulated after every byte count from zero
+	  to past a page switch; after each, begin() must recover every
+	  kind, with either the old or the new value of the record being
+	  written, and the store must go on working.
+
+	Exits with status 0 if all is well.
+
+*/
+
+#include <file_page_device.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/****************************************************************************\
+|
+|	The records
+|
+\****************************************************************************/
+
+using RecordKind = Arduino_LoRaWAN::cRingStore::RecordKind;
+
+static constexpr std::size_t kPageSize = 512;
+static constexpr unsigned kPages = 4;
+
+/// \brief the size of each kind of record; the last isn't a multiple of 4.
+static constexpr std::size_t kRecordSize[Arduino_LoRaWAN::cRingStore::kNumKinds] = { 64, 120, 10 };
+
+/// \brief the value most recently appended, for each kind.
+static std::uint32_t sValue[Arduino_LoRaWAN::cRingStore::kNumKinds];
+
+// fill a record with a pattern that depends on its kind and value.
+static void makeRecord(unsigned iKind, std::uint32_t value, std::uint8_t *pRecord)
+    {
+    for (std::size_t i = 0; i < kRecordSize[iKind]; ++i)
+        pRecord[i] = std::uint8_t(value * 7 + i * 13 + iKind);
+
+    std::memcpy(pRecord, &value, sizeof(value));
+    }
+
+static bool append(Arduino_LoRaWAN::cRingStore &store, unsigned iKind, std::uint32_t value)
+    {
+    std::uint8_t record[128];
+
+    makeRecord(iKind, value, record);
+    return store.append(RecordKind(iKind), record, kRecordSize[iKind]);
+    }
+
+// check the latest record of a kind; return its value, or ~0 if it's bad.
+static std::uint32_t readValue(Arduino_LoRaWAN::cRingStore &store, unsigned iKind)
+    {
+    std::uint8_t record[128];
+    std::uint8_t expected[128];
+    std::size_t nActual;
+    std::uint32_t value;
+
+    if (! store.read(RecordKind(iKind), record, sizeof(record), &nActual) ||
+        nActual != kRecordSize[iKind])
+        return ~std::uint32_t(0);
+
+    std::memcpy(&value, record, sizeof(value));
+    makeRecord(iKind, value, expected);
+    if (std::memcmp(record, expected, nActual) != 0)
+        return ~std::uint32_t(0);
+
+    return value;
+    }
+
+// check that every kind reads back its latest value.
+static bool checkAll(Arduino_LoRaWAN::cRingStore &store, const char *pWhat)
+    {
+    for (unsigned iKind = 0; iKind < Arduino_LoRaWAN::cRingStore::kNumKinds; ++iKind)
+        {
+        auto const value = readValue(store, iKind);
+
+        if (value != sValue[iKind])
+            {
+            std::printf("FAIL: %s: kind %u read %#lx, expected %#lx\n",
+                pWhat, iKind, (unsigned long) value, (unsigned long) sValue[iKind]
+                );
+            return false;
+            }
+        }
+
+    return true;
+    }
+
+/****************************************************************************\
+|
+|	The tests
+|
+\****************************************************************************/
+
+static bool testAppend(cFilePageDevice &device, const char *pFile)
+    {
+    Arduino_LoRaWAN::cRingStore store;
+
+    if (! device.open(pFile) || ! store.begin(&device) || ! store.format())
+        {
+        std::printf("FAIL: can't set up the store in %s\n", pFile);
+        return false;
+        }
+
+    for (unsigned iKind = 0; iKind < Arduino_LoRaWAN::cRingStore::kNumKinds; ++iKind)
+        {
+        std::uint8_t record[128];
+
+        if (store.read(RecordKind(iKind), record, sizeof(record)))
+            {
+            std::printf("FAIL: a new store has a record of kind %u\n", iKind);
+            return false;
+            }
+
+        sValue[iKind] = 1 + iKind;
+        if (! append(store, iKind, sValue[iKind]))
+            {
+            std::printf("FAIL: append of kind %u failed\n", iKind);
+            return false;
+            }
+        }
+
+    if (! checkAll(store, "append"))
+        return false;
+
+    // a new store on the same file must find the same records.
+    Arduino_LoRaWAN::cRingStore store2;
+
+    if (! device.open(pFile) || ! store2.begin(&device))
+        {
+        std::printf("FAIL: begin() failed after reopening\n");
+        return false;
+        }
+
+    return checkAll(store2, "recovery");
+    }
+
+static bool testWrap(cFilePageDevice &device, const char *pFile, unsigned nRecords)
+    {
+    Arduino_LoRaWAN::cRingStore store;
+
+    if (! device.open(pFile) || ! store.begin(&device))
+        return false;
+
+    auto const pageSeq = store.getPageSequence();
+
+    for (unsigned i = 0; i < nRecords; ++i)
+        {
+        // mostly session states, as in use.
+        unsigned const iKind = i % 8 == 0 ? 0 : i % 8 == 4 ? 2 : 1;
+
+        if (! append(store, iKind, ++sValue[iKind]))
+            {
+            std::printf("FAIL: append %u failed\n", i);
+            return false;
+            }
+
+        if (! checkAll(store, "wrap"))
+            return false;
+        }
+
+    auto const nPageSwitches = store.getPageSequence() - pageSeq;
+
+    if (nPageSwitches < 2 * kPages)
+        {
+        std::printf("FAIL: only %lu page switch(es); the store didn't wrap\n",
+            (unsigned long) nPageSwitches
+            );
+        return false;
+        }
+
+    Arduino_LoRaWAN::cRingStore store2;
+
+    if (! device.open(pFile) || ! store2.begin(&device) ||
+        ! checkAll(store2, "recovery after wrap"))
+        return false;
+
+    std::uint32_t nMin = ~std::uint32_t(0);
+    std::uint32_t nMax = 0;
+
+    for (unsigned iPage = 0; iPage < kPages; ++iPage)
+        {
+        auto const n = device.getEraseCount(iPage);
+
+        if (n < nMin)
+            nMin = n;
+        if (n > nMax)
+            nMax = n;
+        }
+
+    std::printf("%u record(s): %lu page switch(es), %lu to %lu erase(s) per page\n",
+        nRecords, (unsigned long) nPageSwitches, (unsigned long) nMin, (unsigned long) nMax
+        );
+
+    if (nMax - nMin > 1)
+        {
+        std::printf("FAIL: erases are uneven\n");
+        return false;
+        }
+
+    return true;
+    }
+
+static bool testPowerFail(cFilePageDevice &device, const char *pFile)
+    {
+    // enough bytes to cover a page switch, with its copies.
+    long const nMaxBytes = long(kPageSize);
+    unsigned nLost = 0;
+    unsigned nKept = 0;
+
+    for (long nBytes = 0; nBytes <= nMaxBytes; ++nBytes)
+        {
+        Arduino_LoRaWAN::cRingStore store;
+        unsigned const iKind = 1;
+
+        if (! device.open(pFile) || ! store.begin(&device))
+            {
+            std::printf("FAIL: power fail at %ld: begin() failed\n", nBytes);
+            return false;
+            }
+
+        // write until the power fails, then "reset". Records whose
+        // append() succeeded must all survive.
+        device.setPowerFail(nBytes);
+        while (! device.isPowerFailed())
+            {
+            if (! append(store, iKind, sValue[iKind] + 1))
+                break;
+            ++sValue[iKind];
+            }
+
+        auto const oldValue = sValue[iKind];
+        Arduino_LoRaWAN::cRingStore store2;
+
+        if (! device.open(pFile) || ! store2.begin(&device))
+            {
+            std::printf("FAIL: power fail at %ld: begin() failed after reset\n", nBytes);
+            return false;
+            }
+
+        // the record being written may or may not have made it.
+        auto const value = readValue(store2, iKind);
+
+        if (value == oldValue + 1)
+            {
+            ++nKept;
+            sValue[iKind] = value;
+            }
+        else
+            ++nLost;
+
+        char what[48];
+
+        std::snprintf(what, sizeof(what), "power fail at %ld", nBytes);
+        if (! checkAll(store2, what))
+            return false;
+
+        // and the store must still work.
+        if (! append(store2, 0, ++sValue[0]) ||
+            ! checkAll(store2, what))
+            {
+            std::printf("FAIL: %s: append after recovery failed\n", what);
+            return false;
+            }
+        }
+
+    std::printf("power fail at 0 to %ld byte(s): record being written lost %u time(s), kept %u time(s)\n",
+        nMaxBytes, nLost, nKept
+        );
+    return true;
+    }
+
+/****************************************************************************\
+|
+|	The main program
+|
+\****************************************************************************/
+
+int main(int argc, char **argv)
+    {
+    const char *pFile = "test_ringstore.bin";
+    unsigned nRecords = 500;
+
+    for (int iArg = 1; iArg < argc; ++iArg)
+        {
+        if (std::strcmp(argv[iArg], "-f") == 0 && iArg + 1 < argc)
+            pFile = argv[++iArg];
+        else if (std::strcmp(argv[iArg], "-n") == 0 && iArg + 1 < argc)
+            nRecords = unsigned(std::strtoul(argv[++iArg], nullptr, 0));
+        else
+            {
+            std::fprintf(stderr, "usage: %s [-f file] [-n count]\n", argv[0]);
+            return 2;
+            }
+        }
+
+    std::remove(pFile);
+
+    cFilePageDevice device { kPageSize, kPages };
+    bool const fOk = testAppend(device, pFile) &&
+                     testWrap(device, pFile, nRecords) &&
+                     testPowerFail(device, pFile);
+
+    device.close();
+    std::remove(pFile);
+
+    if (! fOk)
+        return 1;
+
+    std::printf("PASS\n");
+    return 0;
+    }
@@ -0,0 +1,255 @@
+/*
+
+Module:	test_sessionstate_codec.cpp
+
+Function:
+	Host test: round-trip the session state through the compact codec.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Usage:
+	test_sessionstate_codec [-m maxbytes]
+
+	Joins with the simulated network and sends an uplink. For EU-like
+	regions, it then sets up channels 3 to 7 (as a CFList would), calls
+	NoteSessionStateChanged() and sends another uplink. The last state
+	saved is encoded with Arduino_LoRaWAN_SessionStateCodec and decoded
+	again, and must come back unchanged in no more than maxbytes bytes
+	(default 128). The same is done for states with a data-rate map
+	that isn't a range, and with long waits, which must also round-trip.
+	A corrupted encoding must not decode. Exits with status 0 if all is
+	well.
+
+*/
+
+#include <Arduino_LoRaWAN_network.h>
+#include <Arduino_LoRaWAN_lmic.h>
+#include <Arduino_LoRaWAN_SessionStateCodec.h>
+#include <lmic_sim.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/****************************************************************************\
+|
+|	The device
+|
+\****************************************************************************/
+
+class cCodecLoRaWAN : public Arduino_LoRaWAN_network
+    {
+public:
+    /// \brief number of saves.
+    unsigned nSaves = 0;
+
+    /// \brief the state most recently saved.
+    SessionState last {};
+
+protected:
+    virtual bool GetOtaaProvisioningInfo(OtaaProvisioningInfo *pInfo) override
+        {
+        if (pInfo != nullptr)
+            {
+            static const uint8_t kDevEUI[8] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0xA3, 0x04, 0x01 };
+            static const uint8_t kAppEUI[8] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+            std::memset(pInfo->AppKey, 0x5A, sizeof(pInfo->AppKey));
+            std::memcpy(pInfo->DevEUI, kDevEUI, sizeof(kDevEUI));
+            std::memcpy(pInfo->AppEUI, kAppEUI, sizeof(kAppEUI));
+            }
+        return true;
+        }
+
+    virtual void NetSaveSessionState(const SessionState &State) override
+        {
+        ++this->nSaves;
+        this->last = State;
+        }
+    };
+
+static cCodecLoRaWAN myLoRaWAN;
+
+static bool fDone;
+
+static void sendDone(void *pCtx, bool fSuccess)
+    {
+    (void) pCtx;
+    (void) fSuccess;
+
+    fDone = true;
+    }
+
+/****************************************************************************\
+|
+|	The main program
+|
+\****************************************************************************/
+
+// send one uplink and run until it's done.
+static bool sendOne(uint8_t n)
+    {
+    bool fSent = false;
+
+    fDone = false;
+    while (! fDone)
+        {
+        myLoRaWAN.loop();
+        if (fDone)
+            break;
+
+        if (! fSent && myLoRaWAN.GetTxReady())
+            {
+            uint8_t payload[] = { n, 0x12, 0x34 };
+
+            fSent = myLoRaWAN.SendBuffer(payload, sizeof(payload), sendDone, nullptr, false);
+            }
+
+        std::int64_t tJob;
+
+        if (! LmicSim::getNextDeadline(tJob))
+            {
+            std::printf("FAIL: stalled sending uplink %u\n", n);
+            return false;
+            }
+
+        if (tJob > LmicSim::getTicks())
+            LmicSim::setTicks(tJob);
+        }
+
+    return true;
+    }
+
+// encode, check the size, decode and compare.
+static bool roundTrip(const char *pName, const Arduino_LoRaWAN::SessionState &State, size_t nMax)
+    {
+    uint8_t buffer[Arduino_LoRaWAN_SessionStateCodec::kMaxEncodedSize];
+    Arduino_LoRaWAN::SessionState decoded;
+    auto const nEncoded = Arduino_LoRaWAN_SessionStateCodec::encode(State, buffer, sizeof(buffer));
+
+    std::printf("%s: %u of %u byte(s), at most %u\n",
+        pName, unsigned(nEncoded), unsigned(sizeof(State)),
+        unsigned(Arduino_LoRaWAN_SessionStateCodec::kMaxEncodedSize)
+        );
+
+    if (nEncoded == 0)
+        {
+        std::printf("FAIL: %s: encode() failed\n", pName);
+        return false;
+        }
+
+    if (nMax != 0 && nEncoded > nMax)
+        {
+        std::printf("FAIL: %s: %u byte(s) is more than %u\n", pName, unsigned(nEncoded), unsigned(nMax));
+        return false;
+        }
+
+    if (Arduino_LoRaWAN_SessionStateCodec::encode(State, buffer, nEncoded - 1) != 0)
+        {
+        std::printf("FAIL: %s: encode() succeeded with a short buffer\n", pName);
+        return false;
+        }
+
+    if (! Arduino_LoRaWAN_SessionStateCodec::decode(buffer, nEncoded, decoded))
+        {
+        std::printf("FAIL: %s: decode() failed\n", pName);
+        return false;
+        }
+
+    if (std::memcmp(&decoded, &State, sizeof(State)) != 0)
+        {
+        std::printf("FAIL: %s: the decoded state differs\n", pName);
+        return false;
+        }
+
+    buffer[nEncoded / 2] ^= 0x10;
+    if (Arduino_LoRaWAN_SessionStateCodec::decode(buffer, nEncoded, decoded))
+        {
+        std::printf("FAIL: %s: a corrupted encoding decoded\n", pName);
+        return false;
+        }
+
+    return true;
+    }
+
+int main(int argc, char **argv)
+    {
+    size_t nMax = 128;
+
+    for (int iArg = 1; iArg < argc; ++iArg)
+        {
+        if (std::strcmp(argv[iArg], "-m") == 0 && iArg + 1 < argc)
+            nMax = size_t(std::strtoul(argv[++iArg], nullptr, 0));
+        else
+            {
+            std::fprintf(stderr, "usage: %s [-m maxbytes]\n", argv[0]);
+            return 2;
+            }
+        }
+
+    myLoRaWAN.SetDebugMask(0);
+
+    if (! myLoRaWAN.begin())
+        {
+        std::fprintf(stderr, "begin() failed\n");
+        return 1;
+        }
+
+    if (! sendOne(0))
+        return 1;
+
+#if CFG_LMIC_EU_like
+    // the channels of a CFList: 867.1 to 867.9 MHz, DR0 to DR5.
+    for (unsigned iCh = 3; iCh < 8; ++iCh)
+        LMIC_setupChannel(u1_t(iCh), 867100000 + (iCh - 3) * 200000, 0x003F, 1);
+
+    myLoRaWAN.NoteSessionStateChanged();
+#endif
+
+    if (! sendOne(1))
+        return 1;
+
+    if (myLoRaWAN.nSaves == 0)
+        {
+        std::printf("FAIL: no session state was saved\n");
+        return 1;
+        }
+
+    auto State = myLoRaWAN.last;
+
+    if (! roundTrip("joined", State, nMax))
+        return 1;
+
+    // the values that don't take the short forms must round-trip too.
+    State.V1.FCntUp = 0x89ABCDEF;
+    State.V1.gpsTime = 1400000000;
+    State.V1.globalAvail = 0xFFFFFF00;
+#if CFG_LMIC_EU_like
+    State.V1.Channels.EUlike.ChannelDrMap[3] = 0x0025;
+    State.V1.Channels.EUlike.setFrequency(State.V1.Channels.EUlike.DownlinkFreq, 4, 869525000);
+    State.V1.Channels.EUlike.setFrequency(
+        State.V1.Channels.EUlike.DownlinkFreq, 5,
+        State.V1.Channels.EUlike.getFrequency(State.V1.Channels.EUlike.UplinkFreq, 5)
+        );
+    State.V1.Channels.EUlike.Bands[0].ostimeAvail = 3000;
+    State.V1.Channels.EUlike.Bands[1].ostimeAvail = 375000;
+    State.V1.Channels.EUlike.Bands[2].ostimeAvail = 100000000;
+#endif
+    State.updateCrc();
+
+    if (! roundTrip("long forms", State, 0))
+        return 1;
+
+    std::printf("PASS\n");
+    return 0;
+    }
@@ -0,0 +1,535 @@
+/*
+
+Module:	logtoken_decode.cpp
+
+Function:
+	Host tool: turn tokenized Arduino_LoRaWAN log messages back into text.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+Usage:
+	c++ -std=c++11 -I ../../src -o logtoken_decode logtoken_decode.cpp
+	logtoken_decode [-s source]... [-d database]... [-l] [file]
+
+	Builds a token database from the format strings of the
+	ARDUINO_LORAWAN_PRINTF() and ARDUINO_LORAWAN_LOG_TOKEN() calls in
+	the source files, and from database files written by -l. Then reads
+	the log port output from file (or stdin), replaces each tokenized
+	message with its text, and copies everything else through.
+
+	-l writes the database to stdout instead, one "token<TAB>format"
+	line per format, with C escapes.
+
+*/
+
+#include <Arduino_LoRaWAN_LogToken.h>
+
+#include <cctype>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+/****************************************************************************\
+|
+|	The token database
+|
+\****************************************************************************/
+
+static std::map<std::uint32_t, std::string> gTokens;
+static unsigned gnCollisions;
+
+static void addFormat(const std::string &fmt)
+    {
+    auto const token = Arduino_LoRaWAN_LogToken::hash(fmt.c_str());
+    auto const it = gTokens.find(token);
+
+    if (it == gTokens.end())
+        gTokens[token] = fmt;
+    else if (it->second != fmt)
+        {
+        std::fprintf(stderr, "token 0x%08" PRIx32 " collision: \"%s\" and \"%s\"\n",
+            token, it->second.c_str(), fmt.c_str()
+            );
+        ++gnCollisions;
+        }
+    }
+
+// parse a C string literal body starting after the '"'; handles the
+// usual escapes. Returns the position after the closing '"'.
+static std::size_t parseLiteral(const std::string &text, std::size_t i, std::string &out)
+    {
+    while (i < text.size() && text[i] != '"')
+        {
+        char c = text[i++];
+
+        if (c == '\\' && i < text.size())
+            {
+            c = text[i++];
+            switch (c)
+                {
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            case 'r': c = '\r'; break;
+            case '0': c = '\0'; break;
+            case 'x':
+                {
+                unsigned v = 0;
+                while (i < text.size() && std::isxdigit((unsigned char) text[i]))
+                    {
+                    char const d = char(std::tolower((unsigned char) text[i++]));
+                    v = v * 16 + (d <= '9' ? d - '0' : d - 'a' + 10);
+                    }
+                c = char(v);
+                }
+                break;
+            default: break; // \\ \" \' and anything else: the char itself.
+                }
+            }
+        out += c;
+        }
+
+    return i + 1;
+    }
+
+// parse adjacent string literals (with whitespace between) at text[i].
+static bool parseLiterals(const std::string &text, std::size_t i, std::string &out)
+    {
+    bool fFound = false;
+
+    for (;;)
+        {
+        while (i < text.size() && std::isspace((unsigned char) text[i]))
+            ++i;
+        if (i >= text.size() || text[i] != '"')
+            return fFound;
+
+        i = parseLiteral(text, i + 1, out);
+        fFound = true;
+        }
+    }
+
+static bool scanSource(const char *pName)
+    {
+    std::FILE * const pFile = std::fopen(pName, "r");
+
+    if (pFile == nullptr)
+        {
+        std::perror(pName);
+        return false;
+        }
+
+    std::string text;
+    char buffer[4096];
+    std::size_t n;
+
+    while ((n = std::fread(buffer, 1, sizeof(buffer), pFile)) != 0)
+        text.append(buffer, n);
+    std::fclose(pFile);
+
+    // ARDUINO_LORAWAN_PRINTF(check, "format", ...): the format follows the first comma.
+    static const char kPrintf[] = "ARDUINO_LORAWAN_PRINTF(";
+    for (auto i = text.find(kPrintf); i != std::string::npos; i = text.find(kPrintf, i + 1))
+        {
+        auto const iComma = text.find(',', i);
+        std::string fmt;
+
+        if (iComma != std::string::npos && parseLiterals(text, iComma + 1, fmt))
+            addFormat(fmt);
+        }
+
+    // ARDUINO_LORAWAN_LOG_TOKEN("format")
+    static const char kToken[] = "ARDUINO_LORAWAN_LOG_TOKEN(";
+    for (auto i = text.find(kToken); i != std::string::npos; i = text.find(kToken, i + 1))
+        {
+        std::string fmt;
+
+        if (parseLiterals(text, i + sizeof(kToken) - 1, fmt))
+            addFormat(fmt);
+        }
+
+    return true;
+    }
+
+static bool readDatabase(const char *pName)
+    {
+    std::FILE * const pFile = std::fopen(pName, "r");
+
+    if (pFile == nullptr)
+        {
+        std::perror(pName);
+        return false;
+        }
+
+    char line[1024];
+    while (std::fgets(line, sizeof(line), pFile) != nullptr)
+        {
+        char *pTab = std::strchr(line, '\t');
+        if (pTab == nullptr)
+            continue;
+
+        // the format is written as a C literal body, so parse it as one.
+        std::string text(pTab + 1);
+        while (! text.empty() && (text.back() == '\n' || text.back() == '\r'))
+            text.pop_back();
+
+        std::string fmt;
+        text += '"';
+        parseLiteral(text, 0, fmt);
+        addFormat(fmt);
+        }
+
+    std::fclose(pFile);
+    return true;
+    }
+
+static void writeDatabase()
+    {
+    for (auto const &entry : gTokens)
+        {
+        std::printf("0x%08" PRIx32 "\t", entry.first);
+        for (char c : entry.second)
+            {
+            switch (c)
+                {
+            case '\n': std::printf("\\n"); break;
+            case '\t': std::printf("\\t"); break;
+            case '\r': std::printf("\\r"); break;
+            case '\\': std::printf("\\\\"); break;
+            case '"': std::printf("\\\""); break;
+            default:
+                if (std::isprint((unsigned char) c))
+                    std::putchar(c);
+                else
+                    std::printf("\\x%02x", (unsigned char) c);
+                break;
+                }
+            }
+        std::printf("\n");
+        }
+    }
+
+/****************************************************************************\
+|
+|	Formatting
+|
+\****************************************************************************/
+
+static const char kEventNames[] = ARDUINO_LORAWAN_LMIC_EV_NAMES_MZ__INIT;
+
+static const char *getEventName(std::uint64_t index)
+    {
+    const char *p = kEventNames;
+
+    for (; index != 0 && *p != '\0'; --index)
+        p += std::strlen(p) + 1;
+
+    return *p == '\0' ? "<<unknown>>" : p;
+    }
+
+template <typename T>
+static void formatArg(
+    char *pBuffer, std::size_t nBuffer,
+    const std::string &spec, unsigned nStars, const int *pStars,
+    T v
+    )
+    {
+    if (nStars == 0)
+        std::snprintf(pBuffer, nBuffer, spec.c_str(), v);
+    else if (nStars == 1)
+        std::snprintf(pBuffer, nBuffer, spec.c_str(), pStars[0], v);
+    else
+        std::snprintf(pBuffer, nBuffer, spec.c_str(), pStars[0], pStars[1], v);
+    }
+
+// print one message, following the format; the conversions are the
+// same as printf's.
+static void printMessage(const std::string &fmt, const std::uint8_t *p, const std::uint8_t *pEnd)
+    {
+    using Token = Arduino_LoRaWAN_LogToken;
+    std::size_t i = 0;
+
+    while (i < fmt.size())
+        {
+        if (fmt[i] != '%')
+            {
+            std::putchar(fmt[i++]);
+            continue;
+            }
+
+        // the spec, without its length modifier.
+        std::string spec(1, '%');
+        auto const iBegin = i++;
+        int stars[2];
+        unsigned nStars = 0;
+        bool fOk = true;
+
+        while (i < fmt.size() && std::strchr("-+ #0123456789.*", fmt[i]) != nullptr)
+            {
+            if (fmt[i] == '*')
+                {
+                std::int64_t v = 0;
+                fOk = fOk && nStars < 2 && Token::getInt(p, pEnd, v);
+                if (fOk)
+                    stars[nStars++] = int(v);
+                }
+            spec += fmt[i++];
+            }
+
+        std::string len;
+        while (i < fmt.size() && std::strchr("hlzjtL", fmt[i]) != nullptr)
+            len += fmt[i++];
+
+        if (i >= fmt.size())
+            {
+            std::fputs(fmt.c_str() + iBegin, stdout);
+            break;
+            }
+
+        char const conv = fmt[i++];
+        char buffer[256];
+
+        buffer[0] = '\0';
+
+        switch (conv)
+            {
+        case '%':
+            std::strcpy(buffer, "%");
+            break;
+
+        case 'd': case 'i':
+            {
+            std::int64_t v = 0;
+            fOk = fOk && Token::getInt(p, pEnd, v);
+            if (fOk)
+                formatArg(buffer, sizeof(buffer), spec + "ll" + conv, nStars, stars, (long long) v);
+            }
+            break;
+
+        case 'o': case 'u': case 'x': case 'X':
+            {
+            std::int64_t v = 0;
+            fOk = fOk && Token::getInt(p, pEnd, v);
+
+            // the device's int and long are 32 bits (16 bits for int on
+            // AVR, where "%x" of a negative int will show too many digits).
+            std::uint64_t u = std::uint64_t(v);
+            if (len == "hh")
+                u &= 0xFF;
+            else if (len == "h")
+                u &= 0xFFFF;
+            else if (len != "ll" && len != "j")
+                u &= 0xFFFFFFFF;
+
+            if (fOk)
+                formatArg(buffer, sizeof(buffer), spec + "ll" + conv, nStars, stars, (unsigned long long) u);
+            }
+            break;
+
+        case 'c':
+            {
+            std::int64_t v = 0;
+            fOk = fOk && Token::getInt(p, pEnd, v);
+            if (fOk)
+                formatArg(buffer, sizeof(buffer), spec + conv, nStars, stars, int(v));
+            }
+            break;
+
+        case 'p':
+            {
+            std::int64_t v = 0;
+            fOk = fOk && Token::getInt(p, pEnd, v);
+            if (fOk)
+                formatArg(buffer, sizeof(buffer), spec + "#llx", nStars, stars, (unsigned long long) std::uint32_t(v));
+            }
+            break;
+
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+            {
+            fOk = fOk && pEnd - p >= 4;
+            if (fOk)
+                {
+                std::uint32_t bits = 0;
+                float f;
+
+                for (unsigned j = 0; j < 4; ++j)
+                    bits |= std::uint32_t(*p++) << (8 * j);
+                std::memcpy(&f, &bits, sizeof(f));
+                formatArg(buffer, sizeof(buffer), spec + conv, nStars, stars, double(f));
+                }
+            }
+            break;
+
+        case 's':
+            {
+            std::uint64_t n = 0;
+            fOk = fOk && Token::getVarint(p, pEnd, n);
+            if (! fOk)
+                break;
+
+            if (n == 0)
+                {
+                std::uint64_t index = 0;
+                fOk = Token::getVarint(p, pEnd, index);
+                if (fOk)
+                    formatArg(buffer, sizeof(buffer), spec + conv, nStars, stars, getEventName(index));
+                }
+            else
+                {
+                fOk = std::uint64_t(pEnd - p) >= n - 1;
+                if (fOk)
+                    {
+                    std::string s(p, p + (n - 1));
+                    p += n - 1;
+                    formatArg(buffer, sizeof(buffer), spec + conv, nStars, stars, s.c_str());
+                    }
+                }
+            }
+            break;
+
+        case 'n':
+            break;
+
+        default:
+            // unknown conversion: show it as is.
+            std::fwrite(fmt.data() + iBegin, 1, i - iBegin, stdout);
+            break;
+            }
+
+        // the message was truncated on the device.
+        if (! fOk)
+            {
+            std::printf("...\n");
+            return;
+            }
+
+        std::fputs(buffer, stdout);
+        }
+    }
+
+/****************************************************************************\
+|
+|	The main program
+|
+\****************************************************************************/
+
+int main(int argc, char **argv)
+    {
+    std::FILE *pFile = stdin;
+    bool fList = false;
+    int iArg;
+
+    for (iArg = 1; iArg < argc && argv[iArg][0] == '-'; ++iArg)
+        {
+        if (std::strcmp(argv[iArg], "-s") == 0 && iArg + 1 < argc)
+            {
+            if (! scanSource(argv[++iArg]))
+                return 1;
+            }
+        else if (std::strcmp(argv[iArg], "-d") == 0 && iArg + 1 < argc)
+            {
+            if (! readDatabase(argv[++iArg]))
+                return 1;
+            }
+        else if (std::strcmp(argv[iArg], "-l") == 0)
+            fList = true;
+        else
+            {
+            std::fprintf(stderr,
+                "usage: %s [-s source]... [-d database]... [-l] [file]\n",
+                argv[0]
+                );
+            return 2;
+            }
+        }
+
+    if (fList)
+        {
+        writeDatabase();
+        return gnCollisions != 0;
+        }
+
+    if (iArg < argc)
+        {
+        pFile = std::fopen(argv[iArg], "rb");
+        if (pFile == nullptr)
+            {
+            std::perror(argv[iArg]);
+            return 1;
+            }
+        }
+
+    std::uint8_t buffer[4096];
+    std::size_t nBuffer = 0;
+    unsigned long nUnknown = 0;
+    bool fEof = false;
+
+    while (! fEof || nBuffer != 0)
+        {
+        if (! fEof)
+            {
+            auto const n = std::fread(buffer + nBuffer, 1, sizeof(buffer) - nBuffer, pFile);
+            if (n == 0)
+                fEof = true;
+            nBuffer += n;
+            }
+
+        std::size_t i = 0;
+        while (i < nBuffer)
+            {
+            std::uint32_t token;
+            const std::uint8_t *pArgs;
+            std::size_t nArgs;
+            auto const n = Arduino_LoRaWAN_LogToken::decode(
+                    buffer + i, nBuffer - i, token, pArgs, nArgs
+                    );
+
+            if (n > 0)
+                {
+                auto const it = gTokens.find(token);
+
+                if (it != gTokens.end())
+                    printMessage(it->second, pArgs, pArgs + nArgs);
+                else
+                    {
+                    std::printf("<token 0x%08" PRIx32 ", %zu byte(s)>\n", token, nArgs);
+                    ++nUnknown;
+                    }
+                i += n;
+                }
+            else if (n < 0 || fEof)
+                {
+                // not a message: ordinary output, copied through.
+                std::putchar(buffer[i]);
+                ++i;
+                }
+            else
+                {
+                // need more data.
+                break;
+                }
+            }
+
+        std::memmove(buffer, buffer + i, nBuffer - i);
+        nBuffer -= i;
+        }
+
+    if (nUnknown != 0)
+        std::fprintf(stderr, "%lu message(s) with unknown tokens\n", nUnknown);
+
+    return nUnknown != 0;
+    }
@@ -24,6 +24,8 @@ Author:
 
 #include <cstring>
 #include <arduino_lmic_hal_configuration.h>
+#include <Arduino_LoRaWAN_LogToken.h>
+#include <Arduino_LoRaWAN_NameTable.h>
 
 /// \brief construct Arduino LoRaWAN semantic version
 #define ARDUINO_LORAWAN_VERSION_CALC(major, minor, patch, local)        \
@@ -64,6 +66,91 @@ Author:
 
 class Arduino_LoRaWAN;
 
+/****************************************************************************\
+|
+|       Compile-time configuration. All of these can be overridden from the
+|       compiler command line.
+|
+\****************************************************************************/
+
+/// \brief number of messages that can be waiting behind SendBuffer().
+#ifndef ARDUINO_LORAWAN_CFG_UPLINK_QUEUE_DEPTH
+# define ARDUINO_LORAWAN_CFG_UPLINK_QUEUE_DEPTH         4
+#endif
+
+/// \brief size of each copy-in buffer in the uplink queue, in bytes.
+#ifndef ARDUINO_LORAWAN_CFG_UPLINK_QUEUE_BUFFER_SIZE
+# define ARDUINO_LORAWAN_CFG_UPLINK_QUEUE_BUFFER_SIZE   64
+#endif
+
+/// \brief default FCnt journal interval; zero disables journaling.
+///     See Arduino_LoRaWAN::SetFCntJournalInterval().
+#ifndef ARDUINO_LORAWAN_CFG_FCNT_JOURNAL_INTERVAL
+# define ARDUINO_LORAWAN_CFG_FCNT_JOURNAL_INTERVAL      0
+#endif
+
+/// \brief number of entries in a cEventLog; must be a power of two.
+#ifndef ARDUINO_LORAWAN_CFG_EVENTLOG_CAPACITY
+# define ARDUINO_LORAWAN_CFG_EVENTLOG_CAPACITY          8
+#endif
+
+/// \brief if non-zero, cEventLog::logEvent() may be called concurrently
+///     from more than one task or interrupt level. Needs an atomic
+///     compare-and-swap (not available on Cortex-M0/M0+).
+#ifndef ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+# define ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER    0
+#endif
+
+/// \brief size in bytes of the deferred LogPrintf() buffer. If zero,
+///     LogPrintf() formats and prints at once; otherwise it saves the
+///     format and arguments, and loop() prints them later.
+#ifndef ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE
+# define ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE          0
+#endif
+
+/// \brief if non-zero, ARDUINO_LORAWAN_PRINTF() sends a binary message
+///     with a hash of the format instead of text. See
+///     Arduino_LoRaWAN_LogToken.h and extras/logtoken-decode.
+#ifndef ARDUINO_LORAWAN_CFG_LOG_TOKENIZED
+# define ARDUINO_LORAWAN_CFG_LOG_TOKENIZED              0
+#endif
+
+/// \brief if zero, ARDUINO_LORAWAN_PRINTF(LogBasic, ...) generates no code.
+#ifndef ARDUINO_LORAWAN_CFG_LOG_BASIC
+# define ARDUINO_LORAWAN_CFG_LOG_BASIC                  1
+#endif
+
+/// \brief if zero, ARDUINO_LORAWAN_PRINTF(LogErrors, ...) generates no code.
+#ifndef ARDUINO_LORAWAN_CFG_LOG_ERRORS
+# define ARDUINO_LORAWAN_CFG_LOG_ERRORS                 1
+#endif
+
+/// \brief if zero, ARDUINO_LORAWAN_PRINTF(LogVerbose, ...) generates no code.
+#ifndef ARDUINO_LORAWAN_CFG_LOG_VERBOSE
+# define ARDUINO_LORAWAN_CFG_LOG_VERBOSE                1
+#endif
+
+/// \brief if non-zero, the instance that gets LMIC events is per-thread.
+///     Only for hosts that simulate devices in several threads, each with
+///     its own LMIC (see extras/host).
+#ifndef ARDUINO_LORAWAN_CFG_THREAD_LOCAL_INSTANCE
+# define ARDUINO_LORAWAN_CFG_THREAD_LOCAL_INSTANCE      0
+#endif
+
+#if ARDUINO_LORAWAN_CFG_THREAD_LOCAL_INSTANCE
+# define ARDUINO_LORAWAN_INSTANCE_STORAGE_      thread_local
+#else
+# define ARDUINO_LORAWAN_INSTANCE_STORAGE_      /* static storage */
+#endif
+
+/// \brief if non-zero, time the event and uplink paths with
+///     Arduino_LoRaWAN_Probes; see Arduino_LoRaWAN::GetProbes().
+#ifndef ARDUINO_LORAWAN_CFG_PROBES
+# define ARDUINO_LORAWAN_CFG_PROBES                     0
+#endif
+
+#include <Arduino_LoRaWAN_Probes.h>
+
 /*
 || You can use this for declaring event functions...
 || or use a lambda if you're bold; but remember, no
@@ -96,7 +183,32 @@ public:
         /*
         || the event logger
         */
+        class cEventLogBase; /* forward reference, see Arduino_LoRaWAN_EventLog.h */
+        template <unsigned a_nCapacity>
+        class cSizedEventLog; /* forward reference, see Arduino_LoRaWAN_EventLog.h */
         class cEventLog; /* forward reference, see Arduino_LoRaWAN_EventLog.h */
+        class cEventLogSink; /* forward reference, see Arduino_LoRaWAN_EventLog.h */
+        class cEventLogPrintSink; /* forward reference, see Arduino_LoRaWAN_EventLog.h */
+        class cEventLogRamSink; /* forward reference, see Arduino_LoRaWAN_EventLog.h */
+        class cEventLogRetainedSink; /* forward reference, see Arduino_LoRaWAN_EventLog.h */
+
+        /*
+        || the uplink aggregator
+        */
+        class cUplinkAggregator; /* forward reference, see Arduino_LoRaWAN_UplinkAggregator.h */
+
+        /*
+        || persistent storage for session data
+        */
+        class cPageDevice; /* forward reference, see Arduino_LoRaWAN_RingStore.h */
+        class cRingStore; /* forward reference, see Arduino_LoRaWAN_RingStore.h */
+
+        /*
+        || compact encoding of session state
+        */
+        class cSessionStateCodecBase; /* forward reference, see Arduino_LoRaWAN_SessionStateCodec.h */
+        template <class TChannels>
+        class cSessionStateCodec; /* forward reference, see Arduino_LoRaWAN_SessionStateCodec.h */
 
         /*
         || debug things
@@ -127,19 +239,34 @@ public:
                 Generic
                 };
 
+        /// \brief a network and its name.
+        struct NetworkName_t
+                {
+                NetworkID_t id;         ///< the network
+                const char *pName;      ///< its name
+                };
+
+        /// \brief the network names, indexed by NetworkID_t (checked
+        ///     by static_assert after the class).
+        static constexpr NetworkName_t kNetworkNames[] =
+                {
+                { NetworkID_t::TheThingsNetwork,    "The Things Network" },
+                { NetworkID_t::Actility,            "Actility" },
+                { NetworkID_t::Helium,              "Helium" },
+                { NetworkID_t::machineQ,            "machineQ" },
+                { NetworkID_t::Senet,               "Senet" },
+                { NetworkID_t::Senra,               "Senra" },
+                { NetworkID_t::Swisscom,            "Swisscom" },
+                { NetworkID_t::ChirpStack,          "ChirpStack" },
+                { NetworkID_t::Generic,             "Generic" },
+                };
+
         // change network code to text
         static constexpr const char * NetworkID_t_GetName(NetworkID_t net)
                 {
-                return  (net == NetworkID_t::TheThingsNetwork) ?    "The Things Network" :
-                        (net == NetworkID_t::Actility) ?            "Actility" :
-                        (net == NetworkID_t::Helium)   ?            "Helium" :
-                        (net == NetworkID_t::machineQ) ?            "machineQ" :
-                        (net == NetworkID_t::Senet)    ?            "Senet" :
-                        (net == NetworkID_t::Senra)    ?            "Senra" :
-                        (net == NetworkID_t::Swisscom) ?            "Swisscom" :
-                        (net == NetworkID_t::ChirpStack) ?          "ChirpStack" :
-                        (net == NetworkID_t::Generic)  ?            "Generic" :
-                        "<<unknown network>>"
+                return  std::size_t(net) < sizeof(kNetworkNames) / sizeof(kNetworkNames[0])
+                        ? kNetworkNames[std::size_t(net)].pName
+                        : "<<unknown network>>"
                         ;
                 }
 
@@ -397,6 +524,7 @@ public:
                 kSessionInfoTag_Null = 0x00,    ///< indicates that there's no info.
                 kSessionInfoTag_V1 = 0x01,      ///< indicates the V1 structure
                 kSessionInfoTag_V2 = 0x02,      ///< indicates the V1 structure
+                kSessionInfoTag_V3 = 0x03,      ///< indicates the V3 structure
                 };
 
         /// \brief Header for SessionInfo; allows versioning.
@@ -438,6 +566,21 @@ public:
                 uint8_t         AppSKey[16];    // app session key
                 };
 
+        /// \brief Version 3 of session info: version 2, with a CRC.
+        struct SessionInfoV3
+                {
+                // to ensure packing, we just repeat the header.
+                uint8_t         Tag;            // kSessionInfoTag_V3
+                uint8_t         Size;           // sizeof(SessionInfo)
+                uint8_t         Rsv2;           // reserved
+                uint8_t         Rsv3;           // reserved
+                uint32_t        NetID;          // the network ID
+                uint32_t        DevAddr;        // device address
+                uint8_t         NwkSKey[16];    // network session key
+                uint8_t         AppSKey[16];    // app session key
+                uint32_t        Crc;            // CRC-32 of the above
+                };
+
         /// \brief information about the current session.
         ///
         /// \details
@@ -448,9 +591,12 @@ public:
         /// storage schemes.
         ///
         /// Older versions of Arduino_LoRaWAN sent version 1 at join,
-        /// including the frame counts. Newer versions send version 2
+        /// including the frame counts. Later versions sent version 2
         /// at join, followed by a SessionState message (which includes
-        /// the frame counts).
+        /// the frame counts). Current versions send version 3, which
+        /// is version 2 followed by a CRC-32, so that a damaged copy
+        /// can be detected. The NetID, DevAddr and keys are at the same
+        /// offsets in all versions.
         ///
         /// \see SessionState
         ///
@@ -465,14 +611,37 @@ public:
                 /// SessionInfo::V2 is used as v0.9 of the Arduino_LoRaWAN,
                 /// in conjunction with the SessionState message
                 SessionInfoV2   V2;
+
+                /// SessionInfo::V3 adds a CRC to V2.
+                SessionInfoV3   V3;
+
+                /// \brief return true if this is an intact current-version record.
+                bool isValid() const;
+
+                ///
+                /// \brief convert an older version to the current version.
+                ///
+                /// \details
+                /// The frame counts in a V1 record are dropped; they are
+                /// kept in SessionState.
+                ///
+                /// \return the result of isValid() after conversion.
+                ///
+                bool upgrade();
+
+                /// \brief compute the CRC of a V3 record.
+                uint32_t computeCrc() const;
                 } SessionInfo;
 
+        static_assert(sizeof(SessionInfoV3) <= sizeof(SessionInfoV1), "SessionInfoV3 must not change sizeof(SessionInfo)");
+
 
         /// \brief discriminate SessionState variants
         enum SessionStateTag : uint8_t
                 {
                 kSessionStateTag_Null = 0x00,   ///< indicates that there's no info.
                 kSessionStateTag_V1 = 0x01,     ///< indicates the V1 structure
+                kSessionStateTag_V2 = 0x02,     ///< indicates the V2 structure
                 };
 
         ///
@@ -539,11 +708,50 @@ public:
 
         static_assert(sizeof(SessionStateV1) < 256, "SessionStateV1 is too large");
 
+        ///
+        /// \brief the second version of SessionState: the V1 fields, with a CRC.
+        ///
+        /// \details
+        /// The V1 fields are unchanged, so SessionState::V1 can be used to
+        /// access them in either version; only the tag and size differ.
+        ///
+        struct SessionStateV2
+                {
+                SessionStateV1  Body;           ///< Tag is kSessionStateTag_V2, Size is sizeof(SessionStateV2)
+                uint32_t        Crc;            ///< CRC-32 of Body
+                };
+
+        static_assert(sizeof(SessionStateV2) < 256, "SessionStateV2 is too large");
+
         typedef union SessionState_u
                 {
                 SessionStateHeader      Header;
                 SessionStateV1          V1;
+                SessionStateV2          V2;
+
+                /// \brief return true if this is an intact current-version state.
                 bool isValid() const;
+
+                ///
+                /// \brief convert an older version to the current version.
+                ///
+                /// \details
+                /// A V1 state (which has no CRC) is checked for consistency,
+                /// then given the V2 tag, size and CRC. A future layout
+                /// adds its conversion here.
+                ///
+                /// \return the result of isValid() after conversion.
+                ///
+                bool upgrade();
+
+                /// \brief compute the CRC of a V2 state.
+                uint32_t computeCrc() const;
+
+                /// \brief set the CRC of a V2 state.
+                void updateCrc() { this->V2.Crc = this->computeCrc(); }
+
+                /// \brief return true if the channel info is consistent.
+                bool isValidChannels() const;
                 } SessionState;
 
         /*
@@ -601,6 +809,48 @@ public:
                 ) __attribute__((__format__(__printf__, 2, 3)));
                 /* format counts start with 2 for non-static C++ member fns */
 
+        /// \brief print all deferred LogPrintf() messages now.
+        ///
+        /// \details
+        /// Does nothing unless \c ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE
+        /// is non-zero. Use before sleeping or resetting, so that
+        /// messages aren't lost.
+        ///
+        void FlushLog();
+
+        /// \brief number of deferred LogPrintf() messages lost because
+        ///     the buffer was full.
+        uint32_t GetLogLostCount() const { return this->m_nLogLost; }
+
+        /// \brief number of deferred LogPrintf() messages printed
+        ///     truncated, because the record or the line was full.
+        uint32_t GetLogTruncatedCount() const { return this->m_nLogTruncated; }
+
+        ///
+        /// \brief send a tokenized log message.
+        ///
+        /// \param [in] token the token for the format; normally
+        ///     ARDUINO_LORAWAN_LOG_TOKEN("format").
+        /// \param [in] args the arguments for the format.
+        ///
+        /// \details
+        /// This is what ARDUINO_LORAWAN_PRINTF() calls when
+        /// \c ARDUINO_LORAWAN_CFG_LOG_TOKENIZED is non-zero. The format
+        /// string itself isn't needed in the image.
+        ///
+        template <typename... TArgs>
+        void LogToken(uint32_t token, TArgs... args)
+                {
+                Arduino_LoRaWAN_LogToken::Encoder_t message(token);
+
+                message.put(args...);
+                auto const nMessage = message.finish();
+                this->LogWrite(message.getData(), nMessage);
+                }
+
+        /// \brief write binary log data to the log port (Serial).
+        void LogWrite(const uint8_t *pData, size_t nData);
+
 
         /*
         || we only support a single instance, but we don't name it. During
@@ -611,6 +861,53 @@ public:
                 return Arduino_LoRaWAN::pLoRaWAN;
                 }
 
+#if ARDUINO_LORAWAN_CFG_THREAD_LOCAL_INSTANCE
+        ///
+        /// \brief select this thread's instance, the one that gets LMIC
+        ///     events.
+        ///
+        /// \details
+        ///     Only in builds with \c ARDUINO_LORAWAN_CFG_THREAD_LOCAL_INSTANCE.
+        ///     begin() sets the instance, and normally nothing else is
+        ///     needed. A host simulation that runs several instances, each
+        ///     with its own simulated LMIC, calls this before running each
+        ///     one.
+        ///
+        /// \return the previous instance.
+        ///
+        static Arduino_LoRaWAN *SetInstance(Arduino_LoRaWAN *pLoRaWAN)
+                {
+                auto const pOld = Arduino_LoRaWAN::pLoRaWAN;
+
+                Arduino_LoRaWAN::pLoRaWAN = pLoRaWAN;
+                return pOld;
+                }
+#endif
+
+#if ARDUINO_LORAWAN_CFG_PROBES
+        /// \brief the timing probes of this instance.
+        Arduino_LoRaWAN_Probes &GetProbes()
+                {
+                return this->m_Probes;
+                }
+
+        /// \brief the timing probes of this instance.
+        const Arduino_LoRaWAN_Probes &GetProbes() const
+                {
+                return this->m_Probes;
+                }
+#endif
+
+        ///
+        /// \brief compute an IEEE 802.3 CRC-32.
+        ///
+        /// \param [in] pData the data.
+        /// \param [in] nData number of bytes of data.
+        /// \param [in] crc the result of a previous call, to continue a
+        ///     computation over several buffers; zero to start.
+        ///
+        static uint32_t Crc32(const void *pData, size_t nData, uint32_t crc = 0);
+
         // return the region string to the buffer
         const char *GetRegionString(char *pBuf, size_t sizeBuf) const;
 
@@ -644,15 +941,156 @@ public:
 
         typedef void SendBufferCbFn(void *pCtx, bool fSuccess);
 
+        /// \brief priority of a message in the uplink queue.
+        ///
+        /// \details
+        ///     Higher priority messages are sent first; messages of equal
+        ///     priority are sent in order. If the queue is full, a new
+        ///     message displaces the newest message of the lowest priority
+        ///     present, provided that priority is lower than its own.
+        ///
+        enum class UplinkPriority : uint8_t
+                {
+                kLow = 0,       ///< background data; sent when nothing else is waiting.
+                kNormal = 1,    ///< routine data; the default.
+                kUrgent = 2,    ///< alarms and the like.
+                };
+
         bool SendBuffer(
                 const uint8_t *pBuffer,
                 size_t nBuffer,
                 SendBufferCbFn *pDoneFn = nullptr,
                 void *pCtx = nullptr,
                 bool fConfirmed = false,
-                uint8_t port = 1
+                uint8_t port = 1,
+                UplinkPriority priority = UplinkPriority::kNormal,
+                uint32_t tDeadline = 0
+                );
+
+        /// \brief like SendBuffer(), but the caller keeps ownership of
+        ///     the buffer, which must remain valid until pDoneFn is called.
+        bool SendBufferNoCopy(
+                const uint8_t *pBuffer,
+                size_t nBuffer,
+                SendBufferCbFn *pDoneFn = nullptr,
+                void *pCtx = nullptr,
+                bool fConfirmed = false,
+                uint8_t port = 1,
+                UplinkPriority priority = UplinkPriority::kNormal,
+                uint32_t tDeadline = 0
                 );
 
+        /// \brief the number of entries in the uplink queue.
+        static constexpr unsigned kUplinkQueueDepth = ARDUINO_LORAWAN_CFG_UPLINK_QUEUE_DEPTH;
+
+        /// \brief the size of the copy-in buffer of each uplink queue entry.
+        static constexpr size_t kUplinkQueueBufferSize = ARDUINO_LORAWAN_CFG_UPLINK_QUEUE_BUFFER_SIZE;
+
+        /// \brief return the number of free entries in the uplink queue.
+        unsigned GetUplinkQueueFree() const
+                {
+                return kUplinkQueueDepth - this->m_nUplinkQueue;
+                }
+
+        /// \brief return the largest message that can be sent at the
+        ///     current data rate, or zero if not known.
+        size_t GetMaxPayloadSize() const;
+
+        /// \brief return the time-on-air of a message at the current data
+        ///     rate, in \c os_getTime() ticks.
+        uint32_t GetTxAirtime(size_t nBuffer, uint8_t port = 1) const;
+
+        ///
+        /// \brief compute the earliest time a message could be sent.
+        ///
+        /// \param [in] nBuffer size of the message.
+        /// \param [in] port the LoRaWAN port.
+        /// \param [out] tNext set to the earliest \c os_getTime() at which
+        ///     the LMIC could start the transmit.
+        /// \param [out] pAirtime if not \c nullptr, set to the time-on-air
+        ///     of the message, in \c os_getTime() ticks.
+        ///
+        /// \return \c true if the message can be sent at the current data
+        ///     rate; \c false if it's too long (or the data rate is not known).
+        ///
+        bool GetNextTxTime(
+                size_t nBuffer,
+                uint8_t port,
+                uint32_t &tNext,
+                uint32_t *pAirtime = nullptr
+                ) const;
+
+        /// \brief one point of a transmit current curve.
+        struct TxCurrentPoint_t
+                {
+                int8_t dBm;                     ///< transmit power.
+                uint32_t microamps;             ///< supply current at that power.
+                };
+
+        ///
+        /// \brief the radio's supply current, for charge estimates.
+        ///
+        /// \details
+        ///     The transmit current is interpolated from \c pTxCurrent,
+        ///     which must be sorted by power; below the first point or
+        ///     above the last, the nearest point is used. One point
+        ///     gives a fixed current.
+        ///
+        struct EnergyProfile_t
+                {
+                const TxCurrentPoint_t *pTxCurrent;     ///< transmit current by power.
+                uint8_t nTxCurrent;                     ///< number of points.
+                uint32_t rxMicroamps;                   ///< current while receiving.
+                };
+
+        /// \brief the default profile: an SX1276, from the datasheet.
+        static const EnergyProfile_t kDefaultEnergyProfile;
+
+        /// \brief radio-on time and estimated charge since begin() or
+        ///     the last ResetEnergyCounters().
+        struct EnergyCounters_t
+                {
+                uint32_t nTransmissions;        ///< uplinks sent, including joins and retries.
+                uint32_t nJoinAttempts;         ///< join requests sent.
+                uint32_t nRxWindows;            ///< receive windows opened.
+                uint32_t nDownlinks;            ///< downlinks and join accepts received.
+                uint32_t nMessages;             ///< uplink messages completed (EV_TXCOMPLETE).
+                uint64_t txAirtimeUs;           ///< total time on air.
+                uint64_t rxOpenUs;              ///< total time the receiver was on.
+                uint64_t txChargeUc;            ///< charge used transmitting, microcoulombs.
+                uint64_t rxChargeUc;            ///< charge used receiving, microcoulombs.
+                uint64_t joinChargeUc;          ///< the part of the charge used by joins.
+                uint32_t lastMessageChargeUc;   ///< charge used by the last message.
+                };
+
+        ///
+        /// \brief select the current profile for charge estimates.
+        ///
+        /// \param [in] pProfile the profile, which must stay valid; if
+        ///     \c nullptr, kDefaultEnergyProfile.
+        ///
+        /// Counters already accumulated are not changed.
+        ///
+        void SetEnergyProfile(const EnergyProfile_t *pProfile);
+
+        /// \brief get the energy counters.
+        void GetEnergyCounters(EnergyCounters_t &counters) const;
+
+        /// \brief clear the energy counters.
+        void ResetEnergyCounters();
+
+        ///
+        /// \brief estimate the charge of sending a message now.
+        ///
+        /// \param [in] nBuffer size of the message.
+        ///
+        /// \return the charge in microcoulombs: the transmit at the
+        ///     current data rate and power, plus the average receive
+        ///     charge of the messages so far. Zero if the data rate is
+        ///     not known.
+        ///
+        uint32_t GetMessageChargeEstimate(size_t nBuffer) const;
+
         typedef void ReceivePortBufferCbFn(
                 void *pCtx,
                 uint8_t uPort,
@@ -705,6 +1143,48 @@ public:
         // honored, but the device will never try to rejoin.
         bool SetLinkCheckMode(bool fEnable);
 
+        ///
+        /// \brief set the FCnt journal interval.
+        ///
+        /// \param [in] nFrames the number of uplinks between saves of the
+        ///     session state, or zero to save after every change.
+        ///
+        /// \details
+        /// In journal mode, the saved uplink frame count is a reservation:
+        /// it's written \p nFrames ahead of the LMIC's count, and rewritten
+        /// only when the LMIC reaches it. A restored count therefore never
+        /// reuses a frame count, though up to \p nFrames counts may be
+        /// skipped after a restart. Changes to the downlink count, the
+        /// link-integrity count, timers and channel rotation state don't
+        /// cause a save on their own; they are saved along with the next
+        /// reservation or configuration change. Call this before begin().
+        ///
+        void SetFCntJournalInterval(uint32_t nFrames)
+                {
+                this->m_FCntJournalInterval = nFrames;
+                }
+
+        /// \brief return the FCnt journal interval.
+        uint32_t GetFCntJournalInterval() const
+                {
+                return this->m_FCntJournalInterval;
+                }
+
+        ///
+        /// \brief note that the LMIC configuration was changed directly.
+        ///
+        /// \details
+        /// The session state is only rebuilt in full after events that can
+        /// change the configuration (joins, downlinks, resets and so on);
+        /// otherwise just the frame counts and timers are updated. Call
+        /// this after changing the channels, data rate or other MAC
+        /// settings with the LMIC API, so the next save includes them.
+        ///
+        void NoteSessionStateChanged()
+                {
+                this->MarkSessionStateDirty(kSessionStateDirty_Config);
+                }
+
         // Data about the currently pending transmit.
         struct SendBufferData_t
                 {
@@ -879,23 +1359,203 @@ protected:
                 // default: do nothing.
                 }
 
+        ///
+        /// \brief get the current time, for stamping the session state.
+        ///
+        /// \param [out] gpsTime set to the current time, in seconds since
+        ///     the GPS epoch (1980-01-06 00:00:00 UTC, without leap seconds).
+        ///
+        /// \details
+        /// The time is saved in SessionState::V1.gpsTime. When the state is
+        /// restored, the time that has passed since it was saved is taken
+        /// off the duty-cycle waits, so a node that slept through them can
+        /// transmit at once. The clock must keep running while the node is
+        /// off or asleep (an RTC, for example); override this to read it.
+        ///
+        /// The default uses the network time from the LMIC's last
+        /// DeviceTimeReq (see LMIC_requestNetworkTime()), if there was one
+        /// since the LMIC was started; this doesn't survive a reset.
+        ///
+        /// \return \c true if \p gpsTime was set.
+        ///
+        virtual bool NetGetGpsTime(uint32_t &gpsTime) const;
+
+        /// \brief save part of the session state
+        ///
+        /// \param [in] State the complete new session state.
+        /// \param [in] offset offset in bytes of the changed range from
+        ///     the start of \p State.
+        /// \param [in] nBytes number of bytes in the changed range.
+        ///
+        /// \details
+        /// When only a few bytes of the session state have changed since
+        /// the last save (typically the frame counters), this is called
+        /// instead of NetSaveSessionState(), once for each changed range.
+        /// Storage backed by EEPROM or flash can then write just those
+        /// bytes, at the same offsets, over the previously saved state.
+        ///
+        /// \return \c true if the range was saved; \c false to request a
+        ///     full save with NetSaveSessionState(). The default returns
+        ///     \c false.
+        ///
+        virtual bool NetSaveSessionStateDelta(
+                const SessionState &State,
+                size_t offset,
+                size_t nBytes
+                )
+                {
+                MCCIADK_API_PARAMETER(State);
+                MCCIADK_API_PARAMETER(offset);
+                MCCIADK_API_PARAMETER(nBytes);
+
+                // default: ask for a full save.
+                return false;
+                }
+
+        /// \brief return true if basic logging is enabled.
+        bool LogBasic()
+                {
+                return ARDUINO_LORAWAN_CFG_LOG_BASIC &&
+                       (this->m_ulDebugMask & LOG_BASIC) != 0;
+                }
+
+        /// \brief return true if error logging is enabled.
+        bool LogErrors()
+                {
+                return ARDUINO_LORAWAN_CFG_LOG_ERRORS &&
+                       (this->m_ulDebugMask & LOG_ERRORS) != 0;
+                }
+
         /// \brief return true if verbose logging is enabled.
         bool LogVerbose()
                 {
-                return (this->m_ulDebugMask & LOG_VERBOSE) != 0;
+                return ARDUINO_LORAWAN_CFG_LOG_VERBOSE &&
+                       (this->m_ulDebugMask & LOG_VERBOSE) != 0;
                 }
 
         uint32_t m_ulDebugMask;
 
 private:
+        // examples/benchmark times the session-state and uplink-queue
+        // routines below.
+        friend class Arduino_LoRaWAN_Benchmark;
+
         SendBufferData_t m_SendBufferData;
 
+        /// \brief a message waiting in the uplink queue.
+        struct UplinkQueueEntry_t
+                {
+                const uint8_t *pBuffer;         ///< the data: either \c Buffer or the caller's buffer.
+                SendBufferCbFn *pDoneFn;        ///< completion function.
+                void *pDoneCtx;                 ///< context for completion function.
+                uint32_t tDeadline;             ///< os_getTime() after which message is dropped, or zero.
+                uint32_t uSeq;                  ///< order of arrival, for ordering within a priority.
+                uint8_t nBuffer;                ///< number of bytes to send.
+                uint8_t port;                   ///< LoRaWAN port.
+                UplinkPriority priority;        ///< priority of this message.
+                bool fConfirmed;                ///< true for a confirmed uplink.
+                bool fInUse;                    ///< true if this entry holds a message.
+                uint8_t Buffer[kUplinkQueueBufferSize]; ///< storage for copy-in messages.
+                };
+
+        /// \brief the uplink queue; entries are used in any order.
+        UplinkQueueEntry_t m_UplinkQueue[kUplinkQueueDepth] {};
+        /// \brief sequence number for the next entry in \c m_UplinkQueue.
+        uint32_t m_UplinkQueueSeq = 0;
+        /// \brief number of entries in \c m_UplinkQueue.
+        unsigned m_nUplinkQueue = 0;
+
+        /// \brief common code for SendBuffer() and SendBufferNoCopy().
+        bool QueueUplink(
+                const uint8_t *pBuffer,
+                size_t nBuffer,
+                SendBufferCbFn *pDoneFn,
+                void *pDoneCtx,
+                bool fConfirmed,
+                uint8_t port,
+                UplinkPriority priority,
+                uint32_t tDeadline,
+                bool fCopy
+                );
+
+        /// \brief hand a message to the LMIC; completes it on failure.
+        bool SubmitUplink(
+                const uint8_t *pBuffer,
+                size_t nBuffer,
+                SendBufferCbFn *pDoneFn,
+                void *pDoneCtx,
+                bool fConfirmed,
+                uint8_t port
+                );
+
+        /// \brief drop expired uplinks, and start the next queued uplink
+        ///     if the LMIC is idle.
+        void ProcessUplinkQueue();
+
+        /// \brief size of the deferred LogPrintf() buffer, in bytes.
+        static constexpr size_t kLogDeferredSize = ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE;
+        /// \brief size of a formatted LogPrintf() line, with its NUL.
+        static constexpr size_t kLogLineMax = 128;
+        /// \brief longest deferred message (format pointer and arguments);
+        ///     the same as a line, so most messages fit as they would
+        ///     if printed at once.
+        static constexpr size_t kLogRecordMax = kLogLineMax;
+        /// \brief deferred messages aren't printed if an LMIC job is due
+        ///     within this many milliseconds.
+        static constexpr uint32_t kLogGuardMs = 10;
+        /// \brief longest time loop() spends printing deferred messages.
+        static constexpr uint32_t kLogDrainLimitMs = 20;
+
+        static_assert(kLogDeferredSize == 0 || kLogDeferredSize >= kLogRecordMax + 2,
+                "ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE is too small");
+        static_assert(kLogDeferredSize <= 0xFFFF,
+                "ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE is too large");
+
+#if ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE != 0
+        /// \brief the deferred LogPrintf() records; see LogPrintf.cpp.
+        uint8_t m_LogBuffer[kLogDeferredSize];
+        /// \brief where the next record is put.
+        size_t m_iLogHead = 0;
+        /// \brief where the next record is taken.
+        size_t m_iLogTail = 0;
+#endif
+        /// \brief number of deferred messages lost.
+        uint32_t m_nLogLost = 0;
+        /// \brief value of \c m_nLogLost when last reported.
+        uint32_t m_nLogReported = 0;
+        /// \brief number of deferred messages printed truncated.
+        uint32_t m_nLogTruncated = 0;
+
+        /// \brief save a deferred message record; false if no room.
+        bool LogDeferredPut(const uint8_t *pRecord, size_t nRecord);
+
+        /// \brief print the oldest deferred message; false if none.
+        bool LogDeferredPrintOne();
+
+        /// \brief print deferred messages while the LMIC is idle.
+        void ProcessDeferredLog();
+
+        /// \brief complete all expired uplinks with \c fSuccess false.
+        void ExpireUplinkQueue();
+
+        /// \brief return the entry that should be sent next, or \c nullptr.
+        UplinkQueueEntry_t *GetNextUplink();
+
+        /// \brief remove an entry from the uplink queue and complete it.
+        void CompleteUplink(UplinkQueueEntry_t *pEntry, bool fSuccess);
+
+        /// \brief complete all queued uplinks with \c fSuccess false.
+        void FlushUplinkQueue();
+
+        /// \brief the LMIC completion callback for SendBuffer() messages.
+        static void SendBufferCb(void *pUserData, int fSuccess);
+
         ReceivePortBufferCbFn *m_pReceiveBufferFn;
         void *m_pReceiveBufferCtx;
 
         // this is a 'global' -- it gives us a way to bootstrap
         // back into C++ from the LMIC code.
-        static Arduino_LoRaWAN *pLoRaWAN;
+        static ARDUINO_LORAWAN_INSTANCE_STORAGE_ Arduino_LoRaWAN *pLoRaWAN;
 
         void StandardEventProcessor(
             uint32_t ev
@@ -915,6 +1575,11 @@ private:
         Listener m_RegisteredListeners[4];
         uint32_t m_nRegisteredListeners;
 
+#if ARDUINO_LORAWAN_CFG_PROBES
+        /// \brief the timing probes; see GetProbes().
+        Arduino_LoRaWAN_Probes m_Probes;
+#endif
+
         ///
         /// \brief Update the downlink frame counter.
         /// \param [in] newFCntDown the most recently observed downlink counter.
@@ -928,19 +1593,93 @@ private:
         ///
         void UpdateFCntDown(uint32_t newFCntDown)
                 {
-                if (this->m_savedSessionState.Header.Tag == kSessionStateTag_V1 &&
+                if (this->m_savedSessionState.Header.Tag == kSessionStateTag_V2 &&
                     this->m_savedSessionState.V1.FCntDown == newFCntDown)
                         return;
 
+                this->MarkSessionStateDirty(kSessionStateDirty_Counters);
                 this->SaveSessionState();
                 }
 
+        /// \brief radio-on time and charge, in the units of the LMIC events.
+        struct EnergyState_t
+                {
+                uint32_t nTransmissions;
+                uint32_t nJoinAttempts;
+                uint32_t nRxWindows;
+                uint32_t nDownlinks;
+                uint32_t nMessages;
+                uint32_t rxWindowUs;            ///< length of the last receive window.
+                uint64_t txAirtimeUs;
+                uint64_t rxOpenUs;
+                uint64_t txChargePc;            ///< picocoulombs: microamps times microseconds.
+                uint64_t rxChargePc;
+                uint64_t joinChargePc;
+                uint64_t messageRxChargePc;     ///< receive charge, other than for joins.
+                uint64_t messageChargePc;       ///< charge of the message in progress.
+                uint64_t lastMessageChargePc;
+                };
+
+        EnergyState_t m_Energy {};
+        const EnergyProfile_t *m_pEnergyProfile = &kDefaultEnergyProfile;
+
+        /// \brief update the energy counters for an LMIC event.
+        void UpdateEnergy(uint32_t ev);
+
+        /// \brief add receive time to the counters.
+        void AddRxEnergy(uint32_t tUs, bool fJoin);
+
+        /// \brief the transmit current for a power, from the profile.
+        uint32_t GetTxMicroamps(int8_t dBm) const;
+
         /// \brief Internal routine for saving state after join
         void SaveSessionInfo();
 
         /// \brief Internal routine to save session state as appropriate
         void SaveSessionState();
 
+        /// \brief what may have changed in the session state since it
+        ///     was last saved.
+        enum SessionStateDirty_t : uint8_t
+                {
+                /// the frame counts, link-integrity count, duty-cycle
+                /// timers and channel rotation: see BuildSessionStateCounters().
+                kSessionStateDirty_Counters = 1u << 0,
+                /// anything else: the state is rebuilt in full.
+                kSessionStateDirty_Config = 1u << 1,
+                };
+
+        /// \brief note that session-state fields may have changed.
+        void MarkSessionStateDirty(uint8_t flags)
+                {
+                this->m_SessionStateDirty |= flags;
+                }
+
+        /// \brief the SessionStateDirty_t flags since the last save.
+        uint8_t m_SessionStateDirty = kSessionStateDirty_Config;
+
+        ///
+        /// \brief apply FCnt journaling to a new session state.
+        ///
+        /// \param [inout] State the new session state; \c FCntUp is replaced
+        ///     by the current or new reservation.
+        ///
+        /// \return \c true if \p State must be saved; \c false if only
+        ///     counters and timers changed, and the reservation holds.
+        ///
+        bool ApplyFCntJournal(SessionState &State) const;
+
+        /// \brief number of uplinks between journal saves; zero for none.
+        uint32_t m_FCntJournalInterval = ARDUINO_LORAWAN_CFG_FCNT_JOURNAL_INTERVAL;
+
+        /// \brief max number of changed ranges for a delta save; more
+        ///     than this, and we do a full save.
+        static constexpr unsigned kSessionStateDeltaMaxRanges = 4;
+
+        /// \brief changed bytes separated by fewer than this many
+        ///     unchanged bytes are saved as one range.
+        static constexpr size_t kSessionStateDeltaMinGap = 8;
+
         ///
         /// \brief build session state object
         ///
@@ -948,6 +1687,22 @@ private:
         ///
         void BuildSessionState(SessionState &State) const;
 
+        ///
+        /// \brief update the fields of a session state that change on
+        ///     every uplink.
+        ///
+        /// \param [inout] State the session state to update.
+        /// \param [in] tNow the current os_getTime().
+        ///
+        void BuildSessionStateCounters(SessionState &State, uint32_t tNow) const;
+
+        ///
+        /// \brief return how long ago a session state was saved.
+        ///
+        /// \return age in os_getTime() ticks; zero if it can't be known.
+        ///
+        int32_t GetSessionStateAge(const SessionState &State) const;
+
         ///
         /// \brief apply session state data to current LMIC session
         ///
@@ -967,24 +1722,66 @@ private:
         SessionState m_savedSessionState { .Header = { .Tag = kSessionStateTag_Null, .Size = 0 } };
         };
 
+static_assert(
+        Arduino_LoRaWAN_NameTable::isIndexed(Arduino_LoRaWAN::kNetworkNames),
+        "Arduino_LoRaWAN::kNetworkNames is out of order"
+        );
+static_assert(
+        Arduino_LoRaWAN_NameTable::size(Arduino_LoRaWAN::kNetworkNames) ==
+                std::size_t(Arduino_LoRaWAN::NetworkID_t::Generic) + 1,
+        "Arduino_LoRaWAN::kNetworkNames needs an entry for every NetworkID_t"
+        );
+
 /****************************************************************************\
 |
-|       Eventually this will get removed for "free" builds. But if you build
-|       in the Arduino environment, this is going to get hard to override.
+|       Logging. ARDUINO_LORAWAN_PRINTF(LogBasic, ...), (LogErrors, ...) and
+|       (LogVerbose, ...) each expand through a per-category macro. If the
+|       category is disabled at compile time, the call (with its format
+|       string) disappears; if enabled, the runtime debug mask is checked.
+|       If tokenized, only a hash of the format is kept.
 |
 \****************************************************************************/
 
-#if MCCIADK_DEBUG || 1
-# define ARDUINO_LORAWAN_PRINTF(a_check, a_fmt, ...)    \
+#define ARDUINO_LORAWAN_PRINTF(a_check, a_fmt, ...)     \
+        ARDUINO_LORAWAN_PRINTF_##a_check(a_check, a_fmt, ## __VA_ARGS__)
+
+#if ARDUINO_LORAWAN_CFG_LOG_TOKENIZED
+# define ARDUINO_LORAWAN_PRINTF_ON_(a_check, a_fmt, ...)                        \
+    do  {                                                                       \
+        if (this->a_check())                                                    \
+                {                                                               \
+                this->LogToken(ARDUINO_LORAWAN_LOG_TOKEN(a_fmt), ## __VA_ARGS__); \
+                }                                                               \
+        } while (0)
+#else
+# define ARDUINO_LORAWAN_PRINTF_ON_(a_check, a_fmt, ...) \
     do  {                                               \
         if (this->a_check())                            \
                 {                                       \
                 this->LogPrintf(a_fmt, ## __VA_ARGS__); \
                 }                                       \
         } while (0)
-#else
-# define ARDUINO_LORAWAN_PRINTF(a_check, a_fmt, ...)    \
+#endif
+
+#define ARDUINO_LORAWAN_PRINTF_OFF_(a_check, a_fmt, ...) \
     do { ; } while (0)
+
+#if ARDUINO_LORAWAN_CFG_LOG_BASIC
+# define ARDUINO_LORAWAN_PRINTF_LogBasic        ARDUINO_LORAWAN_PRINTF_ON_
+#else
+# define ARDUINO_LORAWAN_PRINTF_LogBasic        ARDUINO_LORAWAN_PRINTF_OFF_
+#endif
+
+#if ARDUINO_LORAWAN_CFG_LOG_ERRORS
+# define ARDUINO_LORAWAN_PRINTF_LogErrors       ARDUINO_LORAWAN_PRINTF_ON_
+#else
+# define ARDUINO_LORAWAN_PRINTF_LogErrors       ARDUINO_LORAWAN_PRINTF_OFF_
+#endif
+
+#if ARDUINO_LORAWAN_CFG_LOG_VERBOSE
+# define ARDUINO_LORAWAN_PRINTF_LogVerbose      ARDUINO_LORAWAN_PRINTF_ON_
+#else
+# define ARDUINO_LORAWAN_PRINTF_LogVerbose      ARDUINO_LORAWAN_PRINTF_OFF_
 #endif
 
 /**** end of Arduino_LoRaWAN.h ****/
@@ -25,27 +25,292 @@ Author:
 #pragma once
 
 #include <Arduino_LoRaWAN.h>
+#include <Arduino_LoRaWAN_EventLogFormat.h>
 #include <cstdint>
 
+/****************************************************************************\
+|
+|	Event log sinks
+|
+\****************************************************************************/
+
+///
+/// \brief abstract destination for binary event log records.
+///
+/// \details
+///     If a sink is attached to an event log, \c loop() writes each entry
+///     to the sink as an Arduino_LoRaWAN_EventRecord, instead of printing
+///     it to \c Serial. Use the \c eventlog-decode tool in \c extras to
+///     turn the records back into text.
+///
+class Arduino_LoRaWAN::cEventLogSink
+    {
+public:
+    /// \brief write one complete record; return \c false if it was discarded.
+    virtual bool write(const std::uint8_t *pRecord, std::size_t nRecord) = 0;
+
+    ///
+    /// \brief return \c true if records are to be written as they are
+    ///     logged, rather than from \c loop().
+    ///
+    /// \details
+    ///     An immediate sink's write() is called from logEvent(), perhaps
+    ///     at interrupt level, so it must be quick and must not block.
+    ///     The default is \c false.
+    ///
+    virtual bool isImmediate() const { return false; }
+    };
+
+///
+/// \brief a sink that writes records to a \c Print object, such as a UART.
+///
+class Arduino_LoRaWAN::cEventLogPrintSink : public Arduino_LoRaWAN::cEventLogSink
+    {
+public:
+    cEventLogPrintSink(Print &print)
+        : m_pPrint(&print)
+        {}
+
+    virtual bool write(const std::uint8_t *pRecord, std::size_t nRecord) override
+        {
+        return this->m_pPrint->write(pRecord, nRecord) == nRecord;
+        }
+
+private:
+    Print *m_pPrint;            ///< where the records go
+    };
+
+///
+/// \brief a sink that collects records in a caller-supplied RAM buffer.
+///
+/// \details
+///     Records that don't fit are discarded, so the buffer always holds
+///     whole records. Call \c clear() after the contents are sent
+///     elsewhere.
+///
+class Arduino_LoRaWAN::cEventLogRamSink : public Arduino_LoRaWAN::cEventLogSink
+    {
+public:
+    cEventLogRamSink(std::uint8_t *pBuffer, std::size_t nBuffer)
+        : m_pBuffer(pBuffer)
+        , m_nBuffer(nBuffer)
+        {}
+
+    virtual bool write(const std::uint8_t *pRecord, std::size_t nRecord) override
+        {
+        if (nRecord > this->m_nBuffer - this->m_nUsed)
+            return false;
+
+        std::memcpy(this->m_pBuffer + this->m_nUsed, pRecord, nRecord);
+        this->m_nUsed += nRecord;
+        return true;
+        }
+
+    /// \brief return a pointer to the records.
+    const std::uint8_t *getData() const { return this->m_pBuffer; }
+
+    /// \brief return the number of bytes of records.
+    std::size_t getSize() const { return this->m_nUsed; }
+
+    /// \brief discard the records.
+    void clear() { this->m_nUsed = 0; }
+
+private:
+    std::uint8_t *m_pBuffer;    ///< the buffer
+    std::size_t m_nBuffer;      ///< its size
+    std::size_t m_nUsed = 0;    ///< bytes used
+    };
+
+///
+/// \brief put a variable in RAM that isn't cleared at reset.
+///
+/// \details
+///     Use this on the buffer for a cEventLogRetainedSink. On ARM, the
+///     variable goes in the \c .noinit section; check that your board's
+///     linker script keeps that section in RAM, or define this macro
+///     yourself.
+///
+#ifndef ARDUINO_LORAWAN_RETAINED
+# if defined(ARDUINO_ARCH_ESP32)
+#  define ARDUINO_LORAWAN_RETAINED      __NOINIT_ATTR
+# elif defined(__arm__)
+#  define ARDUINO_LORAWAN_RETAINED      __attribute__((__section__(".noinit")))
+# else
+#  define ARDUINO_LORAWAN_RETAINED      /* nothing: not retained */
+# endif
+#endif
+
+///
+/// \brief a sink that keeps the most recent records in RAM that survives
+///     a reset.
+///
+/// \details
+///     The buffer (declared with ARDUINO_LORAWAN_RETAINED) holds a small
+///     header and a ring of whole records; when it fills, the oldest
+///     records are discarded. begin() checks the header: if it's good,
+///     the records from before the reset are kept, the generation count
+///     goes up, and a Code_t::kBoot record marks the restart. So after a
+///     watchdog reset, the log shows what led up to it. Use dump() or
+///     read() to send the log somewhere; eventlog-decode shows it as
+///     text.
+///
+///     The buffer must stay the same size from one build to the next,
+///     or begin() discards it.
+///
+///     This is an immediate sink: each record is written when it's
+///     logged, not when loop() gets to it, so the events just before a
+///     hang are kept even if loop() never runs again.
+///
+class Arduino_LoRaWAN::cEventLogRetainedSink : public Arduino_LoRaWAN::cEventLogSink
+    {
+public:
+    cEventLogRetainedSink(std::uint8_t *pBuffer, std::size_t nBuffer)
+        : m_pBuffer(pBuffer)
+        , m_nBuffer(nBuffer)
+        {}
+
+    ///
+    /// \brief recover or initialize the retained log; call from \c setup().
+    ///
+    /// \return \c true if records from before the reset were recovered.
+    ///
+    bool begin();
+
+    /// \brief discard the records (the generation is kept).
+    void clear();
+
+    virtual bool write(const std::uint8_t *pRecord, std::size_t nRecord) override;
+
+    /// \brief records are written from logEvent(), to survive a hang.
+    virtual bool isImmediate() const override { return true; }
+
+    /// \brief return the generation: the number of resets survived.
+    std::uint32_t getGeneration() const;
+
+    /// \brief return the number of bytes of records.
+    std::size_t getSize() const;
+
+    ///
+    /// \brief copy records out of the ring, oldest first.
+    ///
+    /// \param [in] offset starting offset, from 0 to getSize().
+    ///
+    /// \return the number of bytes copied.
+    ///
+    std::size_t read(std::size_t offset, std::uint8_t *pData, std::size_t nData) const;
+
+    /// \brief write all the records to \p print, oldest first.
+    void dump(Print &print) const;
+
+private:
+    /// \brief the header at the start of the buffer.
+    struct Header_t
+        {
+        std::uint32_t magic;            ///< kMagic
+        std::uint32_t size;             ///< size of the ring
+        std::uint32_t generation;       ///< resets survived
+        std::uint32_t first;            ///< offset of the oldest record in the ring
+        std::uint32_t used;             ///< bytes of records in the ring
+        };
+
+    static constexpr std::uint32_t kMagic = 0x474C5252u;  // 'RRLG'
+
+    std::uint8_t *m_pBuffer;    ///< the buffer: header, then ring
+    std::size_t m_nBuffer;      ///< size of the buffer
+
+    // the header isn't necessarily aligned, so it's copied in and out.
+    Header_t getHeader() const;
+    void putHeader(const Header_t &header);
+
+    /// \brief return a pointer to the ring.
+    std::uint8_t *getRing() const { return this->m_pBuffer + sizeof(Header_t); }
+
+    /// \brief discard the oldest record.
+    void dropOldest(Header_t &header);
+    };
+
 /****************************************************************************\
 |
 |	The event log object
 |
 \****************************************************************************/
 
-class Arduino_LoRaWAN::cEventLog
+///
+/// \brief a queue of events, printed from \c loop().
+///
+/// \details
+///     logEvent() is lock-free, allocation-free and takes bounded time, so
+///     it can be called from an interrupt handler (for example, to
+///     timestamp radio DIO edges). The queue is a ring of fixed nodes; the
+///     producer publishes a node with a release store and the consumer
+///     (loop()) picks it up with an acquire load, so the node's contents
+///     are always complete when printed.
+///
+///     By default there must be only one producer (one task, or one
+///     interrupt level, but not both). If
+///     \c ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER is non-zero, any
+///     number of tasks and interrupt handlers may call logEvent()
+///     concurrently; producers then claim nodes with compare-and-swap, so
+///     this needs a CPU with atomic read-modify-write (Cortex-M3 and
+///     later, ESP32; not Cortex-M0/M0+).
+///
+///     This class has no storage of its own; use cSizedEventLog<n> or
+///     cEventLog.
+///
+class Arduino_LoRaWAN::cEventLogBase
     {
 public:
-    cEventLog() {};
-    ~cEventLog() {};
+    /// \brief what to do with a new event when the queue is full.
+    enum class OverflowPolicy_t : std::uint8_t
+        {
+        kDropNewest,            ///< discard the new event (the default).
+        kOverwriteOldest,       ///< discard the oldest queued event.
+        };
+
+    /// \brief the kind of an event, for binary sinks.
+    using EventCode_t = Arduino_LoRaWAN_EventRecord::Code_t;
+
+    /// \brief the typed event for the start of a transmission.
+    using TxStartEvent = Arduino_LoRaWAN_TxStartEvent;
+
+    class EventNode_t;
+
+protected:
+    /// \brief the constructor; the queue storage is supplied by the derived class.
+    cEventLogBase(EventNode_t *pQueue, unsigned *pSeq, unsigned nCapacity);
+
+public:
+    ~cEventLogBase() {};
+
+    // the queue storage belongs to the derived object; don't copy.
+    cEventLogBase(const cEventLogBase &) = delete;
+    cEventLogBase &operator=(const cEventLogBase &) = delete;
 
     /// \brief do EventLog processing for Arduino \c setup().
     void setup();
 
+    ///
     /// \brief do EventLog processig for Arduino \c loop().
+    ///
+    /// \details
+    ///     Entries are output for as long as the LMIC has nothing to do:
+    ///     before each entry, loop() checks that the LMIC has no job due
+    ///     within the estimated time to output an entry (plus a guard
+    ///     time). The estimate is the measured time of recent entries; it
+    ///     rises at once when an entry is slow, and falls slowly. A call
+    ///     stops starting new entries once it has run for the drain time
+    ///     limit.
+    ///
     void loop();
 
-    class EventNode_t;
+    /// \brief set the most time a single call to loop() may spend, in milliseconds.
+    void setDrainTimeLimit(std::uint32_t ms) { this->m_drainTimeLimitMs = ms; }
+
+    /// \brief return the most time a single call to loop() may spend, in milliseconds.
+    std::uint32_t getDrainTimeLimit() const { return this->m_drainTimeLimitMs; }
+
+    /// \brief return the estimated time to output one entry, in microseconds.
+    std::uint32_t getEntryCostEstimate() const;
 
     /// \brief abstract type for logging callbacks.
     typedef void (LogCallback_t)(const EventNode_t *);
@@ -57,16 +322,25 @@ public:
     ///     so the callback functions have to use the methods to get at the
     ///     contents of this object.
     ///
+    ///     The node is no bigger than it was before typed events: a typed
+    ///     event keeps its schema where a callback event keeps its client
+    ///     data, and its code comes from the schema.
+    ///
     class EventNode_t
         {
-        // allow cEventLog methods access to private fields.
-        friend class cEventLog;
+        // allow cEventLogBase methods access to private fields.
+        friend class cEventLogBase;
 
     private:
         std::uint32_t time;             ///< timestamp for event -- really an ostime_t, but
                                         ///  don't want to have the LMIC in scope.
-        LogCallback_t *pCallBack;       ///< callback function for delogging.
-        void *pClientData;              ///< client data for callback function
+        LogCallback_t *pCallBack;       ///< callback function for delogging;
+                                        ///  nullptr for typed events.
+        union
+            {
+            void *pClientData;          ///< client data for callback function
+            const Arduino_LoRaWAN_EventSchema *pSchema; ///< schema of a typed event
+            };
         std::uintptr_t data[3];         ///< arbitrary data
 
     public:
@@ -81,17 +355,105 @@ public:
 
         /// \brief get a given data element from event node.
         std::uintptr_t getData(unsigned i) const { return this->data[i]; }
+
+        /// \brief get the kind of event.
+        EventCode_t getCode() const
+            {
+            return this->pCallBack == nullptr ? this->pSchema->code : EventCode_t::kCustom;
+            }
+
+        /// \brief get the schema of a typed event, or \c nullptr.
+        const Arduino_LoRaWAN_EventSchema *getSchema() const
+            {
+            return this->pCallBack == nullptr ? this->pSchema : nullptr;
+            }
         };
 
     ///
     /// \brief make a standard entry in the event log.
     ///
+    /// \details
+    ///     This may be called from an interrupt handler. It never blocks;
+    ///     if the queue is full, the event is dropped. If the sink is
+    ///     immediate (see cEventLogSink::isImmediate()), the entry is
+    ///     written to the sink at once, and isn't queued. Binary sinks
+    ///     get the entry as EventCode_t::kCustom; use a typed event if
+    ///     the decoder is to format it.
+    ///
     /// \return
     ///     If this function successfully allocates a log entry, returns a pointer to the
-    ///     entry. Otherwise returns \c nullptr.
+    ///     entry. Otherwise returns \c nullptr. The entry belongs to loop() once
+    ///     it is returned, so the caller must not change it, and should only
+    ///     compare the result with \c nullptr. (When the entry goes
+    ///     straight to an immediate sink, the result isn't \c nullptr, but
+    ///     it doesn't point to the entry.)
     ///
     EventNode_t *logEvent(void *pClientData, std::uintptr_t arg1, std::uintptr_t arg2, std::uintptr_t arg3, LogCallback_t *pFn);
 
+    ///
+    /// \brief make a typed entry in the event log.
+    ///
+    /// \param TEvent the event type, derived from Arduino_LoRaWAN_EventLayout.
+    /// \param args the field values, in schema order.
+    ///
+    /// \details
+    ///     The values are packed by the event's layout; loop() shows the
+    ///     entry using the event's schema, so no callback is needed, and
+    ///     the host decoder can show it too. For example:
+    ///
+    ///         myEventLog.logEvent<cEventLog::TxStartEvent>(LMIC.txChnl, LMIC.rps);
+    ///
+    template <class TEvent, typename... TArgs>
+    EventNode_t *logEvent(TArgs... args)
+        {
+        std::uint32_t data[3];
+
+        TEvent::pack(data, args...);
+        return this->logTypedEvent(TEvent::getSchema(), data);
+        }
+
+    ///
+    /// \brief send entries to a binary sink instead of printing them.
+    ///
+    /// \param [in] pSink the sink, or \c nullptr to go back to printing
+    ///     to \c Serial.
+    ///
+    /// \details
+    ///     With an immediate sink, logEvent() and loop() take turns at
+    ///     the sink. In a single-producer build, loop() does that by
+    ///     disabling interrupts while it writes, so the producer must run
+    ///     on the same CPU as loop(). With
+    ///     \c ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER, they use a lock;
+    ///     a producer that finds it taken queues the entry for loop().
+    ///
+    void setSink(cEventLogSink *pSink) { this->m_pSink = pSink; }
+
+    /// \brief return the binary sink, or \c nullptr if entries are printed.
+    cEventLogSink *getSink() const { return this->m_pSink; }
+
+    ///
+    /// \brief set the policy for a full queue.
+    ///
+    /// \return \c false if the policy isn't supported. kOverwriteOldest
+    ///     can't be used with \c ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER.
+    ///
+    bool setOverflowPolicy(OverflowPolicy_t policy);
+
+    /// \brief return the policy for a full queue.
+    OverflowPolicy_t getOverflowPolicy() const { return this->m_policy; }
+
+    /// \brief return the number of entries the queue can hold.
+    unsigned getCapacity() const { return this->m_mask + 1; }
+
+    /// \brief return the number of events lost because the queue was full.
+    std::uint32_t getDroppedCount() const;
+
+    /// \brief return the largest number of entries that have been queued at once.
+    unsigned getHighWaterMark() const
+        {
+        return __atomic_load_n(&this->m_highWater, __ATOMIC_RELAXED);
+        }
+
     /* convenience routines */
 
     /// \brief print a channel number
@@ -122,12 +484,100 @@ public:
     void printFreq(std::uint32_t freq) const;
 
 private:
-    unsigned m_head;                ///< index of first node in queue; queue is empty if head == tail
-    unsigned m_tail;                ///< index of last node in queue
-    EventNode_t m_queue[8];         ///< queue of entries
+    // m_head and m_tail are free-running counts; the node for count n is
+    // m_pQueue[n & m_mask]. Only loop() writes m_head.
+    EventNode_t *m_pQueue;          ///< queue of entries
+    unsigned *m_pSeq;               ///< per-node sequence, for multiple producers:
+                                    ///  i + n * capacity when free for count i,
+                                    ///  i + 1 when published.
+    unsigned m_mask;                ///< capacity - 1
+    unsigned m_head = 0;            ///< number of nodes removed from the queue
+    unsigned m_tail = 0;            ///< number of nodes claimed by producers
+    unsigned m_highWater = 0;       ///< most nodes in the queue at once
+    std::uint32_t m_nDropped = 0;   ///< new events discarded (producers)
+    std::uint32_t m_nOverwritten = 0;   ///< old events overwritten (loop())
+    std::uint32_t m_nReported = 0;  ///< losses already printed (loop())
+    OverflowPolicy_t m_policy = OverflowPolicy_t::kDropNewest;  ///< what to do when full
+    cEventLogSink *m_pSink = nullptr;   ///< binary sink, if any
+#if ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    bool m_fSinkBusy = false;       ///< an immediate sink is being written.
+#endif
+
+    /// \brief default limit on the time spent in one loop() call.
+    static constexpr std::uint32_t kDrainTimeLimitMs = 20;
+    /// \brief starting estimate of the time to print an entry.
+    static constexpr std::uint32_t kInitialCostMs = 20;
+    /// \brief extra time kept free before an LMIC job.
+    static constexpr std::uint32_t kGuardMs = 10;
+
+    std::uint32_t m_drainTimeLimitMs = kDrainTimeLimitMs;   ///< see setDrainTimeLimit()
+    std::int32_t m_costEstimate = -1;   ///< estimated ticks per entry; -1 until first used
+
+    /// \brief queue a typed event with packed data.
+    EventNode_t *logTypedEvent(const Arduino_LoRaWAN_EventSchema &schema, const std::uint32_t data[3]);
+
+    /// \brief claim a node for a new event; returns its count, or false if full.
+    bool claimNode(unsigned &count);
+
+    /// \brief make a claimed node visible to loop().
+    void publishNode(unsigned count);
+
+    /// \brief record the queue depth for the high-water mark.
+    void updateHighWater(unsigned depth);
+
+    /// \brief update the cost estimate with the measured ticks for one entry.
+    void updateCostEstimate(std::int32_t cost);
+
+    /// \brief print a line for any events lost since the last call.
+    void reportDrops();
+
+    /// \brief encode an entry and write it to the sink.
+    void writeRecord(EventCode_t code, std::uint32_t time, std::uint32_t data0, std::uint32_t data1, std::uint32_t data2);
+
+    /// \brief from a producer: if the sink is immediate, write an entry
+    ///     to it; return \c true if it was written.
+    bool writeImmediate(EventCode_t code, std::uint32_t time, std::uint32_t data0, std::uint32_t data1, std::uint32_t data2);
+
+    /// \brief from loop(): write an entry to the sink, taking turns with
+    ///     writeImmediate().
+    void writeRecordFromLoop(EventCode_t code, std::uint32_t time, std::uint32_t data0, std::uint32_t data1, std::uint32_t data2);
 
     /// \brief called to despool and print a single event.
     bool processSingleEvent();
     };
 
+///
+/// \brief an event log with room for \p a_nCapacity entries.
+///
+/// \param a_nCapacity the number of entries; must be a power of two.
+///
+template <unsigned a_nCapacity>
+class Arduino_LoRaWAN::cSizedEventLog : public Arduino_LoRaWAN::cEventLogBase
+    {
+    static_assert(a_nCapacity != 0 && (a_nCapacity & (a_nCapacity - 1)) == 0,
+                  "event log capacity must be a power of two");
+
+public:
+    cSizedEventLog()
+        : cEventLogBase(m_queue, m_seqBuffer, a_nCapacity)
+        {}
+
+private:
+    EventNode_t m_queue[a_nCapacity];   ///< queue of entries
+#if ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    unsigned m_seqBuffer[a_nCapacity];  ///< per-node sequence numbers
+#else
+    static constexpr unsigned *m_seqBuffer = nullptr;
+#endif
+    };
+
+///
+/// \brief the standard event log, with room for
+///     \c ARDUINO_LORAWAN_CFG_EVENTLOG_CAPACITY entries.
+///
+class Arduino_LoRaWAN::cEventLog
+    : public Arduino_LoRaWAN::cSizedEventLog<ARDUINO_LORAWAN_CFG_EVENTLOG_CAPACITY>
+    {
+    };
+
 #endif /* _Arduino_LoRaWAN_EventLog_h_ */
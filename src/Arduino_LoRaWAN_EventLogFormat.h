@@ -0,0 +1,399 @@
+/*
+
+Module:	Arduino_LoRaWAN_EventLogFormat.h
+
+Function:
+	The binary record format of the Arduino_LoRaWAN event log.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _Arduino_LoRaWAN_EventLogFormat_h_
+#define _Arduino_LoRaWAN_EventLogFormat_h_	/* prevent multiple includes */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// This header has no other dependencies, so host tools can use it to
+// decode logs.
+
+///
+/// \brief one binary event log record.
+///
+/// \details
+///     On the wire, a record is:
+///
+///     | Bytes | Contents
+///     |-------|---------
+///     | 1     | kSync (0xE5)
+///     | 1     | the record code (a Code_t)
+///     | 4     | the timestamp, in LMIC ticks, little-endian
+///     | 1..5  | data[0], as an unsigned LEB128 varint
+///     | 1..5  | data[1], likewise
+///     | 1..5  | data[2], likewise
+///     | 1     | check byte: the sum of all the bytes of the record is zero
+///
+///     A reader that loses sync skips bytes until it finds a kSync that
+///     starts a record with a good check byte.
+///
+struct Arduino_LoRaWAN_EventRecord
+    {
+    /// \brief the kinds of record.
+    enum class Code_t : std::uint8_t
+        {
+        kCustom = 0,            ///< formatted by a callback; decoders show the raw data.
+        kTxStart = 1,           ///< an Arduino_LoRaWAN_TxStartEvent.
+        kUserBase = 0x80,       ///< first code for application event types.
+        kBoot = 0xFE,           ///< a retained log was started (data[1] == 0) or
+                                ///  recovered after a reset (data[1] == 1); data[0]
+                                ///  is the generation.
+        kLost = 0xFF,           ///< data[0] events were lost because the log was full.
+        };
+
+    static constexpr std::uint8_t kSync = 0xE5;        ///< first byte of every record
+    static constexpr std::size_t kMinSize = 1 + 1 + 4 + 3 * 1 + 1; ///< smallest record
+    static constexpr std::size_t kMaxSize = 1 + 1 + 4 + 3 * 5 + 1; ///< largest record
+
+    Code_t code;                ///< the kind of record
+    std::uint32_t time;         ///< timestamp (LMIC ticks)
+    std::uint32_t data[3];      ///< the data
+
+    ///
+    /// \brief encode the record.
+    ///
+    /// \param [out] pBuffer buffer of at least kMaxSize bytes.
+    ///
+    /// \return the number of bytes used.
+    ///
+    std::size_t encode(std::uint8_t *pBuffer) const
+        {
+        std::uint8_t *p = pBuffer;
+
+        *p++ = kSync;
+        *p++ = std::uint8_t(this->code);
+        for (unsigned i = 0; i < 4; ++i)
+            *p++ = std::uint8_t(this->time >> (8 * i));
+
+        for (auto v : this->data)
+            {
+            while (v >= 0x80)
+                {
+                *p++ = std::uint8_t(v | 0x80);
+                v >>= 7;
+                }
+            *p++ = std::uint8_t(v);
+            }
+
+        std::uint8_t sum = 0;
+        for (auto q = pBuffer; q < p; ++q)
+            sum += *q;
+
+        *p++ = std::uint8_t(-sum);
+        return p - pBuffer;
+        }
+
+    ///
+    /// \brief decode a record.
+    ///
+    /// \param [in] pBuffer the data; pBuffer[0] should be kSync.
+    /// \param [in] nBuffer the number of bytes available.
+    ///
+    /// \return the number of bytes in the record if it's good; 0 if more
+    ///     data is needed; -1 if this isn't a good record (the caller
+    ///     should skip a byte and try again).
+    ///
+    int decode(const std::uint8_t *pBuffer, std::size_t nBuffer)
+        {
+        std::size_t i = 0;
+
+        if (nBuffer < 1)
+            return 0;
+        if (pBuffer[i++] != kSync)
+            return -1;
+        if (nBuffer < kMinSize)
+            return 0;
+
+        this->code = Code_t(pBuffer[i++]);
+        this->time = 0;
+        for (unsigned j = 0; j < 4; ++j)
+            this->time |= std::uint32_t(pBuffer[i++]) << (8 * j);
+
+        for (auto &v : this->data)
+            {
+            v = 0;
+            for (unsigned shift = 0; ; shift += 7)
+                {
+                if (i >= nBuffer)
+                    return 0;
+                if (shift > 28)
+                    return -1;
+
+                auto const b = pBuffer[i++];
+                v |= std::uint32_t(b & 0x7F) << shift;
+                if ((b & 0x80) == 0)
+                    break;
+                }
+            }
+
+        if (i >= nBuffer)
+            return 0;
+
+        std::uint8_t sum = 0;
+        for (std::size_t j = 0; j <= i; ++j)
+            sum += pBuffer[j];
+
+        return sum == 0 ? int(i + 1) : -1;
+        }
+    };
+
+/****************************************************************************\
+|
+|	Typed events
+|
+\****************************************************************************/
+
+///
+/// \brief one field of a typed event.
+///
+struct Arduino_LoRaWAN_EventField
+    {
+    /// \brief how to show the field as text.
+    enum class Format_t : std::uint8_t
+        {
+        kDecimal,               ///< unsigned decimal
+        kSigned,                ///< signed decimal (sign-extended from the width)
+        kHex,                   ///< 0x and hex digits
+        kRps,                   ///< an LMIC rps_t, as printed by cEventLog::printRps()
+        };
+
+    const char *pName;          ///< the field name
+    std::uint8_t width;         ///< width in bits, 1 to 32
+    Format_t format;            ///< how to show it
+    };
+
+///
+/// \brief the description of a typed event: its code, label and fields.
+///
+/// \details
+///     Fields are packed LSB first, in order, into data[0] and data[1]
+///     (64 bits in all). Devices and host tools use the same schema to
+///     show an event as text, so the two always agree.
+///
+struct Arduino_LoRaWAN_EventSchema
+    {
+    Arduino_LoRaWAN_EventRecord::Code_t code;   ///< the record code
+    const char *pLabel;                         ///< label printed first
+    unsigned nFields;                           ///< number of fields
+    const Arduino_LoRaWAN_EventField *pFields;  ///< the fields
+
+    /// \brief extract field \p iField from packed data.
+    std::uint32_t getField(const std::uint32_t data[3], unsigned iField) const
+        {
+        unsigned shift = 0;
+
+        for (unsigned i = 0; i < iField; ++i)
+            shift += this->pFields[i].width;
+
+        std::uint64_t const packed = data[0] | (std::uint64_t(data[1]) << 32);
+        auto const width = this->pFields[iField].width;
+
+        return std::uint32_t(packed >> shift) & (0xFFFFFFFFu >> (32 - width));
+        }
+
+    ///
+    /// \brief show the event as text.
+    ///
+    /// \details
+    ///     The text is " label:" followed by " name=value" for each
+    ///     field, matching the format of the cEventLog print routines.
+    ///
+    /// \return the length of the text (which is truncated to fit).
+    ///
+    std::size_t format(const std::uint32_t data[3], char *pBuffer, std::size_t nBuffer) const
+        {
+        std::size_t n = 0;
+
+        if (nBuffer == 0)
+            return 0;
+
+        pBuffer[0] = '\0';
+        n = append(nBuffer, n, std::snprintf(pBuffer + n, nBuffer - n, " %s:", this->pLabel));
+
+        for (unsigned i = 0; i < this->nFields; ++i)
+            {
+            auto const &field = this->pFields[i];
+            auto const v = this->getField(data, i);
+            auto const p = pBuffer + n;
+            auto const nLeft = nBuffer - n;
+            int nWritten;
+
+            switch (field.format)
+                {
+            case Arduino_LoRaWAN_EventField::Format_t::kSigned:
+                {
+                auto const sign = std::uint32_t(1) << (field.width - 1);
+                nWritten = std::snprintf(p, nLeft, " %s=%ld", field.pName, long(std::int32_t((v ^ sign) - sign)));
+                break;
+                }
+
+            case Arduino_LoRaWAN_EventField::Format_t::kHex:
+                nWritten = std::snprintf(p, nLeft, " %s=0x%0*lX", field.pName, int((field.width + 3) / 4), (unsigned long) v);
+                break;
+
+            case Arduino_LoRaWAN_EventField::Format_t::kRps:
+                {
+                static const char * const sf[] = { "FSK", "SF7", "SF8", "SF9", "SF10", "SF11", "SF12", "SFrfu" };
+                static const char * const bw[] = { "BW125", "BW250", "BW500", "BWrfu" };
+                static const char * const cr[] = { "CR 4/5", "CR 4/6", "CR 4/7", "CR 4/8" };
+
+                nWritten = std::snprintf(p, nLeft, " %s=0x%02X (%s %s %s %s IH=%u)",
+                    field.pName,
+                    unsigned(v & 0xFF),
+                    sf[v & 7], bw[(v >> 3) & 3], cr[(v >> 5) & 3],
+                    (v & 0x80) ? "NoCrc" : "Crc",
+                    unsigned((v >> 8) & 0xFF)
+                    );
+                break;
+                }
+
+            default:
+                nWritten = std::snprintf(p, nLeft, " %s=%lu", field.pName, (unsigned long) v);
+                break;
+                }
+
+            n = append(nBuffer, n, nWritten);
+            }
+
+        return n;
+        }
+
+private:
+    // account for snprintf() output, which may have been truncated.
+    static std::size_t append(std::size_t nBuffer, std::size_t n, int nWritten)
+        {
+        if (nWritten < 0)
+            return n;
+        n += std::size_t(nWritten);
+        return n < nBuffer ? n : nBuffer - 1;
+        }
+    };
+
+///
+/// \brief compile-time layout of a typed event.
+///
+/// \param a_code the record code.
+/// \param a_widths the width of each field, in bits.
+///
+/// \details
+///     An event type derives from this and adds a \c getSchema() that
+///     gives the label and the field names and formats, for example:
+///
+///         struct MyEvent : Arduino_LoRaWAN_EventLayout<MyCode, 8, 16>
+///             {
+///             static const Arduino_LoRaWAN_EventSchema &getSchema()
+///                 {
+///                 static const Arduino_LoRaWAN_EventField fields[] =
+///                     {
+///                     { "a", getWidth(0), Arduino_LoRaWAN_EventField::Format_t::kDecimal },
+///                     { "b", getWidth(1), Arduino_LoRaWAN_EventField::Format_t::kHex },
+///                     };
+///                 static_assert(sizeof(fields) / sizeof(fields[0]) == kNumFields, "field count");
+///                 static const Arduino_LoRaWAN_EventSchema schema = { kCode, "MY", kNumFields, fields };
+///                 return schema;
+///                 }
+///             };
+///
+///     Then \c myEventLog.logEvent<MyEvent>(a, b) records one.
+///
+template <Arduino_LoRaWAN_EventRecord::Code_t a_code, unsigned... a_widths>
+struct Arduino_LoRaWAN_EventLayout
+    {
+private:
+    static constexpr unsigned sum() { return 0; }
+    template <typename... T>
+    static constexpr unsigned sum(unsigned first, T... rest) { return first + sum(rest...); }
+
+    static constexpr bool allValid() { return true; }
+    template <typename... T>
+    static constexpr bool allValid(unsigned first, T... rest) { return first >= 1 && first <= 32 && allValid(rest...); }
+
+    static constexpr std::uint8_t kWidths[sizeof...(a_widths)] = { std::uint8_t(a_widths)... };
+
+public:
+    static constexpr Arduino_LoRaWAN_EventRecord::Code_t kCode = a_code;    ///< the record code
+    static constexpr unsigned kNumFields = sizeof...(a_widths);             ///< number of fields
+    static constexpr unsigned kTotalWidth = sum(a_widths...);               ///< total bits
+
+    static_assert(kNumFields > 0, "an event needs at least one field");
+    static_assert(allValid(a_widths...), "field widths must be 1 to 32 bits");
+    static_assert(kTotalWidth <= 64, "an event's fields must fit in 64 bits");
+
+    /// \brief return the width of a field.
+    static constexpr std::uint8_t getWidth(unsigned i) { return kWidths[i]; }
+
+    ///
+    /// \brief pack field values into record data.
+    ///
+    /// \details
+    ///     Each value is truncated to its field width. The loop has
+    ///     constant bounds and shifts, so the compiler reduces it to a
+    ///     few instructions; it's cheap enough for interrupt handlers.
+    ///
+    template <typename... TArgs>
+    static void pack(std::uint32_t data[3], TArgs... args)
+        {
+        static_assert(sizeof...(TArgs) == kNumFields, "wrong number of values for this event");
+
+        std::uint32_t const v[] = { std::uint32_t(args)... };
+        std::uint64_t packed = 0;
+        unsigned shift = 0;
+
+        for (unsigned i = 0; i < kNumFields; ++i)
+            {
+            packed |= std::uint64_t(v[i] & (0xFFFFFFFFu >> (32 - kWidths[i]))) << shift;
+            shift += kWidths[i];
+            }
+
+        data[0] = std::uint32_t(packed);
+        data[1] = std::uint32_t(packed >> 32);
+        data[2] = 0;
+        }
+    };
+
+template <Arduino_LoRaWAN_EventRecord::Code_t a_code, unsigned... a_widths>
+constexpr std::uint8_t Arduino_LoRaWAN_EventLayout<a_code, a_widths...>::kWidths[sizeof...(a_widths)];
+
+///
+/// \brief the start of a transmission: the channel and the rps_t.
+///
+struct Arduino_LoRaWAN_TxStartEvent
+    : Arduino_LoRaWAN_EventLayout<Arduino_LoRaWAN_EventRecord::Code_t::kTxStart, 8, 16>
+    {
+    static const Arduino_LoRaWAN_EventSchema &getSchema()
+        {
+        static const Arduino_LoRaWAN_EventField fields[] =
+            {
+            { "ch", getWidth(0), Arduino_LoRaWAN_EventField::Format_t::kDecimal },
+            { "rps", getWidth(1), Arduino_LoRaWAN_EventField::Format_t::kRps },
+            };
+        static_assert(sizeof(fields) / sizeof(fields[0]) == kNumFields, "field count");
+        static const Arduino_LoRaWAN_EventSchema schema = { kCode, "TX", kNumFields, fields };
+        return schema;
+        }
+    };
+
+#endif /* _Arduino_LoRaWAN_EventLogFormat_h_ */
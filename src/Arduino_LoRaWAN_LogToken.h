@@ -0,0 +1,345 @@
+/*
+
+Module:	Arduino_LoRaWAN_LogToken.h
+
+Function:
+	Tokenized log messages: the format hash and the binary record.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _Arduino_LoRaWAN_LogToken_h_
+#define _Arduino_LoRaWAN_LogToken_h_	/* prevent multiple includes */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// This header has no other dependencies, so host tools can use it to
+// decode logs.
+
+/// \brief the LMIC events, in ev_t order starting with EV_SCAN_TIMEOUT.
+///     \p a_entry is applied to each name, without the EV_ prefix.
+#define	ARDUINO_LORAWAN_LMIC_EV_NAMES(a_entry)				\
+	a_entry(SCAN_TIMEOUT) a_entry(BEACON_FOUND) a_entry(BEACON_MISSED) \
+	a_entry(BEACON_TRACKED) a_entry(JOINING) a_entry(JOINED)	\
+	a_entry(RFU1) a_entry(JOIN_FAILED) a_entry(REJOIN_FAILED)	\
+	a_entry(TXCOMPLETE) a_entry(LOST_TSYNC) a_entry(RESET)		\
+	a_entry(RXCOMPLETE) a_entry(LINK_DEAD) a_entry(LINK_ALIVE)	\
+	a_entry(SCAN_FOUND) a_entry(TXSTART) a_entry(TXCANCELED)	\
+	a_entry(RXSTART) a_entry(JOIN_TXCOMPLETE)
+
+#define	ARDUINO_LORAWAN_LMIC_EV_NAME_MZ_(a_name)	#a_name "\0"
+
+/// \brief the names of the LMIC events as a multi-string. Tokenized logs
+///     send the index instead.
+#define	ARDUINO_LORAWAN_LMIC_EV_NAMES_MZ__INIT				\
+	ARDUINO_LORAWAN_LMIC_EV_NAMES(ARDUINO_LORAWAN_LMIC_EV_NAME_MZ_)
+
+///
+/// \brief one tokenized log message.
+///
+/// \details
+///     Instead of the format string, a tokenized message carries a 32-bit
+///     hash of it (the token), computed at compile time by hash(). The
+///     arguments follow in binary. A host tool that has the format
+///     strings (from the sources) turns the messages back into text.
+///
+///     On the wire, a message is:
+///
+///     | Bytes | Contents
+///     |-------|---------
+///     | 1     | kSync (0xE6)
+///     | 1     | n, the number of bytes of token and arguments
+///     | 4     | the token, little-endian
+///     | n - 4 | the arguments
+///     | 1     | check byte: the sum of all the bytes of the message is zero
+///
+///     Arguments are encoded by their C++ type:
+///
+///     - integers, and pointers: sign-extended to 64 bits, zig-zag encoded,
+///       and sent as an unsigned LEB128 varint.
+///     - floating point: 4 bytes, IEEE single precision, little-endian.
+///     - strings: varint (length + 1), then the bytes, at most kStringMax.
+///     - EventName_t: varint 0, then varint index of the name in
+///       ARDUINO_LORAWAN_LMIC_EV_NAMES_MZ__INIT.
+///
+///     If the arguments don't fit, the message ends after the last one
+///     that does.
+///
+struct Arduino_LoRaWAN_LogToken
+    {
+    static constexpr std::uint8_t kSync = 0xE6;         ///< first byte of every message
+    static constexpr std::size_t kMaxPayload = 64;      ///< most bytes of token and arguments
+    static constexpr std::size_t kMaxSize = kMaxPayload + 3; ///< largest message
+    static constexpr std::size_t kStringMax = 32;       ///< longest string argument sent
+
+    ///
+    /// \brief compute the token for a format string (32-bit FNV-1a).
+    ///
+    /// \details
+    ///     Written as a C++11 constexpr function, so a string literal
+    ///     can be hashed at compile time; see ARDUINO_LORAWAN_LOG_TOKEN().
+    ///
+    static constexpr std::uint32_t hash(const char *s, std::uint32_t h = 2166136261u)
+        {
+        return *s == '\0'
+            ? h
+            : hash(s + 1, std::uint32_t((h ^ std::uint8_t(*s)) * std::uint32_t(16777619u)));
+        }
+
+    /// \brief an LMIC event name, sent as its index.
+    struct EventName_t
+        {
+        std::uint8_t index;     ///< index in ARDUINO_LORAWAN_LMIC_EV_NAMES_MZ__INIT
+        };
+
+    /****************************************************************\
+    |   Encoding
+    \****************************************************************/
+
+    ///
+    /// \brief build a message.
+    ///
+    class Encoder_t
+        {
+    public:
+        /// \brief start a message with the given token.
+        explicit Encoder_t(std::uint32_t token)
+            {
+            this->m_buffer[0] = kSync;
+            for (unsigned i = 0; i < 4; ++i)
+                this->m_buffer[2 + i] = std::uint8_t(token >> (8 * i));
+            this->m_n = 6;
+            }
+
+        /// \brief append the arguments (none).
+        void put() {}
+
+        /// \brief append the arguments.
+        template <typename T, typename... TRest>
+        void put(T v, TRest... rest)
+            {
+            if (this->m_fFull)
+                return;
+
+            auto const nSave = this->m_n;
+
+            if (! this->putOne(v))
+                {
+                this->m_n = nSave;
+                this->m_fFull = true;
+                return;
+                }
+
+            this->put(rest...);
+            }
+
+        /// \brief finish the message, and return its size.
+        std::size_t finish()
+            {
+            this->m_buffer[1] = std::uint8_t(this->m_n - 2);
+
+            std::uint8_t sum = 0;
+            for (std::size_t i = 0; i < this->m_n; ++i)
+                sum += this->m_buffer[i];
+
+            this->m_buffer[this->m_n++] = std::uint8_t(-sum);
+            return this->m_n;
+            }
+
+        /// \brief the message.
+        const std::uint8_t *getData() const { return this->m_buffer; }
+
+    private:
+        bool putByte(std::uint8_t b)
+            {
+            if (this->m_n >= 2 + kMaxPayload)
+                return false;
+
+            this->m_buffer[this->m_n++] = b;
+            return true;
+            }
+
+        bool putVarint(std::uint64_t v)
+            {
+            while (v >= 0x80)
+                {
+                if (! this->putByte(std::uint8_t(v | 0x80)))
+                    return false;
+                v >>= 7;
+                }
+            return this->putByte(std::uint8_t(v));
+            }
+
+        bool putInt(std::int64_t v)
+            {
+            return this->putVarint((std::uint64_t(v) << 1) ^ std::uint64_t(v >> 63));
+            }
+
+        bool putOne(signed char v)          { return this->putInt(v); }
+        bool putOne(char v)                 { return this->putInt(v); }
+        bool putOne(unsigned char v)        { return this->putInt(v); }
+        bool putOne(short v)                { return this->putInt(v); }
+        bool putOne(unsigned short v)       { return this->putInt(v); }
+        bool putOne(int v)                  { return this->putInt(v); }
+        bool putOne(unsigned v)             { return this->putInt(v); }
+        bool putOne(long v)                 { return this->putInt(v); }
+        bool putOne(unsigned long v)        { return this->putInt(v); }
+        bool putOne(long long v)            { return this->putInt(v); }
+        bool putOne(unsigned long long v)   { return this->putInt(std::int64_t(v)); }
+        bool putOne(bool v)                 { return this->putInt(v); }
+        bool putOne(const void *v)          { return this->putInt(std::int64_t(std::uintptr_t(v))); }
+
+        bool putOne(double v)
+            {
+            float const f = float(v);
+            std::uint32_t bits;
+
+            std::memcpy(&bits, &f, sizeof(bits));
+            for (unsigned i = 0; i < 4; ++i)
+                {
+                if (! this->putByte(std::uint8_t(bits >> (8 * i))))
+                    return false;
+                }
+            return true;
+            }
+
+        bool putOne(const char *s)
+            {
+            if (s == nullptr)
+                s = "(null)";
+
+            std::size_t n = std::strlen(s);
+            if (n > kStringMax)
+                n = kStringMax;
+
+            if (! this->putVarint(n + 1))
+                return false;
+
+            for (std::size_t i = 0; i < n; ++i)
+                {
+                if (! this->putByte(std::uint8_t(s[i])))
+                    return false;
+                }
+            return true;
+            }
+
+        bool putOne(char *s) { return this->putOne((const char *) s); }
+
+        bool putOne(EventName_t name)
+            {
+            return this->putVarint(0) && this->putVarint(name.index);
+            }
+
+        std::uint8_t m_buffer[kMaxSize];        ///< the message
+        std::size_t m_n;                        ///< bytes used so far
+        bool m_fFull = false;                   ///< an argument didn't fit
+        };
+
+    /****************************************************************\
+    |   Decoding
+    \****************************************************************/
+
+    ///
+    /// \brief decode a message.
+    ///
+    /// \param [in] pBuffer the data; pBuffer[0] should be kSync.
+    /// \param [in] nBuffer the number of bytes available.
+    /// \param [out] token set to the token.
+    /// \param [out] pArgs set to point to the arguments.
+    /// \param [out] nArgs set to the number of bytes of arguments.
+    ///
+    /// \return the number of bytes in the message if it's good; 0 if more
+    ///     data is needed; -1 if this isn't a good message (the caller
+    ///     should skip a byte and try again).
+    ///
+    static int decode(
+        const std::uint8_t *pBuffer,
+        std::size_t nBuffer,
+        std::uint32_t &token,
+        const std::uint8_t *&pArgs,
+        std::size_t &nArgs
+        )
+        {
+        if (nBuffer < 1)
+            return 0;
+        if (pBuffer[0] != kSync)
+            return -1;
+        if (nBuffer < 2)
+            return 0;
+
+        std::size_t const nPayload = pBuffer[1];
+        if (nPayload < 4 || nPayload > kMaxPayload)
+            return -1;
+        if (nBuffer < nPayload + 3)
+            return 0;
+
+        std::uint8_t sum = 0;
+        for (std::size_t i = 0; i < nPayload + 3; ++i)
+            sum += pBuffer[i];
+        if (sum != 0)
+            return -1;
+
+        token = 0;
+        for (unsigned i = 0; i < 4; ++i)
+            token |= std::uint32_t(pBuffer[2 + i]) << (8 * i);
+
+        pArgs = pBuffer + 6;
+        nArgs = nPayload - 4;
+        return int(nPayload + 3);
+        }
+
+    ///
+    /// \brief take an unsigned varint from the arguments.
+    ///
+    /// \return \c true if there was one.
+    ///
+    static bool getVarint(const std::uint8_t *&p, const std::uint8_t *pEnd, std::uint64_t &v)
+        {
+        v = 0;
+        for (unsigned shift = 0; p < pEnd && shift < 64; shift += 7)
+            {
+            auto const b = *p++;
+
+            v |= std::uint64_t(b & 0x7F) << shift;
+            if ((b & 0x80) == 0)
+                return true;
+            }
+        return false;
+        }
+
+    ///
+    /// \brief take an integer argument.
+    ///
+    static bool getInt(const std::uint8_t *&p, const std::uint8_t *pEnd, std::int64_t &v)
+        {
+        std::uint64_t u;
+
+        if (! getVarint(p, pEnd, u))
+            return false;
+
+        v = std::int64_t(u >> 1) ^ -std::int64_t(u & 1);
+        return true;
+        }
+    };
+
+/// \brief the token for a string literal, as a compile-time constant.
+#define ARDUINO_LORAWAN_LOG_TOKEN(a_fmt)        \
+        (std::integral_constant<std::uint32_t, Arduino_LoRaWAN_LogToken::hash(a_fmt)>::value)
+
+#endif /* _Arduino_LoRaWAN_LogToken_h_ */
@@ -0,0 +1,85 @@
+/*
+
+Module:	Arduino_LoRaWAN_NameTable.h
+
+Function:
+	Compile-time helpers for tables of names.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _Arduino_LoRaWAN_NameTable_h_
+#define _Arduino_LoRaWAN_NameTable_h_	/* prevent multiple includes */
+
+#pragma once
+
+#include <cstddef>
+
+///
+/// \brief constexpr helpers for building and checking name tables.
+///
+/// \details
+///     These are C++11 constexpr functions (a single return statement,
+///     recursion instead of loops), so they can be used in table
+///     initializers and static_asserts on every supported compiler.
+///
+struct Arduino_LoRaWAN_NameTable
+    {
+    /// \brief the length of a string.
+    static constexpr std::size_t length(const char *s)
+        {
+        return *s == '\0' ? 0 : 1 + length(s + 1);
+        }
+
+    /// \brief true if two strings are the same.
+    static constexpr bool equal(const char *a, const char *b)
+        {
+        return *a == *b && (*a == '\0' || equal(a + 1, b + 1));
+        }
+
+    ///
+    /// \brief the offset of string \p i in a multi-string (a sequence of
+    ///     '\0'-terminated strings).
+    ///
+    static constexpr std::size_t multiSzOffset(
+        const char *pMultiSz,
+        std::size_t i,
+        std::size_t offset = 0
+        )
+        {
+        return i == 0
+            ? offset
+            : multiSzOffset(pMultiSz, i - 1, offset + length(pMultiSz + offset) + 1);
+        }
+
+    ///
+    /// \brief true if \p table[i].id == i for every entry, so the table
+    ///     can be indexed by id.
+    ///
+    template <typename TEntry, std::size_t a_n>
+    static constexpr bool isIndexed(const TEntry (&table)[a_n], std::size_t i = 0)
+        {
+        return i == a_n ||
+               (std::size_t(table[i].id) == i && isIndexed(table, i + 1));
+        }
+
+    /// \brief the number of entries in a table.
+    template <typename TEntry, std::size_t a_n>
+    static constexpr std::size_t size(const TEntry (&)[a_n])
+        {
+        return a_n;
+        }
+    };
+
+#endif /* _Arduino_LoRaWAN_NameTable_h_ */
@@ -0,0 +1,237 @@
+/*
+
+Module:	Arduino_LoRaWAN_Probes.h
+
+Function:
+	Timing probes for the MAC paths, and the counter they read.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _Arduino_LoRaWAN_Probes_h_
+#define _Arduino_LoRaWAN_Probes_h_	/* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+
+class Print;
+
+///
+/// \brief timing probes for the library's event and uplink paths.
+///
+/// \details
+///     Each probe keeps the number of samples, the minimum, maximum and
+///     mean, and a histogram with one bucket per power of two. Samples
+///     are in counts of the probe counter: see setCounter().
+///
+///     The probes are only compiled in if \c ARDUINO_LORAWAN_CFG_PROBES
+///     is non-zero; then each Arduino_LoRaWAN has a set, returned by
+///     Arduino_LoRaWAN::GetProbes(). The counter functions are always
+///     available.
+///
+class Arduino_LoRaWAN_Probes
+    {
+public:
+    /// \brief the probes.
+    enum class ProbeId : std::uint8_t
+        {
+        OnEvent,                ///< onEvent(), for all events.
+        DispatchEvent,          ///< Arduino_LoRaWAN::DispatchEvent().
+        SaveSessionState,       ///< Arduino_LoRaWAN::SaveSessionState().
+        NetRxComplete,          ///< NetRxComplete(), called from the event processor.
+        SendBuffer,             ///< SendBuffer() and SendBufferNoCopy().
+        IrqToEvent,             ///< from markIrq() to the next onEvent().
+        TxCompleteToSendBuffer, ///< from EV_TXCOMPLETE to the next SendBuffer().
+        Count
+        };
+
+    static constexpr unsigned kProbeCount = unsigned(ProbeId::Count);
+
+    /// \brief number of histogram buckets; bucket \c i counts samples
+    ///     from 2^i to 2^(i+1) - 1, and bucket 0 also counts 0.
+    static constexpr unsigned kBuckets = 32;
+
+    /// \brief the statistics for one probe.
+    struct Stats_t
+        {
+        std::uint32_t nSamples;         ///< number of samples.
+        std::uint32_t min;              ///< smallest sample.
+        std::uint32_t max;              ///< largest sample.
+        std::uint64_t sum;              ///< sum of the samples.
+        std::uint16_t buckets[kBuckets]; ///< log2 histogram; counts stop at 0xFFFF.
+
+        /// \brief the mean, or zero if there are no samples.
+        std::uint32_t mean() const
+            {
+            return this->nSamples == 0 ? 0 : std::uint32_t(this->sum / this->nSamples);
+            }
+        };
+
+    /// \brief a counter: returns a free-running 32-bit count.
+    typedef std::uint32_t CounterFn_t(void);
+
+    ///
+    /// \brief time a scope with a probe.
+    ///
+    /// \details
+    ///     Use ARDUINO_LORAWAN_PROBE_SCOPE(), which generates no code if
+    ///     the probes are not configured.
+    ///
+    class cScope
+        {
+    public:
+        cScope(Arduino_LoRaWAN_Probes &probes, ProbeId id)
+            : m_probes(probes)
+            , m_tStart(readCounter())
+            , m_id(id)
+            {}
+
+        ~cScope()
+            {
+            this->m_probes.addSample(this->m_id, readCounter() - this->m_tStart);
+            }
+
+        cScope(const cScope &) = delete;
+        cScope &operator=(const cScope &) = delete;
+
+    private:
+        Arduino_LoRaWAN_Probes &m_probes;
+        std::uint32_t m_tStart;
+        ProbeId m_id;
+        };
+
+    Arduino_LoRaWAN_Probes() {}
+
+    /// \brief add a sample to a probe.
+    void addSample(ProbeId id, std::uint32_t count);
+
+    /// \brief copy the statistics of a probe; false if \p id is not valid.
+    bool getStats(ProbeId id, Stats_t &stats) const;
+
+    /// \brief clear the statistics of all probes.
+    void reset();
+
+    /// \brief clear the statistics of one probe.
+    void reset(ProbeId id);
+
+    /// \brief start an interval; see endInterval().
+    void beginInterval(ProbeId id);
+
+    /// \brief if an interval for \p id was started, end it and add the sample.
+    void endInterval(ProbeId id);
+
+    ///
+    /// \brief print a table of the probes that have samples.
+    ///
+    /// \details
+    ///     One line per probe: the name, samples, min, mean and max,
+    ///     followed by the non-empty histogram buckets as \c bit:count,
+    ///     where \c bit is the bucket number.
+    ///
+    void print(Print &out) const;
+
+    /// \brief the name of a probe.
+    static const char *getName(ProbeId id);
+
+    ///
+    /// \brief select the counter for all probes.
+    ///
+    /// \param [in] pFn the counter; if null, the default.
+    /// \param [in] pUnits the units of the counter, for printing.
+    ///
+    /// \details
+    ///     The default is the CPU cycle counter on Cortex-M3/M4/M7 (the
+    ///     DWT CYCCNT) and on ESP32; otherwise \c micros(). If CYCCNT
+    ///     doesn't count, the default is \c micros() there too. Cortex-M0
+    ///     and M0+ have no cycle counter; for finer resolution there,
+    ///     supply a counter that reads a hardware timer. A host can
+    ///     supply its own clock.
+    ///
+    static void setCounter(CounterFn_t *pFn, const char *pUnits);
+
+    /// \brief read the counter.
+    static std::uint32_t readCounter()
+        {
+        return (*s_pCounter)();
+        }
+
+    /// \brief the units of the counter.
+    static const char *getCounterUnits()
+        {
+        return s_pCounterUnits;
+        }
+
+    /// \brief start the default counter, and fall back to \c micros() if
+    ///     it doesn't count; called by Arduino_LoRaWAN::begin().
+    static void beginCounter();
+
+    /// \brief read microseconds from \c micros().
+    static std::uint32_t readMicros();
+
+    ///
+    /// \brief note the time of a radio interrupt.
+    ///
+    /// \details
+    ///     Call this from an interrupt handler on a radio DIO line; the
+    ///     next onEvent() adds the time since then to the \c IrqToEvent
+    ///     probe. It can be called whether or not the probes are
+    ///     configured.
+    ///
+    static void markIrq();
+
+    /// \brief take the time saved by markIrq(); false if there is none.
+    static bool takeIrq(std::uint32_t &tIrq);
+
+private:
+    static CounterFn_t *s_pCounter;
+    static const char *s_pCounterUnits;
+
+    static volatile std::uint32_t s_tIrq;
+    static volatile bool s_fIrq;
+
+    Stats_t m_stats[kProbeCount] {};
+    std::uint32_t m_tInterval[kProbeCount] {};
+    std::uint32_t m_fInterval = 0;      ///< bit \c i set if interval \c i was started.
+    };
+
+///
+/// \brief time the rest of the enclosing scope with probe \p a_id of
+///     Arduino_LoRaWAN_Probes \p a_probes.
+///
+#if ARDUINO_LORAWAN_CFG_PROBES
+# define ARDUINO_LORAWAN_PROBE_SCOPE(a_probes, a_id)				\
+	Arduino_LoRaWAN_Probes::cScope ARDUINO_LORAWAN_PROBE_NAME_(__LINE__)	\
+		{ (a_probes), Arduino_LoRaWAN_Probes::ProbeId::a_id }
+# define ARDUINO_LORAWAN_PROBE_NAME_(a_line)	ARDUINO_LORAWAN_PROBE_NAME2_(a_line)
+# define ARDUINO_LORAWAN_PROBE_NAME2_(a_line)	probeScope_##a_line
+#else
+# define ARDUINO_LORAWAN_PROBE_SCOPE(a_probes, a_id)	do { } while (0)
+#endif
+
+///
+/// \brief start or end interval probe \p a_id of \p a_probes. The
+///     sample is the time from the latest start to the first end after it.
+///
+#if ARDUINO_LORAWAN_CFG_PROBES
+# define ARDUINO_LORAWAN_PROBE_BEGIN_INTERVAL(a_probes, a_id)			\
+	(a_probes).beginInterval(Arduino_LoRaWAN_Probes::ProbeId::a_id)
+# define ARDUINO_LORAWAN_PROBE_END_INTERVAL(a_probes, a_id)			\
+	(a_probes).endInterval(Arduino_LoRaWAN_Probes::ProbeId::a_id)
+#else
+# define ARDUINO_LORAWAN_PROBE_BEGIN_INTERVAL(a_probes, a_id)	do { } while (0)
+# define ARDUINO_LORAWAN_PROBE_END_INTERVAL(a_probes, a_id)	do { } while (0)
+#endif
+
+#endif /* _Arduino_LoRaWAN_Probes_h_ */
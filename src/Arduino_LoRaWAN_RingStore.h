@@ -0,0 +1,327 @@
+/*
+
+Module:	Arduino_LoRaWAN_RingStore.h
+
+Function:
+	Wear-levelled, log-structured storage for Arduino_LoRaWAN session
+	data.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _Arduino_LoRaWAN_RingStore_h_
+#define _Arduino_LoRaWAN_RingStore_h_	/* prevent multiple includes */
+
+#pragma once
+
+#include <Arduino_LoRaWAN.h>
+#include <cstddef>
+#include <cstdint>
+
+/****************************************************************************\
+|
+|	The page device interface
+|
+\****************************************************************************/
+
+///
+/// \brief abstract page-oriented storage device (typically NOR flash).
+///
+/// \details
+///     Pages are erased as a unit, which sets every byte to 0xFF. After
+///     an erase, each byte may be written once. Writes are always a
+///     multiple of 4 bytes long, at offsets that are multiples of 4.
+///
+class Arduino_LoRaWAN::cPageDevice
+    {
+public:
+    /// \brief devices are subclassed, and may be deleted through this class.
+    virtual ~cPageDevice() = default;
+
+    /// \brief return the size of a page, in bytes.
+    virtual std::size_t getPageSize() const = 0;
+
+    /// \brief return the number of pages.
+    virtual unsigned getPageCount() const = 0;
+
+    /// \brief read bytes from a page.
+    virtual bool read(unsigned iPage, std::size_t offset, void *pBuffer, std::size_t nBuffer) = 0;
+
+    /// \brief write bytes to an erased area of a page.
+    virtual bool write(unsigned iPage, std::size_t offset, const void *pBuffer, std::size_t nBuffer) = 0;
+
+    /// \brief erase a page.
+    virtual bool erase(unsigned iPage) = 0;
+    };
+
+/****************************************************************************\
+|
+|	The ring store
+|
+\****************************************************************************/
+
+///
+/// \brief a log-structured ring of records over a cPageDevice.
+///
+/// \details
+///     Records are appended to the current page; each record carries a
+///     kind, a sequence number, and a CRC-32. When the current page fills,
+///     the next page (in ring order) is erased, the latest record of each
+///     kind is copied to it, and its page header is written last. So the
+///     newest valid page always holds the latest record of every kind,
+///     erases rotate evenly through the device, and recovery at begin()
+///     reads one header per page plus the records of a single page.
+///
+///     The page size must hold a page header and one record of each kind
+///     with room to spare; 512 bytes is plenty for session data.
+///
+class Arduino_LoRaWAN::cRingStore
+    {
+public:
+    cRingStore() {};
+    ~cRingStore() {};
+
+    /// \brief the kinds of record.
+    enum class RecordKind : std::uint8_t
+        {
+        kSessionInfo = 0,       ///< a SessionInfo.
+        kSessionState = 1,      ///< a SessionState.
+        kExtraSessionInfo = 2,  ///< extra session info from NetSaveSessionInfo().
+        };
+
+    /// \brief number of record kinds.
+    static constexpr unsigned kNumKinds = 3;
+
+    ///
+    /// \brief attach to a device and recover the latest records.
+    ///
+    /// \return \c true if the store is usable. If no valid page is found,
+    ///     the device is formatted.
+    ///
+    bool begin(cPageDevice *pDevice);
+
+    /// \brief erase the device and start an empty store.
+    bool format();
+
+    /// \brief append a record.
+    bool append(RecordKind kind, const void *pData, std::size_t nData);
+
+    ///
+    /// \brief read the latest record of a given kind.
+    ///
+    /// \param [in] kind the kind of record.
+    /// \param [out] pData buffer for the record.
+    /// \param [in] nData size of buffer; longer records are truncated.
+    /// \param [out] pnActual if not \c nullptr, set to the size of the record.
+    ///
+    /// \return \c true if a record was found and its CRC checks.
+    ///
+    bool read(RecordKind kind, void *pData, std::size_t nData, std::size_t *pnActual = nullptr);
+
+    /// \brief return the index of the current page.
+    unsigned getCurrentPage() const { return this->m_iPage; }
+
+    /// \brief return the sequence number of the current page.
+    std::uint32_t getPageSequence() const { return this->m_pageSeq; }
+
+private:
+    /// \brief header at the start of each page.
+    struct PageHeader_t
+        {
+        std::uint32_t magic;            ///< kPageMagic
+        std::uint32_t seq;              ///< page sequence number
+        std::uint32_t rsv;              ///< reserved, 0xFFFFFFFF
+        std::uint32_t crc;              ///< CRC-32 of the fields above
+        };
+
+    /// \brief header before each record.
+    struct RecordHeader_t
+        {
+        std::uint16_t magic;            ///< kRecordMagic
+        std::uint8_t kind;              ///< a RecordKind
+        std::uint8_t rsv;               ///< reserved, 0xFF
+        std::uint16_t size;             ///< size of the data that follows
+        std::uint16_t rsv2;             ///< reserved, 0xFFFF
+        std::uint32_t seq;              ///< record sequence number
+        std::uint32_t crc;              ///< CRC-32 of the fields above and the data
+        };
+
+    static constexpr std::uint32_t kPageMagic = 0x5057524Cu;   // 'LRWP'
+    static constexpr std::uint16_t kRecordMagic = 0x524Cu;     // 'LR'
+
+    /// \brief where the latest record of a kind lives in the current page.
+    struct Latest_t
+        {
+        std::uint32_t seq;              ///< its sequence number
+        std::uint16_t offset;           ///< offset of the header in the current page
+        std::uint16_t size;             ///< size of the data
+        bool fValid;                    ///< true if there is one
+        };
+
+    cPageDevice *m_pDevice = nullptr;   ///< the device
+    std::size_t m_pageSize = 0;         ///< cached page size
+    std::size_t m_offset = 0;           ///< next free byte in current page
+    std::uint32_t m_pageSeq = 0;        ///< sequence number of current page
+    std::uint32_t m_recordSeq = 0;      ///< sequence number for next record
+    unsigned m_nPages = 0;              ///< cached page count
+    unsigned m_iPage = 0;               ///< current page
+    bool m_fPageFull = false;           ///< true if current page can't be appended to
+    Latest_t m_latest[kNumKinds];       ///< latest record of each kind
+
+    /// \brief round a size up to the write granularity.
+    static std::size_t roundUp(std::size_t n) { return (n + 3) & ~std::size_t(3); }
+
+    /// \brief read and check a page header.
+    bool readPageHeader(unsigned iPage, std::uint32_t &seq);
+
+    /// \brief scan the records of the current page.
+    void scanPage();
+
+    /// \brief move to the next page with a new record, carrying forward the others.
+    bool startNewPage(RecordKind kind, const void *pData, std::size_t nData);
+
+    /// \brief write a record at the current offset of a page.
+    bool writeRecord(unsigned iPage, RecordKind kind, const void *pData, std::size_t nData);
+
+    /// \brief copy a record to the current offset of another page.
+    bool copyRecord(unsigned iPageFrom, unsigned iPageTo, Latest_t &latest);
+    };
+
+/****************************************************************************\
+|
+|	Network-object mixin
+|
+\****************************************************************************/
+
+///
+/// \brief implement the session-storage virtuals over a cRingStore.
+///
+/// \details
+///     Use this in place of the network class as the base of your
+///     LoRaWAN object, for example:
+///
+///     class cMyLoRaWAN : public Arduino_LoRaWAN_RingStore<Arduino_LoRaWAN_network> { ... };
+///
+///     then call \c attachRingStore() before \c begin().
+///
+template <class TBase>
+class Arduino_LoRaWAN_RingStore : public TBase
+    {
+public:
+    using Super = TBase;
+    using SessionInfo = Arduino_LoRaWAN::SessionInfo;
+    using SessionState = Arduino_LoRaWAN::SessionState;
+    using AbpProvisioningInfo = Arduino_LoRaWAN::AbpProvisioningInfo;
+    using RecordKind = Arduino_LoRaWAN::cRingStore::RecordKind;
+
+    /// \brief use \p pStore for saving and restoring session data.
+    void attachRingStore(Arduino_LoRaWAN::cRingStore *pStore)
+        {
+        this->m_pRingStore = pStore;
+        }
+
+protected:
+    virtual void NetSaveSessionInfo(
+        const SessionInfo &Info,
+        const uint8_t *pExtraInfo,
+        size_t nExtraInfo
+        ) override
+        {
+        if (this->m_pRingStore == nullptr)
+            return;
+
+        this->m_pRingStore->append(RecordKind::kSessionInfo, &Info, sizeof(Info));
+        if (pExtraInfo != nullptr && nExtraInfo != 0)
+            this->m_pRingStore->append(RecordKind::kExtraSessionInfo, pExtraInfo, nExtraInfo);
+        }
+
+    virtual void NetSaveSessionState(
+        const SessionState &State
+        ) override
+        {
+        if (this->m_pRingStore != nullptr)
+            this->m_pRingStore->append(RecordKind::kSessionState, &State, sizeof(State));
+        }
+
+    virtual bool NetGetSessionState(
+        SessionState &State
+        ) override
+        {
+        size_t nActual;
+
+        // older versions are smaller; the library upgrades them.
+        return this->m_pRingStore != nullptr &&
+               this->m_pRingStore->read(RecordKind::kSessionState, &State, sizeof(State), &nActual) &&
+               nActual == State.Header.Size;
+        }
+
+    virtual bool GetSavedSessionInfo(
+        SessionInfo &Info,
+        uint8_t *pExtraInfo,
+        size_t nExtraInfo,
+        size_t *pnExtraInfoActual
+        ) override
+        {
+        size_t nActual;
+
+        if (this->m_pRingStore == nullptr ||
+            ! this->m_pRingStore->read(RecordKind::kSessionInfo, &Info, sizeof(Info), &nActual) ||
+            nActual != sizeof(Info))
+            return Super::GetSavedSessionInfo(Info, pExtraInfo, nExtraInfo, pnExtraInfoActual);
+
+        if (pExtraInfo == nullptr ||
+            ! this->m_pRingStore->read(RecordKind::kExtraSessionInfo, pExtraInfo, nExtraInfo, &nActual))
+            nActual = 0;
+        if (pnExtraInfoActual != nullptr)
+            *pnExtraInfoActual = nActual;
+
+        return true;
+        }
+
+    // the keys for a saved session come back through the ABP path.
+
+    virtual bool GetAbpProvisioningInfo(
+        AbpProvisioningInfo *pInfo
+        ) override
+        {
+        SessionInfo Info;
+        SessionState State;
+        size_t nActual;
+
+        if (this->m_pRingStore == nullptr ||
+            ! this->m_pRingStore->read(RecordKind::kSessionInfo, &Info, sizeof(Info), &nActual) ||
+            nActual != sizeof(Info) ||
+            ! Info.upgrade() ||
+            ! this->NetGetSessionState(State) ||
+            ! State.upgrade())
+            return Super::GetAbpProvisioningInfo(pInfo);
+
+        if (pInfo != nullptr)
+            {
+            std::memcpy(pInfo->NwkSKey, Info.V3.NwkSKey, sizeof(pInfo->NwkSKey));
+            std::memcpy(pInfo->AppSKey, Info.V3.AppSKey, sizeof(pInfo->AppSKey));
+            pInfo->DevAddr = Info.V3.DevAddr;
+            pInfo->NetID = Info.V3.NetID;
+            pInfo->FCntUp = State.V1.FCntUp;
+            pInfo->FCntDown = State.V1.FCntDown;
+            }
+
+        return true;
+        }
+
+private:
+    Arduino_LoRaWAN::cRingStore *m_pRingStore = nullptr;
+    };
+
+#endif /* _Arduino_LoRaWAN_RingStore_h_ */
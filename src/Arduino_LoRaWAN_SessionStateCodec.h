@@ -0,0 +1,515 @@
+/*
+
+Module:	Arduino_LoRaWAN_SessionStateCodec.h
+
+Function:
+	Compact, bit-packed encoding of Arduino_LoRaWAN::SessionState for
+	small battery-backed RAMs.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _Arduino_LoRaWAN_SessionStateCodec_h_
+#define _Arduino_LoRaWAN_SessionStateCodec_h_	/* prevent multiple includes */
+
+#pragma once
+
+#include <Arduino_LoRaWAN.h>
+#include <arduino_lmic_user_configuration.h>
+#include <cstdint>
+
+/****************************************************************************\
+|
+|	The common part of the codec
+|
+\****************************************************************************/
+
+///
+/// \brief fields and helpers shared by all cSessionStateCodec variants.
+///
+/// \details
+///     An encoding is a format byte, then the fields packed LSB-first into
+///     a bit stream with no padding, then a CRC-32 of everything before
+///     it (little-endian). Each field gets just the bits its range needs.
+///     Fields that the LMIC build doesn't use (ping, beacon, TxParamSetup)
+///     are not encoded. Counters and times, which are usually small or
+///     zero, are written with a two-bit size (see BitWriter_t::putVariable()).
+///
+class Arduino_LoRaWAN::cSessionStateCodecBase
+    {
+public:
+    /// \brief the format byte: channel layout in the high nibble, version in the low.
+    enum Format : std::uint8_t
+        {
+        kFormatEUlike = 0x12,   ///< SessionChannelMask_EU_like, version 2
+        kFormatUSlike = 0x22,   ///< SessionChannelMask_US_like, version 2
+        };
+
+    /// \brief bytes of overhead: the format byte and the CRC.
+    static constexpr std::size_t kOverhead = 1 + 4;
+
+    /// \brief the most bits used by a value written with putVariable().
+    static constexpr std::size_t kVariableBits = 2 + 32;
+
+    /// \brief the most bits used by the fields common to all formats
+    ///     (with ping, beacon and TxParamSetupReq support).
+    static constexpr std::size_t kCommonBits = 4 + 4 + 4 * kVariableBits + 24 + 16 + 16 + 8 + 4 + 4 + 3 + 4 + 4 + 3 * 8 + 8 + 8 + 24 + 4;
+
+    /// \brief write a bit stream.
+    class BitWriter_t
+        {
+    public:
+        BitWriter_t(std::uint8_t *pBuffer, std::size_t nBuffer)
+            : m_pBuffer(pBuffer), m_nBuffer(nBuffer) {}
+
+        /// \brief append the low \p nBits of \p v; an error if \p v doesn't fit.
+        void put(std::uint32_t v, unsigned nBits)
+            {
+            if (nBits < 32 && (v >> nBits) != 0)
+                this->m_fError = true;
+
+            for (; nBits != 0; --nBits, v >>= 1, ++this->m_iBit)
+                {
+                auto const iByte = this->m_iBit / 8;
+                auto const mask = std::uint8_t(1u << (this->m_iBit & 7));
+
+                if (iByte >= this->m_nBuffer)
+                    {
+                    this->m_fError = true;
+                    return;
+                    }
+
+                if (v & 1)
+                    this->m_pBuffer[iByte] |= mask;
+                else
+                    this->m_pBuffer[iByte] &= ~mask;
+                }
+            }
+
+        /// \brief append \p v as a two-bit size, then 0, 12, 20 or 32 bits.
+        void putVariable(std::uint32_t v)
+            {
+            if (v == 0)
+                this->put(0, 2);
+            else if (v < (std::uint32_t(1) << 12))
+                {
+                this->put(1, 2);
+                this->put(v, 12);
+                }
+            else if (v < (std::uint32_t(1) << 20))
+                {
+                this->put(2, 2);
+                this->put(v, 20);
+                }
+            else
+                {
+                this->put(3, 2);
+                this->put(v, 32);
+                }
+            }
+
+        /// \brief append a wait that may be in the past (negative), with
+        ///     putVariable(): 0, -1, 1, -2 ... are written as 0, 1, 2, 3 ...
+        void putSigned(std::uint32_t v)
+            {
+            this->putVariable((v << 1) ^ (std::uint32_t(0) - (v >> 31)));
+            }
+
+        /// \brief append a frequency in Hz as 24 bits of 100 Hz units.
+        void putFrequency(std::uint32_t freq)
+            {
+            if (freq % 100 != 0)
+                this->m_fError = true;
+            this->put(freq / 100, 24);
+            }
+
+        /// \brief return the number of bytes used so far.
+        std::size_t getBytes() const { return (this->m_iBit + 7) / 8; }
+
+        /// \brief return true if anything didn't fit.
+        bool isError() const { return this->m_fError; }
+
+    private:
+        std::uint8_t *m_pBuffer;
+        std::size_t m_nBuffer;
+        std::size_t m_iBit = 0;
+        bool m_fError = false;
+        };
+
+    /// \brief read a bit stream.
+    class BitReader_t
+        {
+    public:
+        BitReader_t(const std::uint8_t *pBuffer, std::size_t nBuffer)
+            : m_pBuffer(pBuffer), m_nBuffer(nBuffer) {}
+
+        /// \brief return the next \p nBits as an unsigned value.
+        std::uint32_t get(unsigned nBits)
+            {
+            std::uint32_t v = 0;
+
+            for (unsigned i = 0; i < nBits; ++i, ++this->m_iBit)
+                {
+                auto const iByte = this->m_iBit / 8;
+
+                if (iByte >= this->m_nBuffer)
+                    {
+                    this->m_fError = true;
+                    return 0;
+                    }
+
+                if (this->m_pBuffer[iByte] & (1u << (this->m_iBit & 7)))
+                    v |= std::uint32_t(1) << i;
+                }
+
+            return v;
+            }
+
+        /// \brief return the next value written with putVariable().
+        std::uint32_t getVariable()
+            {
+            static constexpr std::uint8_t kBits[4] = { 0, 12, 20, 32 };
+
+            return this->get(kBits[this->get(2)]);
+            }
+
+        /// \brief return the next value written with putSigned().
+        std::uint32_t getSigned()
+            {
+            auto const v = this->getVariable();
+
+            return (v >> 1) ^ (std::uint32_t(0) - (v & 1));
+            }
+
+        /// \brief return the next frequency, in Hz.
+        std::uint32_t getFrequency() { return this->get(24) * 100; }
+
+        /// \brief return the number of bytes used so far.
+        std::size_t getBytes() const { return (this->m_iBit + 7) / 8; }
+
+        /// \brief return true if we ran off the end.
+        bool isError() const { return this->m_fError; }
+
+    private:
+        const std::uint8_t *m_pBuffer;
+        std::size_t m_nBuffer;
+        std::size_t m_iBit = 0;
+        bool m_fError = false;
+        };
+
+protected:
+    /// \brief check that \p State can be encoded, and start the encoding.
+    static bool beginEncode(const SessionState &State, std::uint8_t format, std::uint8_t *pBuffer, std::size_t nBuffer);
+
+    /// \brief encode the fields common to all formats.
+    static void encodeCommon(BitWriter_t &writer, const SessionState &State);
+
+    /// \brief append the CRC and return the size, or zero if there was an error.
+    static std::size_t endEncode(const BitWriter_t &writer, std::uint8_t *pBuffer, std::size_t nBuffer);
+
+    /// \brief check the format byte and start decoding.
+    static bool beginDecode(const std::uint8_t *pBuffer, std::size_t nBuffer, std::uint8_t format, SessionState &State);
+
+    /// \brief decode the fields common to all formats.
+    static void decodeCommon(BitReader_t &reader, SessionState &State);
+
+    /// \brief check the CRC and finish the state.
+    static bool endDecode(const BitReader_t &reader, const std::uint8_t *pBuffer, std::size_t nBuffer, SessionState &State);
+    };
+
+/****************************************************************************\
+|
+|	EU-like regions
+|
+\****************************************************************************/
+
+///
+/// \brief codec for session state with EU-like channels.
+///
+/// \details
+///     Each channel costs one bit if it's not set up. Otherwise it's
+///     written as its frequency, its band and its data-rate map. The map
+///     is a pair of nibbles if its rates are a range, as they are when
+///     set by LMIC_setupChannel() or NewChannelReq. The downlink frequency
+///     is only written if it's set (by DlChannelReq) and differs from the
+///     uplink frequency. Each
+///     band's availability time is written with putVariable().
+///
+///     For EU868, a joined session with the eight channels of a CFList
+///     and duty-cycle waits pending takes 93 bytes. The worst case, with
+///     all 16 channels set up with separate downlink frequencies, is
+///     kMaxEncodedSize: 219 bytes.
+///
+template <std::uint32_t a_nCh, std::uint32_t a_nBands>
+class Arduino_LoRaWAN::cSessionStateCodec<Arduino_LoRaWAN::SessionChannelMask_EU_like<a_nCh, a_nBands>>
+    : public Arduino_LoRaWAN::cSessionStateCodecBase
+    {
+public:
+    using Channels_t = Arduino_LoRaWAN::SessionChannelMask_EU_like<a_nCh, a_nBands>;
+
+    /// \brief the most bits for one channel: present, frequency, band,
+    ///     data rates (range flag and map), downlink (two flags and
+    ///     frequency).
+    static constexpr std::size_t kChannelBits = 1 + 24 + 2 + 1 + 16 + 2 + 24;
+
+    /// \brief the most bits for one band: duty cycle, power, last channel,
+    ///     availability.
+    static constexpr std::size_t kBandBits = 16 + 8 + 8 + kVariableBits;
+
+    /// \brief the largest possible encoding, in bytes.
+    static constexpr std::size_t kMaxEncodedSize =
+        kOverhead +
+        (kCommonBits + 2 * 16 + a_nCh * kChannelBits + a_nBands * kBandBits + 7) / 8;
+
+    ///
+    /// \brief encode a session state.
+    ///
+    /// \return the number of bytes used, or zero if \p State is not a valid
+    ///     EU-like state, a field is out of range, or \p nBuffer is too small.
+    ///
+    static std::size_t encode(const SessionState &State, std::uint8_t *pBuffer, std::size_t nBuffer)
+        {
+        if (! beginEncode(State, kFormatEUlike, pBuffer, nBuffer) ||
+            State.V1.Channels.Header.Tag != SessionChannelMask_Header::kEUlike ||
+            State.V1.Channels.Header.Size != sizeof(Channels_t))
+            return 0;
+
+        auto const &ch = reinterpret_cast<const Channels_t &>(State.V1.Channels);
+        BitWriter_t writer { pBuffer + 1, nBuffer - 1 };
+
+        encodeCommon(writer, State);
+        writer.put(ch.ChannelMap, 16);
+        writer.put(ch.ChannelShuffleMap, 16);
+
+        for (unsigned iCh = 0; iCh < a_nCh; ++iCh)
+            {
+            auto const freq = ch.getFrequency(ch.UplinkFreq, iCh);
+            auto const dlFreq = ch.getFrequency(ch.DownlinkFreq, iCh);
+            bool const fPresent = freq != 0 || dlFreq != 0 ||
+                                  ch.ChannelDrMap[iCh] != 0 || ch.getBand(iCh) != 0;
+
+            writer.put(fPresent, 1);
+            if (! fPresent)
+                continue;
+
+            writer.putFrequency(freq);
+            writer.put(ch.getBand(iCh), 2);
+            putDrMap(writer, ch.ChannelDrMap[iCh]);
+            // zero means the downlink is on the uplink frequency.
+            writer.put(dlFreq == 0, 1);
+            if (dlFreq == 0)
+                continue;
+
+            writer.put(dlFreq == freq, 1);
+            if (dlFreq != freq)
+                writer.putFrequency(dlFreq);
+            }
+
+        for (auto const &band : ch.Bands)
+            {
+            writer.put(band.txDutyDenom, 16);
+            writer.put(band.txPower, 8);
+            writer.put(band.lastChannel, 8);
+            writer.putVariable(band.ostimeAvail);
+            }
+
+        return endEncode(writer, pBuffer, nBuffer);
+        }
+
+    ///
+    /// \brief decode a session state.
+    ///
+    /// \return \c true if the encoding was intact; \p State is then a valid
+    ///     current-version SessionState.
+    ///
+    static bool decode(const std::uint8_t *pBuffer, std::size_t nBuffer, SessionState &State)
+        {
+        if (! beginDecode(pBuffer, nBuffer, kFormatEUlike, State))
+            return false;
+
+        auto &ch = reinterpret_cast<Channels_t &>(State.V1.Channels);
+        BitReader_t reader { pBuffer + 1, nBuffer - 1 };
+
+        decodeCommon(reader, State);
+        ch.Header.Tag = SessionChannelMask_Header::kEUlike;
+        ch.Header.Size = sizeof(Channels_t);
+        ch.ChannelMap = std::uint16_t(reader.get(16));
+        ch.ChannelShuffleMap = std::uint16_t(reader.get(16));
+
+        for (unsigned iCh = 0; iCh < a_nCh; ++iCh)
+            {
+            if (! reader.get(1))
+                continue;
+
+            auto const freq = reader.getFrequency();
+
+            ch.setFrequency(ch.UplinkFreq, iCh, freq);
+            ch.setBand(iCh, reader.get(2));
+            ch.ChannelDrMap[iCh] = getDrMap(reader);
+            if (! reader.get(1))
+                ch.setFrequency(ch.DownlinkFreq, iCh, reader.get(1) ? freq : reader.getFrequency());
+            }
+
+        for (auto &band : ch.Bands)
+            {
+            band.txDutyDenom = std::uint16_t(reader.get(16));
+            band.txPower = std::uint8_t(reader.get(8));
+            band.lastChannel = std::uint8_t(reader.get(8));
+            band.ostimeAvail = reader.getVariable();
+            }
+
+        return endDecode(reader, pBuffer, nBuffer, State);
+        }
+
+private:
+    /// \brief write a data-rate map: a flag, then a range as two
+    ///     nibbles (lowest, highest), or else the whole map.
+    static void putDrMap(BitWriter_t &writer, std::uint16_t drMap)
+        {
+        unsigned lo = 0;
+        unsigned hi = 15;
+
+        while (lo < 16 && ! (drMap & (1u << lo)))
+            ++lo;
+        while (hi > lo && ! (drMap & (1u << hi)))
+            --hi;
+
+        bool const fRange = lo < 16 &&
+                            drMap == std::uint16_t((2u << hi) - (1u << lo));
+
+        writer.put(fRange, 1);
+        if (fRange)
+            {
+            writer.put(lo, 4);
+            writer.put(hi, 4);
+            }
+        else
+            writer.put(drMap, 16);
+        }
+
+    /// \brief read a data-rate map written by putDrMap().
+    static std::uint16_t getDrMap(BitReader_t &reader)
+        {
+        if (! reader.get(1))
+            return std::uint16_t(reader.get(16));
+
+        auto const lo = reader.get(4);
+        auto const hi = reader.get(4);
+
+        if (hi < lo)
+            return 0;
+
+        return std::uint16_t((2u << hi) - (1u << lo));
+        }
+    };
+
+/****************************************************************************\
+|
+|	US-like regions
+|
+\****************************************************************************/
+
+///
+/// \brief codec for session state with US-like channels.
+///
+/// \details
+///     Only the channel enable bits and the shuffle map are kept.
+///
+///     For US915, a joined session takes 50 bytes; the worst case is
+///     kMaxEncodedSize, 61 bytes.
+///
+template <std::uint32_t a_nCh>
+class Arduino_LoRaWAN::cSessionStateCodec<Arduino_LoRaWAN::SessionChannelMask_US_like<a_nCh>>
+    : public Arduino_LoRaWAN::cSessionStateCodecBase
+    {
+public:
+    using Channels_t = Arduino_LoRaWAN::SessionChannelMask_US_like<a_nCh>;
+
+    /// \brief bits in the shuffle map (a multiple of 16, to match the LMIC).
+    static constexpr std::size_t kShuffleBits = 8 * sizeof(Channels_t::ChannelShuffleMap);
+
+    /// \brief the largest possible encoding, in bytes.
+    static constexpr std::size_t kMaxEncodedSize =
+        kOverhead + (kCommonBits + a_nCh + kShuffleBits + 7) / 8;
+
+    /// \brief encode a session state; see the EU-like codec.
+    static std::size_t encode(const SessionState &State, std::uint8_t *pBuffer, std::size_t nBuffer)
+        {
+        if (! beginEncode(State, kFormatUSlike, pBuffer, nBuffer) ||
+            State.V1.Channels.Header.Tag != SessionChannelMask_Header::kUSlike ||
+            State.V1.Channels.Header.Size != sizeof(Channels_t))
+            return 0;
+
+        auto const &ch = reinterpret_cast<const Channels_t &>(State.V1.Channels);
+        BitWriter_t writer { pBuffer + 1, nBuffer - 1 };
+
+        encodeCommon(writer, State);
+
+        // bits past nCh are never set, so we don't keep them.
+        for (unsigned iCh = 0; iCh < 8 * sizeof(ch.ChannelMap); ++iCh)
+            {
+            bool const fEnabled = (ch.ChannelMap[iCh / 8] >> (iCh & 7)) & 1;
+
+            if (iCh < a_nCh)
+                writer.put(fEnabled, 1);
+            else if (fEnabled)
+                return 0;
+            }
+
+        for (auto const b : ch.ChannelShuffleMap)
+            writer.put(b, 8);
+
+        return endEncode(writer, pBuffer, nBuffer);
+        }
+
+    /// \brief decode a session state; see the EU-like codec.
+    static bool decode(const std::uint8_t *pBuffer, std::size_t nBuffer, SessionState &State)
+        {
+        if (! beginDecode(pBuffer, nBuffer, kFormatUSlike, State))
+            return false;
+
+        auto &ch = reinterpret_cast<Channels_t &>(State.V1.Channels);
+        BitReader_t reader { pBuffer + 1, nBuffer - 1 };
+
+        decodeCommon(reader, State);
+        ch.Header.Tag = SessionChannelMask_Header::kUSlike;
+        ch.Header.Size = sizeof(Channels_t);
+
+        for (unsigned iCh = 0; iCh < a_nCh; ++iCh)
+            ch.enable(iCh, reader.get(1) != 0);
+
+        for (auto &b : ch.ChannelShuffleMap)
+            b = std::uint8_t(reader.get(8));
+
+        return endDecode(reader, pBuffer, nBuffer, State);
+        }
+    };
+
+/****************************************************************************\
+|
+|	The codec for this build
+|
+\****************************************************************************/
+
+#if CFG_LMIC_EU_like
+/// \brief the session-state codec for the configured region.
+using Arduino_LoRaWAN_SessionStateCodec =
+    Arduino_LoRaWAN::cSessionStateCodec<decltype(Arduino_LoRaWAN::SessionChannelMask::EUlike)>;
+#elif CFG_LMIC_US_like
+/// \brief the session-state codec for the configured region.
+using Arduino_LoRaWAN_SessionStateCodec =
+    Arduino_LoRaWAN::cSessionStateCodec<decltype(Arduino_LoRaWAN::SessionChannelMask::USlike)>;
+#endif
+
+#endif /* _Arduino_LoRaWAN_SessionStateCodec_h_ */
@@ -0,0 +1,137 @@
+/*
+
+Module:	Arduino_LoRaWAN_UplinkAggregator.h
+
+Function:
+	Uplink aggregator for Arduino_LoRaWAN: packs small records into
+	a single uplink.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#ifndef _Arduino_LoRaWAN_UplinkAggregator_h_
+#define _Arduino_LoRaWAN_UplinkAggregator_h_	/* prevent multiple includes */
+
+#pragma once
+
+#include <Arduino_LoRaWAN.h>
+#include <cstdint>
+
+/****************************************************************************\
+|
+|	The uplink aggregator object
+|
+\****************************************************************************/
+
+///
+/// \brief pack small records into uplinks.
+///
+/// \details
+///     Records are appended to a pending frame. The frame is sent (with
+///     SendBufferNoCopy()) when the next record won't fit in the largest
+///     payload for the current data rate, when the oldest record in the
+///     frame reaches the maximum age, or when flush() is called.
+///
+///     Two frame buffers are used, so records can be appended while the
+///     previous frame is being transmitted.
+///
+class Arduino_LoRaWAN::cUplinkAggregator
+    {
+public:
+    cUplinkAggregator() {};
+    ~cUplinkAggregator() {};
+
+    /// \brief largest frame we'll ever build (the largest FRMPayload in any region).
+    static constexpr std::size_t kMaxFrame = 242;
+
+    ///
+    /// \brief do aggregator processing for Arduino \c setup().
+    ///
+    /// \param [in] pLoRaWAN the LoRaWAN instance to send through.
+    /// \param [in] port the LoRaWAN port for the uplinks.
+    /// \param [in] maxAgeMs maximum time (in milliseconds) a record waits
+    ///     before its frame is sent. Zero means "only when full or flushed".
+    /// \param [in] fLengthPrefix if true, each record is preceded by a byte
+    ///     giving its length, so that the receiver can split the frame.
+    ///
+    void setup(
+        Arduino_LoRaWAN *pLoRaWAN,
+        std::uint8_t port,
+        std::uint32_t maxAgeMs,
+        bool fLengthPrefix = false
+        );
+
+    /// \brief do aggregator processing for Arduino \c loop().
+    void loop();
+
+    ///
+    /// \brief append a record to the pending frame.
+    ///
+    /// \return
+    ///     \c true if the record was added. \c false if the record is too
+    ///     big for a frame, or if both frame buffers are busy.
+    ///
+    bool append(const std::uint8_t *pRecord, std::size_t nRecord);
+
+    ///
+    /// \brief send the pending frame now.
+    ///
+    /// \return
+    ///     \c true if there was nothing to send or the frame was handed to
+    ///     SendBufferNoCopy(); \c false if the previous frame is still being
+    ///     transmitted (in which case \c loop() will try again).
+    ///
+    bool flush();
+
+    /// \brief return the number of bytes in the pending frame.
+    std::size_t getPendingBytes() const
+        {
+        return this->m_frame[this->m_iFill].nData;
+        }
+
+    /// \brief return the number of frames sent successfully.
+    std::uint32_t getFramesSent() const { return this->m_nFramesSent; }
+
+    /// \brief return the number of frames that failed.
+    std::uint32_t getFramesFailed() const { return this->m_nFramesFailed; }
+
+private:
+    /// \brief a frame buffer.
+    struct Frame_t
+        {
+        cUplinkAggregator *pOwner;      ///< the aggregator that owns this frame.
+        std::uint32_t tFirst;           ///< millis() when first record was added.
+        std::uint8_t nData;             ///< number of bytes in \c data.
+        bool fBusy;                     ///< true while being transmitted.
+        std::uint8_t data[kMaxFrame];   ///< the frame contents.
+        };
+
+    Arduino_LoRaWAN *m_pLoRaWAN = nullptr;  ///< where to send frames.
+    std::uint32_t m_maxAgeMs = 0;       ///< max age of a record before flush.
+    std::uint32_t m_nFramesSent = 0;    ///< count of successful frames.
+    std::uint32_t m_nFramesFailed = 0;  ///< count of failed frames.
+    std::uint8_t m_port = 1;            ///< LoRaWAN port for uplinks.
+    bool m_fLengthPrefix = false;       ///< true to prefix records with length.
+    bool m_fFlushPending = false;       ///< true if a flush is waiting for a buffer.
+    std::uint8_t m_iFill = 0;           ///< index of frame being filled.
+    Frame_t m_frame[2];                 ///< the frame buffers.
+
+    /// \brief return the payload limit for the current data rate.
+    std::size_t getFrameLimit() const;
+
+    /// \brief completion callback for SendBufferNoCopy().
+    static void sendDone(void *pCtx, bool fSuccess);
+    };
+
+#endif /* _Arduino_LoRaWAN_UplinkAggregator_h_ */
@@ -57,18 +57,64 @@ public:
 		}
 
 	static const char *GetEventName(uint32_t ev);
+
+	/// \brief radio settings and payload limit of an uplink data rate.
+	struct DataRateInfo_t
+		{
+		uint16_t bwKHz;		///< bandwidth in kHz (0 for FSK).
+		uint8_t sf;		///< spreading factor (0 for FSK).
+		uint8_t maxPayload;	///< largest FRMPayload, in bytes.
+		};
+
+	/// \brief look up an uplink data rate for the configured region.
+	///
+	/// \param [in] dr the data rate.
+	/// \param [out] info set to the settings for \p dr.
+	///
+	/// \return \c true if \p dr is a valid uplink data rate, \c false
+	///	otherwise.
+	///
+	static bool GetUplinkDataRateInfo(uint8_t dr, DataRateInfo_t &info);
+
+	/// \brief compute time-on-air for an uplink.
+	///
+	/// \param [in] info the data rate settings.
+	/// \param [in] nPhyPayload size of the PHY payload (MHDR through MIC).
+	///
+	/// \return time-on-air in microseconds.
+	///
+	static uint32_t GetAirtimeUs(const DataRateInfo_t &info, size_t nPhyPayload);
+
+	/// \brief the radio settings of an LMIC \c rps_t, such as \c LMIC.rps.
+	///
+	/// \param [in] rps the radio parameters.
+	/// \param [out] info set to the settings; \c maxPayload is not
+	///	meaningful.
+	///
+	static void GetRpsInfo(rps_t rps, DataRateInfo_t &info);
+
+	/// \brief the PHY payload size of an uplink with \p nBuffer bytes of
+	///	data: MHDR (1), FHDR (7), FPort (1, only if there is data), and
+	///	MIC (4).
+	static size_t GetUplinkPhySize(size_t nBuffer)
+		{
+		return 12 + (nBuffer != 0 ? nBuffer + 1 : 0);
+		}
 	};
 
 /* the usual macro-based table for the strings. should be in lmic.h */
+/* ARDUINO_LORAWAN_LMIC_EV_NAMES_MZ__INIT is in Arduino_LoRaWAN_LogToken.h */
 #define	ARDUINO_LORAWAN_LMIC_EV_NAMES__BASE	EV_SCAN_TIMEOUT
 
-#define	ARDUINO_LORAWAN_LMIC_EV_NAMES_MZ__INIT			\
-	 "SCAN_TIMEOUT\0" "BEACON_FOUND\0" "BEACON_MISSED\0"	\
-	 "BEACON_TRACKED\0" "JOINING\0" "JOINED\0" "RFU1\0"	\
-	 "JOIN_FAILED\0" "REJOIN_FAILED\0" "TXCOMPLETE\0"	\
-	 "LOST_TSYNC\0" "RESET\0" "RXCOMPLETE\0" "LINK_DEAD\0"	\
-	 "LINK_ALIVE\0" "SCAN_FOUND\0" "TXSTART\0"		\
-	 "TXCANCELED\0" "RXSTART\0" "JOIN_TXCOMPLETE\0"
+/* the argument for "%s" to log an event name; just the index if tokenized */
+#if ARDUINO_LORAWAN_CFG_LOG_TOKENIZED
+# define ARDUINO_LORAWAN_LOG_EVENT_NAME(a_ev)				\
+	(Arduino_LoRaWAN_LogToken::EventName_t				\
+		{ uint8_t((a_ev) - ARDUINO_LORAWAN_LMIC_EV_NAMES__BASE) })
+#else
+# define ARDUINO_LORAWAN_LOG_EVENT_NAME(a_ev)				\
+	(Arduino_LoRaWAN::cLMIC::GetEventName(a_ev))
+#endif
 
 /**** end of Arduino_LoRaWAN_lmic.h ****/
 #endif /* _ARDUINO_LORAWAN_LMIC_H_ */
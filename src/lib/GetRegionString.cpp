@@ -18,6 +18,48 @@ Author:
 #include <Arduino_LoRaWAN_lmic.h>
 #include <mcciadk_baselib.h>
 
+namespace {
+
+struct RegionName_t
+        {
+        Arduino_LoRaWAN::Region id;
+        const char *pName;
+        };
+
+// indexed by Region, which is the LMIC's region code.
+constexpr RegionName_t kRegionNames[] =
+        {
+        { Arduino_LoRaWAN::Region::unknown,     "<<unknown>>" },
+        { Arduino_LoRaWAN::Region::eu868,       "eu868" },
+        { Arduino_LoRaWAN::Region::us915,       "us915" },
+        { Arduino_LoRaWAN::Region::cn783,       "cn783" },
+        { Arduino_LoRaWAN::Region::eu433,       "eu433" },
+        { Arduino_LoRaWAN::Region::au915,       "au915" },
+        { Arduino_LoRaWAN::Region::cn490,       "cn490" },
+        { Arduino_LoRaWAN::Region::as923,       "as923" },
+        { Arduino_LoRaWAN::Region::kr920,       "kr920" },
+        { Arduino_LoRaWAN::Region::in866,       "in866" },
+        };
+
+static_assert(Arduino_LoRaWAN_NameTable::isIndexed(kRegionNames),
+        "kRegionNames is out of order");
+static_assert(Arduino_LoRaWAN_NameTable::size(kRegionNames) ==
+                std::size_t(Arduino_LoRaWAN::Region::in866) + 1,
+        "kRegionNames needs an entry for every Region");
+
+// GetRegion() just converts CFG_region, so the codes must match.
+static_assert(unsigned(Arduino_LoRaWAN::Region::eu868) == LMIC_REGION_eu868, "Region::eu868 is wrong");
+static_assert(unsigned(Arduino_LoRaWAN::Region::us915) == LMIC_REGION_us915, "Region::us915 is wrong");
+static_assert(unsigned(Arduino_LoRaWAN::Region::cn783) == LMIC_REGION_cn783, "Region::cn783 is wrong");
+static_assert(unsigned(Arduino_LoRaWAN::Region::eu433) == LMIC_REGION_eu433, "Region::eu433 is wrong");
+static_assert(unsigned(Arduino_LoRaWAN::Region::au915) == LMIC_REGION_au915, "Region::au915 is wrong");
+static_assert(unsigned(Arduino_LoRaWAN::Region::cn490) == LMIC_REGION_cn490, "Region::cn490 is wrong");
+static_assert(unsigned(Arduino_LoRaWAN::Region::as923) == LMIC_REGION_as923, "Region::as923 is wrong");
+static_assert(unsigned(Arduino_LoRaWAN::Region::kr920) == LMIC_REGION_kr920, "Region::kr920 is wrong");
+static_assert(unsigned(Arduino_LoRaWAN::Region::in866) == LMIC_REGION_in866, "Region::in866 is wrong");
+
+} // namespace
+
 const char *
 Arduino_LoRaWAN::GetRegionString(char *pBuf, size_t nBuf) const
         {
@@ -29,24 +71,12 @@ Arduino_LoRaWAN::GetRegionString(char *pBuf, size_t nBuf) const
 
         const char *pString;
 
-        switch (CFG_region)
-                {
-        case LMIC_REGION_eu868: pString = "eu868"; break;
-        case LMIC_REGION_us915: pString = "us915"; break;
-        case LMIC_REGION_cn783: pString = "cn783"; break;
-        case LMIC_REGION_eu433: pString = "eu433"; break;
-        case LMIC_REGION_au915: pString = "au915"; break;
-        case LMIC_REGION_cn490: pString = "cn490"; break;
-        case LMIC_REGION_as923:
-                if (LMIC_COUNTRY_CODE == LMIC_COUNTRY_CODE_JP)
-                        pString = "as923jp";
-                else
-                        pString = "as923";
-                break;
-        case LMIC_REGION_kr920: pString = "kr920"; break;
-        case LMIC_REGION_in866: pString = "in866"; break;
-        default:                pString = "<<unknown>>"; break;
-                }
+        if (CFG_region == LMIC_REGION_as923 && LMIC_COUNTRY_CODE == LMIC_COUNTRY_CODE_JP)
+                pString = "as923jp";
+        else if (unsigned(CFG_region) < Arduino_LoRaWAN_NameTable::size(kRegionNames))
+                pString = kRegionNames[CFG_region].pName;
+        else
+                pString = kRegionNames[0].pName;
 
         (void) McciAdkLib_SafeCopyString(pBuf, nBuf, 0, pString);
         return pBuf;
@@ -72,6 +72,10 @@ Description:
         a message in the Arduino_LoRaWAN queue being processed,
         then transmit is not ready. Otherwise, transmit is ready.
 
+        Even if transmit is not ready, SendBuffer() will accept
+        messages until the uplink queue is full; see
+        GetUplinkQueueFree().
+
 Returns:
         true if ready for a message, false otherwise.
 
@@ -81,6 +85,8 @@ bool Arduino_LoRaWAN::GetTxReady() const
         {
         if (LMIC.opmode & OP_TXRXPEND)
                 return false;
+        else if (this->m_nUplinkQueue != 0)
+                return false;
         else
                 return ! this->m_SendBufferData.fTxPending;
         }
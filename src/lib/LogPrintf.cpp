@@ -3,7 +3,7 @@
 Module:  LogPrintf.cpp
 
 Function:
-	Arduino_LoRaWAN::LogPrintf()
+	Arduino_LoRaWAN::LogPrintf() and friends: output to the log port.
 
 Copyright notice:
 	This file copyright (C) 2016, 2019 by
@@ -22,10 +22,13 @@ Author:
 */
 
 #include <Arduino_LoRaWAN.h>
+#include <Arduino_LoRaWAN_lmic.h>
 
 #include <Arduino.h>
+#include <ctype.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 #include <type_traits>
 
 // Some Adafruit BSPs implement Serial.dtr(), which immediately returns true if
@@ -76,6 +79,305 @@ static bool CheckDtr(TMap& m)
 		);
 	}
 
+/****************************************************************************\
+|
+|	Deferred messages
+|
+\****************************************************************************/
+
+// When ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE is non-zero, LogPrintf() doesn't
+// format anything. It saves a record holding the format pointer and the
+// raw argument values, and loop() formats and prints it later. Formats
+// must therefore be string constants (as they are for ARDUINO_LORAWAN_PRINTF);
+// "%s" arguments are copied, since they are often on the stack.
+//
+// The format is scanned at both ends to find the argument types, so no
+// type information is stored. Each record is:
+//
+//	uint16_t nRecord; const char *fmt; argument values...
+//
+// Records don't wrap; a zero length (or no room for one) at the end of
+// the buffer means "continue at the start". Records are never longer
+// than kLogRecordMax, so the top bit of nRecord is free; it's set if
+// the arguments didn't all fit.
+
+#if ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE != 0
+
+namespace {
+
+enum class LogArg_t : uint8_t
+	{
+	kNone,		// no argument: "%%", or a conversion we don't know.
+	kInt,
+	kLong,
+	kLongLong,
+	kSize,
+	kIntmax,
+	kPtrdiff,
+	kDouble,
+	kLongDouble,
+	kPointer,
+	kString,
+	kIgnore,	// "%n" or "%ls": a pointer is consumed, nothing is printed.
+	};
+
+struct LogSpec_t
+	{
+	const char *pBegin;	// the '%'
+	size_t nSpec;		// length of the conversion, including the '%'
+	unsigned nStars;	// number of '*' width/precision arguments
+	LogArg_t arg;		// the type of the argument
+	};
+
+// longest string argument we keep, not counting the '\0'.
+constexpr size_t kLogStringMax = 32;
+
+// flag in nRecord: the arguments were truncated.
+constexpr uint16_t kLogRecordTruncated = 0x8000;
+
+// find the next conversion at or after fmt; false if there are no more.
+bool LogNextSpec(const char *fmt, LogSpec_t &spec)
+	{
+	const char *p = strchr(fmt, '%');
+
+	if (p == nullptr)
+		return false;
+
+	spec.pBegin = p++;
+	spec.nStars = 0;
+
+	while (*p != '\0' && strchr("-+ #0", *p) != nullptr)
+		++p;
+
+	if (*p == '*')
+		{
+		++spec.nStars;
+		++p;
+		}
+	else while (isdigit((unsigned char) *p))
+		++p;
+
+	if (*p == '.')
+		{
+		++p;
+		if (*p == '*')
+			{
+			++spec.nStars;
+			++p;
+			}
+		else while (isdigit((unsigned char) *p))
+			++p;
+		}
+
+	char len = 0;
+	switch (*p)
+		{
+	case 'h':
+		len = *p++;
+		if (*p == 'h')
+			++p;
+		break;
+
+	case 'l':
+		len = *p++;
+		if (*p == 'l')
+			{
+			len = 'q';
+			++p;
+			}
+		break;
+
+	case 'z': case 'j': case 't': case 'L':
+		len = *p++;
+		break;
+
+	default:
+		break;
+		}
+
+	// a '%' at the very end is printed as is.
+	if (*p == '\0')
+		return false;
+
+	switch (*p)
+		{
+	case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+		switch (len)
+			{
+		case 'l':	spec.arg = LogArg_t::kLong; break;
+		case 'q':	spec.arg = LogArg_t::kLongLong; break;
+		case 'z':	spec.arg = LogArg_t::kSize; break;
+		case 'j':	spec.arg = LogArg_t::kIntmax; break;
+		case 't':	spec.arg = LogArg_t::kPtrdiff; break;
+		default:	spec.arg = LogArg_t::kInt; break;
+			}
+		break;
+
+	case 'c':
+		spec.arg = LogArg_t::kInt;
+		break;
+
+	case 'e': case 'E': case 'f': case 'F':
+	case 'g': case 'G': case 'a': case 'A':
+		spec.arg = len == 'L' ? LogArg_t::kLongDouble : LogArg_t::kDouble;
+		break;
+
+	case 'p':
+		spec.arg = LogArg_t::kPointer;
+		break;
+
+	case 's':
+		spec.arg = len == 'l' ? LogArg_t::kIgnore : LogArg_t::kString;
+		break;
+
+	case 'n':
+		spec.arg = LogArg_t::kIgnore;
+		break;
+
+	default:
+		spec.arg = LogArg_t::kNone;
+		break;
+		}
+
+	spec.nSpec = p + 1 - spec.pBegin;
+	return true;
+	}
+
+// a record being built.
+struct LogRecord_t
+	{
+	uint8_t *pBuffer;
+	size_t nBuffer;
+	size_t n;
+	bool fTruncated;
+
+	// append a value.
+	template <typename T>
+	bool put(T v)
+		{
+		if (this->nBuffer - this->n < sizeof(v))
+			{
+			this->fTruncated = true;
+			return false;
+			}
+
+		memcpy(this->pBuffer + this->n, &v, sizeof(v));
+		this->n += sizeof(v);
+		return true;
+		}
+
+	// append a string, truncating if needed.
+	bool putString(const char *s)
+		{
+		if (s == nullptr)
+			s = "(null)";
+
+		size_t const nRoom = this->nBuffer - this->n;
+		if (nRoom == 0)
+			{
+			this->fTruncated = true;
+			return false;
+			}
+
+		size_t nString = strlen(s);
+		if (nString > kLogStringMax)
+			nString = kLogStringMax;
+		if (nString > nRoom - 1)
+			{
+			nString = nRoom - 1;
+			this->fTruncated = true;
+			}
+
+		memcpy(this->pBuffer + this->n, s, nString);
+		this->pBuffer[this->n + nString] = '\0';
+		this->n += nString + 1;
+		return true;
+		}
+	};
+
+// take a value from a record being printed.
+template <typename T>
+bool LogGet(const uint8_t *&p, const uint8_t *pEnd, T &v)
+	{
+	if (size_t(pEnd - p) < sizeof(v))
+		return false;
+
+	memcpy(&v, p, sizeof(v));
+	p += sizeof(v);
+	return true;
+	}
+
+// append text to the output line.
+void LogAppend(char *buf, size_t &nBuf, size_t sizeBuf, const char *p, size_t n)
+	{
+	if (n > sizeBuf - 1 - nBuf)
+		n = sizeBuf - 1 - nBuf;
+
+	memcpy(buf + nBuf, p, n);
+	nBuf += n;
+	buf[nBuf] = '\0';
+	}
+
+// format one argument onto the output line.
+template <typename T>
+void LogFormat(
+	char *buf, size_t &nBuf, size_t sizeBuf,
+	const char *spec, unsigned nStars, const int *pStars,
+	T v
+	)
+	{
+	int n;
+
+	if (nStars == 0)
+		n = snprintf(buf + nBuf, sizeBuf - nBuf, spec, v);
+	else if (nStars == 1)
+		n = snprintf(buf + nBuf, sizeBuf - nBuf, spec, pStars[0], v);
+	else
+		n = snprintf(buf + nBuf, sizeBuf - nBuf, spec, pStars[0], pStars[1], v);
+
+	if (n > 0)
+		{
+		nBuf += size_t(n);
+		if (nBuf > sizeBuf - 1)
+			nBuf = sizeBuf - 1;
+		}
+	}
+
+} // namespace
+
+#endif // ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE != 0
+
+/*
+
+Name:	Arduino_LoRaWAN::LogPrintf()
+
+Function:
+	Print a formatted message on Serial, now or later.
+
+Definition:
+	void Arduino_LoRaWAN::LogPrintf(
+		const char *fmt,
+		...
+		);
+
+Description:
+	Normally the message is formatted (up to 127 bytes) and printed
+	at once. That can take milliseconds, and LogPrintf() is called from
+	DispatchEvent(), on the LMIC's event path.
+
+	If ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE is non-zero, the format
+	pointer and the arguments are copied to a buffer instead, and
+	loop() prints the message when the LMIC is idle. If the buffer is
+	full, the message is counted and dropped. A record holds up to
+	kLogRecordMax bytes, the size of the line buffer; if the arguments
+	don't fit, the message is printed up to the last one that did,
+	still ending with the format's newline, and counted as truncated.
+
+Returns:
+	No explicit result.
+
+*/
+
 void
 Arduino_LoRaWAN::LogPrintf(
 	const char *fmt,
@@ -85,14 +387,352 @@ Arduino_LoRaWAN::LogPrintf(
 	if (! CheckDtr(Serial))
 		return;
 
-	char buf[128];
 	va_list ap;
 
 	va_start(ap, fmt);
+
+#if ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE != 0
+	uint8_t buffer[kLogRecordMax];
+	LogRecord_t record { buffer, sizeof(buffer), sizeof(uint16_t), false };
+	LogSpec_t spec;
+
+	(void) record.put(fmt);
+	for (const char *p = fmt; LogNextSpec(p, spec); p = spec.pBegin + spec.nSpec)
+		{
+		bool fOk = true;
+
+		for (unsigned i = 0; i < spec.nStars; ++i)
+			fOk = fOk && record.put(va_arg(ap, int));
+
+		switch (spec.arg)
+			{
+		case LogArg_t::kNone:	break;
+		case LogArg_t::kInt:	fOk = fOk && record.put(va_arg(ap, int)); break;
+		case LogArg_t::kLong:	fOk = fOk && record.put(va_arg(ap, long)); break;
+		case LogArg_t::kLongLong: fOk = fOk && record.put(va_arg(ap, long long)); break;
+		case LogArg_t::kSize:	fOk = fOk && record.put(va_arg(ap, size_t)); break;
+		case LogArg_t::kIntmax:	fOk = fOk && record.put(va_arg(ap, intmax_t)); break;
+		case LogArg_t::kPtrdiff: fOk = fOk && record.put(va_arg(ap, ptrdiff_t)); break;
+		case LogArg_t::kDouble:	fOk = fOk && record.put(va_arg(ap, double)); break;
+		case LogArg_t::kLongDouble: fOk = fOk && record.put(va_arg(ap, long double)); break;
+		case LogArg_t::kPointer: fOk = fOk && record.put(va_arg(ap, void *)); break;
+		case LogArg_t::kString:	fOk = fOk && record.putString(va_arg(ap, const char *)); break;
+		case LogArg_t::kIgnore:	(void) va_arg(ap, void *); break;
+			}
+
+		// out of room: the message is printed up to here.
+		if (! fOk)
+			break;
+		}
+
+	va_end(ap);
+
+	uint16_t const nRecord = uint16_t(record.n);
+	uint16_t const header = nRecord | (record.fTruncated ? kLogRecordTruncated : 0);
+	memcpy(buffer, &header, sizeof(header));
+
+	if (! this->LogDeferredPut(buffer, nRecord))
+		++this->m_nLogLost;
+#else
+	char buf[kLogLineMax];
+
 	(void) vsnprintf(buf, sizeof(buf) - 1, fmt, ap);
 	va_end(ap);
 
 	// in case we overflowed:
 	buf[sizeof(buf) - 1] = '\0';
 	if (CheckDtr(Serial)) Serial.print(buf);
+#endif
+	}
+
+void
+Arduino_LoRaWAN::LogWrite(
+	const uint8_t *pData,
+	size_t nData
+	)
+	{
+	if (CheckDtr(Serial)) Serial.write(pData, nData);
+	}
+
+#if ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE != 0
+
+bool
+Arduino_LoRaWAN::LogDeferredPut(
+	const uint8_t *pRecord,
+	size_t nRecord
+	)
+	{
+	size_t iHead = this->m_iLogHead;
+	size_t const iTail = this->m_iLogTail;
+
+	// iHead == iTail means empty, so the buffer is never quite filled.
+	if (iHead >= iTail)
+		{
+		if (kLogDeferredSize - iHead < nRecord + (iTail == 0))
+			{
+			// no room at the end: wrap, if there's room at the start.
+			if (iTail <= nRecord)
+				return false;
+
+			if (kLogDeferredSize - iHead >= sizeof(uint16_t))
+				memset(this->m_LogBuffer + iHead, 0, sizeof(uint16_t));
+
+			iHead = 0;
+			}
+		}
+	else if (iTail - iHead <= nRecord)
+		{
+		return false;
+		}
+
+	memcpy(this->m_LogBuffer + iHead, pRecord, nRecord);
+	iHead += nRecord;
+	if (iHead == kLogDeferredSize)
+		iHead = 0;
+
+	this->m_iLogHead = iHead;
+	return true;
+	}
+
+bool
+Arduino_LoRaWAN::LogDeferredPrintOne()
+	{
+	size_t iTail = this->m_iLogTail;
+
+	if (iTail == this->m_iLogHead)
+		{
+		if (this->m_nLogLost != this->m_nLogReported)
+			{
+			char buf[48];
+
+			snprintf(buf, sizeof(buf), "** %lu log message(s) lost\n",
+				(unsigned long)(this->m_nLogLost - this->m_nLogReported)
+				);
+			this->m_nLogReported = this->m_nLogLost;
+			if (CheckDtr(Serial)) Serial.print(buf);
+			}
+
+		return false;
+		}
+
+	uint16_t nRecord = 0;
+
+	if (kLogDeferredSize - iTail >= sizeof(nRecord))
+		memcpy(&nRecord, this->m_LogBuffer + iTail, sizeof(nRecord));
+
+	if (nRecord == 0)
+		{
+		iTail = 0;
+		memcpy(&nRecord, this->m_LogBuffer, sizeof(nRecord));
+		}
+
+	bool fTruncated = (nRecord & kLogRecordTruncated) != 0;
+
+	nRecord &= ~kLogRecordTruncated;
+
+	const uint8_t *p = this->m_LogBuffer + iTail + sizeof(nRecord);
+	const uint8_t * const pEnd = this->m_LogBuffer + iTail + nRecord;
+	const char *fmt = "";
+	char buf[kLogLineMax];
+	size_t nBuf = 0;
+	LogSpec_t spec;
+
+	buf[0] = '\0';
+	(void) LogGet(p, pEnd, fmt);
+
+	const char *pText = fmt;
+	bool fShort = false;
+
+	for (; LogNextSpec(pText, spec); pText = spec.pBegin + spec.nSpec)
+		{
+		LogAppend(buf, nBuf, sizeof(buf), pText, spec.pBegin - pText);
+
+		int stars[2];
+		bool fOk = true;
+
+		for (unsigned i = 0; i < spec.nStars; ++i)
+			fOk = fOk && LogGet(p, pEnd, stars[i]);
+
+		// the spec is used as a format by itself.
+		char subfmt[24];
+		bool const fSubfmt = spec.nSpec < sizeof(subfmt);
+
+		if (fSubfmt)
+			{
+			memcpy(subfmt, spec.pBegin, spec.nSpec);
+			subfmt[spec.nSpec] = '\0';
+			}
+
+		union
+			{
+			int i;
+			long l;
+			long long ll;
+			size_t z;
+			intmax_t j;
+			ptrdiff_t t;
+			double d;
+			long double ld;
+			void *ptr;
+			} v;
+
+		switch (spec.arg)
+			{
+		case LogArg_t::kNone:
+			if (spec.pBegin[spec.nSpec - 1] == '%')
+				LogAppend(buf, nBuf, sizeof(buf), "%", 1);
+			else
+				LogAppend(buf, nBuf, sizeof(buf), spec.pBegin, spec.nSpec);
+			break;
+
+#define ARDUINO_LORAWAN_LOG_FORMAT_(a_type, a_field)					\
+			fOk = fOk && LogGet(p, pEnd, v.a_field);			\
+			if (fOk && fSubfmt)						\
+				LogFormat<a_type>(buf, nBuf, sizeof(buf), subfmt,	\
+					spec.nStars, stars, v.a_field);			\
+			break
+
+		case LogArg_t::kInt:	ARDUINO_LORAWAN_LOG_FORMAT_(int, i);
+		case LogArg_t::kLong:	ARDUINO_LORAWAN_LOG_FORMAT_(long, l);
+		case LogArg_t::kLongLong: ARDUINO_LORAWAN_LOG_FORMAT_(long long, ll);
+		case LogArg_t::kSize:	ARDUINO_LORAWAN_LOG_FORMAT_(size_t, z);
+		case LogArg_t::kIntmax:	ARDUINO_LORAWAN_LOG_FORMAT_(intmax_t, j);
+		case LogArg_t::kPtrdiff: ARDUINO_LORAWAN_LOG_FORMAT_(ptrdiff_t, t);
+		case LogArg_t::kDouble:	ARDUINO_LORAWAN_LOG_FORMAT_(double, d);
+		case LogArg_t::kLongDouble: ARDUINO_LORAWAN_LOG_FORMAT_(long double, ld);
+		case LogArg_t::kPointer: ARDUINO_LORAWAN_LOG_FORMAT_(void *, ptr);
+
+#undef ARDUINO_LORAWAN_LOG_FORMAT_
+
+		case LogArg_t::kString:
+			{
+			const char * const s = (const char *) p;
+			const size_t n = strnlen(s, pEnd - p);
+
+			fOk = fOk && n < size_t(pEnd - p);
+			if (fOk)
+				{
+				p += n + 1;
+				if (fSubfmt)
+					LogFormat<const char *>(buf, nBuf, sizeof(buf), subfmt,
+						spec.nStars, stars, s);
+				}
+			}
+			break;
+
+		case LogArg_t::kIgnore:
+			break;
+			}
+
+		// truncated when saved.
+		if (! fOk)
+			{
+			fShort = true;
+			break;
+			}
+		}
+
+	if (! fShort)
+		LogAppend(buf, nBuf, sizeof(buf), pText, strlen(pText));
+
+	// a line that didn't fit still ends the way the format does, so
+	// the next message starts on a line of its own.
+	if (fTruncated || fShort || nBuf == sizeof(buf) - 1)
+		{
+		size_t const nFmt = strlen(fmt);
+
+		++this->m_nLogTruncated;
+		if (nFmt != 0 && fmt[nFmt - 1] == '\n' &&
+		    (nBuf == 0 || buf[nBuf - 1] != '\n'))
+			{
+			if (nBuf == sizeof(buf) - 1)
+				--nBuf;
+			buf[nBuf++] = '\n';
+			buf[nBuf] = '\0';
+			}
+		}
+
+	this->m_iLogTail = iTail + nRecord == kLogDeferredSize ? 0 : iTail + nRecord;
+
+	if (CheckDtr(Serial)) Serial.print(buf);
+	return true;
+	}
+
+/*
+
+Name:	Arduino_LoRaWAN::ProcessDeferredLog()
+
+Function:
+	Print deferred LogPrintf() messages while the LMIC is idle.
+
+Definition:
+	void Arduino_LoRaWAN::ProcessDeferredLog(
+		void
+		);
+
+Description:
+	Called from loop(). Like cEventLog::loop(), we print nothing while
+	a transmit/receive is in progress, and stop if an LMIC job is due
+	soon or we've been printing for too long.
+
+Returns:
+	No explicit result.
+
+*/
+
+void
+Arduino_LoRaWAN::ProcessDeferredLog()
+	{
+	if ((LMIC.opmode & OP_TXRXPEND) != 0)
+		return;
+
+	auto const tStart = os_getTime();
+	auto const tLimit = ms2osticks(kLogDrainLimitMs);
+	auto const tGuard = ms2osticks(kLogGuardMs);
+
+	do	{
+		if (os_queryTimeCriticalJobs(tGuard))
+			break;
+
+		if (! this->LogDeferredPrintOne())
+			break;
+		} while (os_getTime() - tStart < tLimit);
 	}
+
+void
+Arduino_LoRaWAN::FlushLog()
+	{
+	while (this->LogDeferredPrintOne())
+		/* loop */;
+	}
+
+#else // ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE == 0
+
+bool
+Arduino_LoRaWAN::LogDeferredPut(
+	const uint8_t *pRecord,
+	size_t nRecord
+	)
+	{
+	MCCIADK_API_PARAMETER(pRecord);
+	MCCIADK_API_PARAMETER(nRecord);
+	return false;
+	}
+
+bool
+Arduino_LoRaWAN::LogDeferredPrintOne()
+	{
+	return false;
+	}
+
+void
+Arduino_LoRaWAN::ProcessDeferredLog()
+	{
+	}
+
+void
+Arduino_LoRaWAN::FlushLog()
+	{
+	}
+
+#endif // ARDUINO_LORAWAN_CFG_LOG_DEFERRED_SIZE
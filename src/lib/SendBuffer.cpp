@@ -40,7 +40,6 @@ Revision history:
 |
 \****************************************************************************/
 
-static lmic_txmessage_cb_t localSendBufferCb;
 
 /****************************************************************************\
 |
@@ -75,7 +74,20 @@ Definition:
                 SendBufferCbFn *pDoneFn,
                 void *pDoneCtx,
                 bool fConfirmed = false,
-                uint8_t port = 1
+                uint8_t port = 1,
+                UplinkPriority priority = UplinkPriority::kNormal,
+                uint32_t tDeadline = 0
+                );
+
+        public bool Arduino_LoRaWAN::SendBufferNoCopy(
+                const uint8_t *pBuffer,
+                size_t nBuffer,
+                SendBufferCbFn *pDoneFn,
+                void *pDoneCtx,
+                bool fConfirmed = false,
+                uint8_t port = 1,
+                UplinkPriority priority = UplinkPriority::kNormal,
+                uint32_t tDeadline = 0
                 );
 
 Description:
@@ -88,8 +100,26 @@ Description:
         transmitted. For unconfirmed uplinks, as long as we sent the message, we
         return true. (Uplinks might be canceled due to link tracking or other issues.)
 
-        If the LMIC is already processing a message, then the request
-        is immediately completed, and this routine returns false.
+        If the LMIC is already processing a message, or if other messages
+        are already waiting, the message is placed in the uplink queue,
+        and is sent when the messages ahead of it have completed. SendBuffer()
+        copies the message into the queue entry, so the message must not be
+        longer than ARDUINO_LORAWAN_CFG_UPLINK_QUEUE_BUFFER_SIZE bytes.
+        SendBufferNoCopy() doesn't copy; the caller must keep the buffer
+        valid and unchanged until pDoneFn is called. If the queue is full,
+        or the message is too long, the request is immediately completed,
+        and this routine returns false.
+
+        Queued messages are sent in order of priority, and in order of
+        arrival within a priority. If the queue is full, a message
+        can displace the newest of the lowest-priority messages waiting,
+        as long as that priority is lower than its own; the displaced
+        message is completed with fSuccess false.
+
+        If tDeadline is not zero, it's the os_getTime() value after which
+        the message is no longer worth sending. A message that is still
+        waiting at that time is completed with fSuccess false without
+        being transmitted.
 
         We guarantee that pDoneFn will be called once, when message
         processing is complete.
@@ -98,8 +128,8 @@ Returns:
         The result is not very useful, because of the guarantees around
         completion processing. However, if false, then the transmit failed,
         and the completion routine has already been called. If true, then
-        the transmit was started; the completion routine might already have
-        been called.  We don't recommend using this result.
+        the transmit was started or queued; the completion routine might
+        already have been called.  We don't recommend using this result.
 
 */
 
@@ -110,16 +140,79 @@ bool Arduino_LoRaWAN::SendBuffer(
         SendBufferCbFn *pDoneFn,
         void *pDoneCtx,
 	bool fConfirmed,
-	uint8_t port
+	uint8_t port,
+        UplinkPriority priority,
+        uint32_t tDeadline
         )
         {
-        if (! this->GetTxReady())
-                {
-                if (pDoneFn)
-                        (*pDoneFn)(pDoneCtx, false);
-                return false;
-                }
+        ARDUINO_LORAWAN_PROBE_END_INTERVAL(this->m_Probes, TxCompleteToSendBuffer);
+        ARDUINO_LORAWAN_PROBE_SCOPE(this->m_Probes, SendBuffer);
+
+        return this->QueueUplink(
+                pBuffer, nBuffer, pDoneFn, pDoneCtx, fConfirmed, port,
+                priority, tDeadline,
+                /* fCopy */ true
+                );
+        }
+
+bool Arduino_LoRaWAN::SendBufferNoCopy(
+        const uint8_t *pBuffer,
+        size_t nBuffer,
+        SendBufferCbFn *pDoneFn,
+        void *pDoneCtx,
+        bool fConfirmed,
+        uint8_t port,
+        UplinkPriority priority,
+        uint32_t tDeadline
+        )
+        {
+        ARDUINO_LORAWAN_PROBE_END_INTERVAL(this->m_Probes, TxCompleteToSendBuffer);
+        ARDUINO_LORAWAN_PROBE_SCOPE(this->m_Probes, SendBuffer);
+
+        return this->QueueUplink(
+                pBuffer, nBuffer, pDoneFn, pDoneCtx, fConfirmed, port,
+                priority, tDeadline,
+                /* fCopy */ false
+                );
+        }
+
+/*
+
+Name:   Arduino_LoRaWAN::SubmitUplink()
+
+Function:
+        Hand a message directly to the LMIC.
+
+Definition:
+        private bool Arduino_LoRaWAN::SubmitUplink(
+                const uint8_t *pBuffer,
+                size_t nBuffer,
+                SendBufferCbFn *pDoneFn,
+                void *pDoneCtx,
+                bool fConfirmed,
+                uint8_t port
+                );
+
+Description:
+        The message is passed to LMIC_sendWithCallback(), which copies
+        the data. The caller must already have checked that the LMIC
+        is idle. If the LMIC refuses the message, pDoneFn is called
+        with fSuccess false.
+
+Returns:
+        true if the message was accepted by the LMIC, false otherwise.
+
+*/
 
+bool Arduino_LoRaWAN::SubmitUplink(
+        const uint8_t *pBuffer,
+        size_t nBuffer,
+        SendBufferCbFn *pDoneFn,
+        void *pDoneCtx,
+        bool fConfirmed,
+        uint8_t port
+        )
+        {
         this->m_SendBufferData.pDoneFn = pDoneFn;
         this->m_SendBufferData.pDoneCtx = pDoneCtx;
         this->m_SendBufferData.fTxPending = true;
@@ -130,7 +223,7 @@ bool Arduino_LoRaWAN::SendBuffer(
                                 const_cast<xref2u1_t>(pBuffer),
                                 nBuffer,
                                 /* confirmed? */ fConfirmed,
-                                localSendBufferCb,
+                                Arduino_LoRaWAN::SendBufferCb,
                                 (void *)&this->m_SendBufferData
                                 );
 
@@ -148,8 +241,32 @@ bool Arduino_LoRaWAN::SendBuffer(
                 }
         }
 
-static void
-localSendBufferCb(
+/*
+
+Name:   Arduino_LoRaWAN::SendBufferCb()
+
+Function:
+        LMIC completion callback for messages sent by SendBuffer().
+
+Definition:
+        private static lmic_txmessage_cb_t Arduino_LoRaWAN::SendBufferCb;
+
+Description:
+        The client's completion function is called, and then the next
+        message (if any) in the uplink queue is started.
+
+        The LMIC reports EV_TXCOMPLETE to onEvent() before calling this
+        function, and it clears its reference to this callback just
+        before the call. So this is the first point where another
+        message can be handed to the LMIC without the LMIC attributing
+        the current completion to the new message.
+
+Returns:
+        No explicit result.
+
+*/
+
+void Arduino_LoRaWAN::SendBufferCb(
         void *pUserData,
         int fSuccess
         )
@@ -165,4 +282,6 @@ localSendBufferCb(
                 pSendBufferData->pDoneFn = nullptr;
                 pDoneFn(pSendBufferData->pDoneCtx, fSuccess);
                 }
+
+        pSendBufferData->pSelf->ProcessUplinkQueue();
         }
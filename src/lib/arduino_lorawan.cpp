@@ -65,3 +65,6 @@ Revision history:
 Arduino_LoRaWAN::Arduino_LoRaWAN()
         {
         }
+
+// the definition of the table; the initializer is in the class.
+constexpr Arduino_LoRaWAN::NetworkName_t Arduino_LoRaWAN::kNetworkNames[];
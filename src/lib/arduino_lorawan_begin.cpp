@@ -21,7 +21,7 @@ Author:
 #include <hal/hal.h>
 
 /* the global instance pointer */
-Arduino_LoRaWAN *Arduino_LoRaWAN::pLoRaWAN = NULL;
+ARDUINO_LORAWAN_INSTANCE_STORAGE_ Arduino_LoRaWAN *Arduino_LoRaWAN::pLoRaWAN = NULL;
 
 // if called with no arguments, ask the library
 bool Arduino_LoRaWAN::begin()
@@ -39,6 +39,10 @@ bool Arduino_LoRaWAN::begin(
 
     Arduino_LoRaWAN::pLoRaWAN = this;
 
+#if ARDUINO_LORAWAN_CFG_PROBES
+    Arduino_LoRaWAN_Probes::beginCounter();
+#endif
+
     // Initialize the LMIC -- need to pass a void* pointer through to the HAL,
     // but it must point to an instance of ArduinoLMIC::HalConfiguration_t.
     if (! os_init_ex(pPinmap))
@@ -106,6 +110,18 @@ void onEvent(ev_t ev)
 
     ASSERT(pLoRaWAN != NULL);
 
+#if ARDUINO_LORAWAN_CFG_PROBES
+    std::uint32_t tIrq;
+
+    if (Arduino_LoRaWAN_Probes::takeIrq(tIrq))
+        pLoRaWAN->GetProbes().addSample(
+            Arduino_LoRaWAN_Probes::ProbeId::IrqToEvent,
+            Arduino_LoRaWAN_Probes::readCounter() - tIrq
+            );
+#endif
+
+    ARDUINO_LORAWAN_PROBE_SCOPE(pLoRaWAN->GetProbes(), OnEvent);
+
     pLoRaWAN->DispatchEvent(ev);
     }
 
@@ -113,10 +129,15 @@ void Arduino_LoRaWAN::DispatchEvent(
     uint32_t ev
     )
     {
+    ARDUINO_LORAWAN_PROBE_SCOPE(this->m_Probes, DispatchEvent);
+
+    if (ev == EV_TXCOMPLETE)
+        ARDUINO_LORAWAN_PROBE_BEGIN_INTERVAL(this->m_Probes, TxCompleteToSendBuffer);
+
     ARDUINO_LORAWAN_PRINTF(
         LogVerbose,
         "EV_%s\n",
-        cLMIC::GetEventName(ev)
+        ARDUINO_LORAWAN_LOG_EVENT_NAME(ev)
         );
 
     // do the usual work in another function, for clarity.
@@ -151,35 +172,69 @@ bool Arduino_LoRaWAN::RegisterListener(
         }
     }
 
-const char *
-Arduino_LoRaWAN::cLMIC::GetEventName(uint32_t ev)
+namespace {
+
+constexpr char szEventNames[] = ARDUINO_LORAWAN_LMIC_EV_NAMES_MZ__INIT;
+
+// the position of each name in ARDUINO_LORAWAN_LMIC_EV_NAMES().
+#define	ARDUINO_LORAWAN_LMIC_EV_NAME_INDEX_(a_name)	kEventIndex_##a_name,
+enum : unsigned
     {
-    static const char szEventNames[] = ARDUINO_LORAWAN_LMIC_EV_NAMES_MZ__INIT;
-    const char *p;
+    ARDUINO_LORAWAN_LMIC_EV_NAMES(ARDUINO_LORAWAN_LMIC_EV_NAME_INDEX_)
+    kEventNameCount
+    };
+#undef	ARDUINO_LORAWAN_LMIC_EV_NAME_INDEX_
+
+// each name must be at the position of its event code.
+#define	ARDUINO_LORAWAN_LMIC_EV_NAME_CHECK_(a_name)			\
+    static_assert(EV_##a_name - ARDUINO_LORAWAN_LMIC_EV_NAMES__BASE ==	\
+                  kEventIndex_##a_name,					\
+                  "event name table doesn't match EV_" #a_name);
+ARDUINO_LORAWAN_LMIC_EV_NAMES(ARDUINO_LORAWAN_LMIC_EV_NAME_CHECK_)
+#undef	ARDUINO_LORAWAN_LMIC_EV_NAME_CHECK_
+
+static_assert(sizeof(szEventNames) <= 256, "event names don't fit uint8_t offsets");
+
+// offset of each name in szEventNames, computed at compile time.
+#define	ARDUINO_LORAWAN_LMIC_EV_NAME_OFFSET_(a_name)			\
+    uint8_t(Arduino_LoRaWAN_NameTable::multiSzOffset(szEventNames, kEventIndex_##a_name)),
+constexpr uint8_t kEventNameOffsets[] =
+    {
+    ARDUINO_LORAWAN_LMIC_EV_NAMES(ARDUINO_LORAWAN_LMIC_EV_NAME_OFFSET_)
+    };
+#undef	ARDUINO_LORAWAN_LMIC_EV_NAME_OFFSET_
 
-    if (ev < ARDUINO_LORAWAN_LMIC_EV_NAMES__BASE)
-        return "<<unknown>>";
+static_assert(
+    Arduino_LoRaWAN_NameTable::equal(
+        szEventNames + kEventNameOffsets[kEventIndex_JOIN_TXCOMPLETE],
+        "JOIN_TXCOMPLETE"
+        ),
+    "event name offsets are wrong"
+    );
 
-    p = McciAdkLib_MultiSzIndex(
-        szEventNames,
-        ev - ARDUINO_LORAWAN_LMIC_EV_NAMES__BASE
-        );
+} // namespace
 
-    if (*p == '\0')
+const char *
+Arduino_LoRaWAN::cLMIC::GetEventName(uint32_t ev)
+    {
+    if (ev < ARDUINO_LORAWAN_LMIC_EV_NAMES__BASE ||
+        ev - ARDUINO_LORAWAN_LMIC_EV_NAMES__BASE >= kEventNameCount)
         return "<<unknown>>";
-    else
-        return p;
+
+    return szEventNames + kEventNameOffsets[ev - ARDUINO_LORAWAN_LMIC_EV_NAMES__BASE];
     }
 
 void
 Arduino_LoRaWAN::SaveSessionInfo()
     {
     SessionInfo Info;
-    Info.V1.Tag = kSessionInfoTag_V2;
-    Info.V1.Size = sizeof(Info);
-    Info.V1.Rsv2 = 0;
-    Info.V1.Rsv3 = 0;
-    LMIC_getSessionKeys(&Info.V1.NetID, &Info.V1.DevAddr, Info.V1.NwkSKey, Info.V1.AppSKey);
+
+    // zero the whole thing, so the bytes past V3 are always the same.
+    memset(&Info, 0, sizeof(Info));
+    Info.V3.Tag = kSessionInfoTag_V3;
+    Info.V3.Size = sizeof(Info);
+    LMIC_getSessionKeys(&Info.V3.NetID, &Info.V3.DevAddr, Info.V3.NwkSKey, Info.V3.AppSKey);
+    Info.V3.Crc = Info.computeCrc();
     this->NetSaveSessionInfo(Info, nullptr, 0);
     }
 
@@ -213,6 +268,9 @@ void Arduino_LoRaWAN::StandardEventProcessor(
     // update our idea of the downlink counter.
     this->UpdateFCntDown(LMIC.seqnoDn);
 
+    // account for radio-on time.
+    this->UpdateEnergy(ev);
+
     switch(ev)
         {
         case EV_SCAN_TIMEOUT:
@@ -234,6 +292,7 @@ void Arduino_LoRaWAN::StandardEventProcessor(
             this->SaveSessionInfo();
 
             // save everything else of interest.
+            this->MarkSessionStateDirty(kSessionStateDirty_Config);
             this->SaveSessionState();
             }
             break;
@@ -247,6 +306,7 @@ void Arduino_LoRaWAN::StandardEventProcessor(
             this->SaveSessionInfo();
 
             // save everything else of interest.
+            this->MarkSessionStateDirty(kSessionStateDirty_Config);
             this->SaveSessionState();
             }
             break;
@@ -270,14 +330,29 @@ void Arduino_LoRaWAN::StandardEventProcessor(
             break;
 
         case EV_TXCOMPLETE:
+            // the counters change on every uplink. The configuration only
+            // changes with a downlink (MAC commands), or with ADR backoff,
+            // which changes the data rate or power (and perhaps channels).
+            this->MarkSessionStateDirty(kSessionStateDirty_Counters);
+            if ((LMIC.txrxFlags & (TXRX_DNW1 | TXRX_DNW2)) != 0 ||
+                LMIC.datarate != this->m_savedSessionState.V1.LinkDR ||
+                LMIC.adrTxPow != this->m_savedSessionState.V1.TxPower)
+                this->MarkSessionStateDirty(kSessionStateDirty_Config);
+
             this->SaveSessionState();
 
             // notify framework that RX may be available (because this happens
             // after every transmit).
+            {
+            ARDUINO_LORAWAN_PROBE_SCOPE(this->m_Probes, NetRxComplete);
             this->NetRxComplete();
+            }
 
             // notify framework that tx is complete
             this->NetTxComplete();
+
+            // the uplink queue is not drained here: the LMIC hasn't yet
+            // called the SendBuffer() completion. See ProcessUplinkQueue().
             break;
 
         case EV_LOST_TSYNC:
@@ -292,16 +367,21 @@ void Arduino_LoRaWAN::StandardEventProcessor(
             // If we're configured for ABP, we're done; but if we're configured for OTAA, we'll
             // rejoin and the session data will be saved (again) at EV_JOIN.
             this->NetBeginRegionInit();
+            this->MarkSessionStateDirty(kSessionStateDirty_Config);
             this->SaveSessionState();
             break;
 
         case EV_RXCOMPLETE:
             // data received in ping slot
             // see TXCOMPLETE.
+            this->MarkSessionStateDirty(kSessionStateDirty_Config);
             this->SaveSessionState();
 
             // follow protocol:
+            {
+            ARDUINO_LORAWAN_PROBE_SCOPE(this->m_Probes, NetRxComplete);
             this->NetRxComplete();
+            }
             break;
 
         case EV_LINK_DEAD:
@@ -317,6 +397,7 @@ void Arduino_LoRaWAN::StandardEventProcessor(
             break;
 
         case EV_TXCANCELED:
+            this->MarkSessionStateDirty(kSessionStateDirty_Config);
             this->SaveSessionState();
             break;
 
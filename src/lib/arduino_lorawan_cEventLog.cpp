@@ -3,7 +3,7 @@
 Module:	arduino_lorawan_cEventLog.cpp
 
 Function:
-	Arduino_LoRaWAN::cEventLog methods.
+	Arduino_LoRaWAN::cEventLogBase methods.
 
 Copyright and License:
 	This file copyright (C) 2021 by
@@ -22,32 +22,252 @@ Author:
 #include <Arduino_LoRaWAN_EventLog.h>
 #include <arduino_lmic.h>
 
+// typed events must not make the nodes bigger: on 32-bit targets, a node
+// is the time, two pointers and three data words.
+static_assert(
+    sizeof(void *) != 4 || sizeof(Arduino_LoRaWAN::cEventLogBase::EventNode_t) == 24,
+    "EventNode_t should be 24 bytes"
+    );
+
 /****************************************************************************\
 |
 |	Log methods
 |
 \****************************************************************************/
 
+Arduino_LoRaWAN::cEventLogBase::cEventLogBase(
+    EventNode_t *pQueue,
+    unsigned *pSeq,
+    unsigned nCapacity
+    )
+    : m_pQueue(pQueue)
+    , m_pSeq(pSeq)
+    , m_mask(nCapacity - 1)
+    {
+#if ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    for (unsigned i = 0; i < nCapacity; ++i)
+        this->m_pSeq[i] = i;
+#endif
+    }
+
 void
-Arduino_LoRaWAN::cEventLog::setup()
+Arduino_LoRaWAN::cEventLogBase::setup()
     {
     // no setup needed.
     }
 
+/*
+
+Name:	Arduino_LoRaWAN::cEventLogBase::loop()
+
+Function:
+	Output as many queued entries as fit in the LMIC's idle time.
+
+Definition:
+	void Arduino_LoRaWAN::cEventLogBase::loop(
+		void
+		);
+
+Description:
+	Printing to a UART can take milliseconds per entry, and if the LMIC
+	isn't polled on time it misses receive windows. So, before each
+	entry, we ask the LMIC whether any job is due within the time we
+	expect the entry to take plus a guard time; if so, we stop. While a
+	transmit/receive is in progress we print nothing (a binary sink is
+	quick enough that this doesn't matter).
+
+	The cost of an entry is measured each time, so the drain rate
+	adapts to the output device and to how busy the LMIC is.
+
+Returns:
+	No explicit result.
+
+*/
+
 void
-Arduino_LoRaWAN::cEventLog::loop()
+Arduino_LoRaWAN::cEventLogBase::loop()
     {
-    if ((LMIC.opmode & OP_TXRXPEND) != 0)
+    if (this->m_pSink == nullptr && (LMIC.opmode & OP_TXRXPEND) != 0)
         return;
 
-    if (os_queryTimeCriticalJobs(ms2osticks(1000)))
-        return;
+    if (this->m_costEstimate < 0)
+        this->m_costEstimate = ms2osticks(kInitialCostMs);
+
+    auto const tStart = os_getTime();
+    auto const tLimit = ms2osticks(this->m_drainTimeLimitMs);
+    auto const tGuard = ms2osticks(kGuardMs);
+
+    for (auto tNow = tStart; tNow - tStart < tLimit || tNow == tStart; )
+        {
+        if (os_queryTimeCriticalJobs(this->m_costEstimate + tGuard))
+            break;
+
+        if (! this->processSingleEvent())
+            break;
+
+        auto const tDone = os_getTime();
+
+        this->updateCostEstimate(tDone - tNow);
+        tNow = tDone;
+        }
+    }
+
+void
+Arduino_LoRaWAN::cEventLogBase::updateCostEstimate(
+    std::int32_t cost
+    )
+    {
+    // rise at once, fall slowly: better to wait than to be late.
+    if (cost >= this->m_costEstimate)
+        this->m_costEstimate = cost;
+    else
+        this->m_costEstimate -= (this->m_costEstimate - cost + 7) / 8;
+    }
+
+std::uint32_t
+Arduino_LoRaWAN::cEventLogBase::getEntryCostEstimate() const
+    {
+    auto const cost = this->m_costEstimate < 0 ? ms2osticks(kInitialCostMs) : this->m_costEstimate;
+
+    return std::uint32_t(osticks2us(cost));
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cEventLogBase::claimNode()
+
+Function:
+	Claim the next free node in the event queue, for a producer.
+
+Definition:
+	private: bool Arduino_LoRaWAN::cEventLogBase::claimNode(
+		unsigned &count
+		);
+
+Description:
+	In the single-producer case, only the producer changes m_tail, and
+	only the consumer changes m_head; the acquire load of m_head pairs
+	with the consumer's release store, so the consumer is finished with
+	a node before we reuse it. If the policy is kOverwriteOldest, we
+	don't wait for the consumer at all; it notices, and discards, the
+	nodes we overwrite.
+
+	In the multi-producer case, each node has a sequence number (after
+	D. Vyukov's bounded MPMC queue). A node is free for count n when its
+	sequence is n; producers race to advance m_tail from n to n + 1 with
+	compare-and-swap, and the winner owns the node. The loop only
+	repeats when another producer claimed a node in the meantime, so on
+	a single CPU it runs at most once per nested interrupt level.
+
+Returns:
+	true if a node was claimed (and count is set), false if the queue is
+	full.
+
+*/
 
-    this->processSingleEvent();
+#if ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER && ! defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4)
+# error "ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER needs a CPU with atomic compare-and-swap"
+#endif
+
+bool
+Arduino_LoRaWAN::cEventLogBase::claimNode(
+    unsigned &count
+    )
+    {
+#if ! ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    auto const tail = this->m_tail;
+    auto const head = __atomic_load_n(&this->m_head, __ATOMIC_ACQUIRE);
+    auto const depth = tail - head;
+
+    if (depth > this->m_mask)
+        {
+        if (this->m_policy != OverflowPolicy_t::kOverwriteOldest)
+            {
+            __atomic_store_n(&this->m_nDropped, this->m_nDropped + 1, __ATOMIC_RELAXED);
+            return false;
+            }
+        }
+    else
+        {
+        this->updateHighWater(depth + 1);
+        }
+
+    count = tail;
+    return true;
+#else
+    auto tail = __atomic_load_n(&this->m_tail, __ATOMIC_RELAXED);
+
+    for (;;)
+        {
+        auto const seq = __atomic_load_n(&this->m_pSeq[tail & this->m_mask], __ATOMIC_ACQUIRE);
+        auto const diff = int(seq - tail);
+
+        if (diff == 0)
+            {
+            // on failure, tail is updated to the current value.
+            if (__atomic_compare_exchange_n(
+                    &this->m_tail, &tail, tail + 1,
+                    /* weak */ true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+                    ))
+                {
+                this->updateHighWater(tail + 1 - __atomic_load_n(&this->m_head, __ATOMIC_RELAXED));
+                count = tail;
+                return true;
+                }
+            }
+        else if (diff < 0)
+            {
+            // the consumer hasn't freed this node: queue is full.
+            __atomic_fetch_add(&this->m_nDropped, 1, __ATOMIC_RELAXED);
+            return false;
+            }
+        else
+            {
+            // another producer got here first.
+            tail = __atomic_load_n(&this->m_tail, __ATOMIC_RELAXED);
+            }
+        }
+#endif
+    }
+
+void
+Arduino_LoRaWAN::cEventLogBase::publishNode(
+    unsigned count
+    )
+    {
+#if ! ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    __atomic_store_n(&this->m_tail, count + 1, __ATOMIC_RELEASE);
+#else
+    __atomic_store_n(&this->m_pSeq[count & this->m_mask], count + 1, __ATOMIC_RELEASE);
+#endif
     }
 
-Arduino_LoRaWAN::cEventLog::EventNode_t *
-Arduino_LoRaWAN::cEventLog::logEvent(
+void
+Arduino_LoRaWAN::cEventLogBase::updateHighWater(
+    unsigned depth
+    )
+    {
+    // the consumer may have run since the producer read m_head.
+    if (depth > this->m_mask + 1)
+        depth = this->m_mask + 1;
+
+#if ! ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    if (depth > this->m_highWater)
+        __atomic_store_n(&this->m_highWater, depth, __ATOMIC_RELAXED);
+#else
+    auto highWater = __atomic_load_n(&this->m_highWater, __ATOMIC_RELAXED);
+
+    while (depth > highWater &&
+           ! __atomic_compare_exchange_n(
+                &this->m_highWater, &highWater, depth,
+                /* weak */ true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+                ))
+        /* highWater was reloaded; try again */;
+#endif
+    }
+
+Arduino_LoRaWAN::cEventLogBase::EventNode_t *
+Arduino_LoRaWAN::cEventLogBase::logEvent(
     void *pClientData,
     std::uintptr_t arg1,
     std::uintptr_t arg2,
@@ -55,94 +275,364 @@ Arduino_LoRaWAN::cEventLog::logEvent(
     LogCallback_t *pFn
     )
     {
-    auto i = this->m_tail + 1;
+    unsigned count;
+    auto const tNow = os_getTime();
 
-    if (i == sizeof(this->m_queue) / sizeof(this->m_queue[0]))
-        {
-        i = 0;
-        }
-    if (i == this->m_head)
+    // an immediate sink gets the entry now; the result need only be
+    // non-null.
+    if (this->writeImmediate(EventCode_t::kCustom, tNow, std::uint32_t(arg1), std::uint32_t(arg2), std::uint32_t(arg3)))
+        return this->m_pQueue;
+
+    if (! this->claimNode(count))
         {
         // indicate failure. Callback won't be called!
         return nullptr;
         }
 
-    auto const pEvent = &this->m_queue[this->m_tail];
+    auto const pEvent = &this->m_pQueue[count & this->m_mask];
 
     // save log data
-    pEvent->time = os_getTime();
+    pEvent->time = tNow;
     pEvent->pCallBack = pFn;
     pEvent->pClientData = pClientData;
     pEvent->data[0] = arg1;
     pEvent->data[1] = arg2;
     pEvent->data[2] = arg3;
 
-    // advance pointer
-    this->m_tail = i;
+    // hand the node to the consumer
+    this->publishNode(count);
 
     // indicate success (if anyone cares)
     return pEvent;
     }
 
+Arduino_LoRaWAN::cEventLogBase::EventNode_t *
+Arduino_LoRaWAN::cEventLogBase::logTypedEvent(
+    const Arduino_LoRaWAN_EventSchema &schema,
+    const std::uint32_t data[3]
+    )
+    {
+    unsigned count;
+    auto const tNow = os_getTime();
+
+    if (this->writeImmediate(schema.code, tNow, data[0], data[1], data[2]))
+        return this->m_pQueue;
+
+    if (! this->claimNode(count))
+        return nullptr;
+
+    auto const pEvent = &this->m_pQueue[count & this->m_mask];
+
+    pEvent->time = tNow;
+    pEvent->pCallBack = nullptr;
+    pEvent->pSchema = &schema;
+    pEvent->data[0] = data[0];
+    pEvent->data[1] = data[1];
+    pEvent->data[2] = data[2];
+
+    this->publishNode(count);
+    return pEvent;
+    }
+
+bool
+Arduino_LoRaWAN::cEventLogBase::setOverflowPolicy(
+    OverflowPolicy_t policy
+    )
+    {
+#if ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    if (policy == OverflowPolicy_t::kOverwriteOldest)
+        return false;
+#endif
+
+    this->m_policy = policy;
+    return true;
+    }
+
+std::uint32_t
+Arduino_LoRaWAN::cEventLogBase::getDroppedCount() const
+    {
+    return __atomic_load_n(&this->m_nDropped, __ATOMIC_RELAXED) +
+           __atomic_load_n(&this->m_nOverwritten, __ATOMIC_RELAXED);
+    }
+
+void
+Arduino_LoRaWAN::cEventLogBase::reportDrops()
+    {
+    auto const nLost = this->getDroppedCount();
+
+    if (nLost == this->m_nReported)
+        return;
+
+    if (this->m_pSink != nullptr)
+        {
+        this->writeRecordFromLoop(EventCode_t::kLost, os_getTime(), nLost - this->m_nReported, 0, 0);
+        }
+    else
+        {
+        Serial.print(osticks2ms(os_getTime()));
+        Serial.print(F(" ms: ** "));
+        Serial.print(nLost - this->m_nReported);
+        Serial.println(F(" event(s) lost: log full"));
+        }
+
+    this->m_nReported = nLost;
+    }
+
+void
+Arduino_LoRaWAN::cEventLogBase::writeRecord(
+    EventCode_t code,
+    std::uint32_t time,
+    std::uint32_t data0,
+    std::uint32_t data1,
+    std::uint32_t data2
+    )
+    {
+    Arduino_LoRaWAN_EventRecord record;
+    std::uint8_t buffer[Arduino_LoRaWAN_EventRecord::kMaxSize];
+
+    record.code = code;
+    record.time = time;
+    record.data[0] = data0;
+    record.data[1] = data1;
+    record.data[2] = data2;
+
+    this->m_pSink->write(buffer, record.encode(buffer));
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cEventLogBase::writeImmediate()
+
+Function:
+	Write an entry straight to an immediate sink.
+
+Definition:
+	private: bool Arduino_LoRaWAN::cEventLogBase::writeImmediate(
+		EventCode_t code,
+		std::uint32_t time,
+		std::uint32_t data0,
+		std::uint32_t data1,
+		std::uint32_t data2
+		);
+
+Description:
+	Called by the producers. A retained sink must see each entry when
+	it's logged: an entry still in the queue when the watchdog fires is
+	otherwise lost, and those are the ones that matter. loop() keeps
+	interrupts off while it writes, so in a single-producer build the
+	sink is ours. With several producers, the sink is guarded by a
+	try-lock; a producer that doesn't get it queues the entry instead,
+	so logEvent() still never blocks.
+
+Returns:
+	true if the entry was written, false if it should be queued.
+
+*/
+
+bool
+Arduino_LoRaWAN::cEventLogBase::writeImmediate(
+    EventCode_t code,
+    std::uint32_t time,
+    std::uint32_t data0,
+    std::uint32_t data1,
+    std::uint32_t data2
+    )
+    {
+    auto const pSink = this->m_pSink;
+
+    if (pSink == nullptr || ! pSink->isImmediate())
+        return false;
+
+#if ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    if (__atomic_exchange_n(&this->m_fSinkBusy, true, __ATOMIC_ACQUIRE))
+        return false;
+#endif
+
+    this->writeRecord(code, time, data0, data1, data2);
+
+#if ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    __atomic_store_n(&this->m_fSinkBusy, false, __ATOMIC_RELEASE);
+#endif
+    return true;
+    }
+
+void
+Arduino_LoRaWAN::cEventLogBase::writeRecordFromLoop(
+    EventCode_t code,
+    std::uint32_t time,
+    std::uint32_t data0,
+    std::uint32_t data1,
+    std::uint32_t data2
+    )
+    {
+    if (! this->m_pSink->isImmediate())
+        {
+        this->writeRecord(code, time, data0, data1, data2);
+        return;
+        }
+
+#if ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    // producers never wait for the lock, so this is short.
+    while (__atomic_exchange_n(&this->m_fSinkBusy, true, __ATOMIC_ACQUIRE))
+        /* spin */;
+
+    this->writeRecord(code, time, data0, data1, data2);
+    __atomic_store_n(&this->m_fSinkBusy, false, __ATOMIC_RELEASE);
+#else
+    noInterrupts();
+    this->writeRecord(code, time, data0, data1, data2);
+    interrupts();
+#endif
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cEventLogBase::processSingleEvent()
+
+Function:
+	Remove the oldest event from the queue and print it.
+
+Definition:
+	private: bool Arduino_LoRaWAN::cEventLogBase::processSingleEvent(
+		void
+		);
+
+Description:
+	The node is copied before it's given back to the producers, so the
+	callback always sees a stable entry.
+
+	With kOverwriteOldest, the producer may have lapped us: nodes that
+	were overwritten are counted as lost and skipped. The producer may
+	also be rewriting the node while we copy it; that's possible
+	whenever the queue is full, so in that case the copy is discarded
+	(and counted as lost) rather than printed.
+
+Returns:
+	true if an event was removed from the queue, false if the queue
+	was empty.
+
+*/
+
 bool
-Arduino_LoRaWAN::cEventLog::processSingleEvent()
+Arduino_LoRaWAN::cEventLogBase::processSingleEvent()
     {
-    if (this->m_head == this->m_tail)
+    auto head = this->m_head;
+    auto const capacity = this->m_mask + 1;
+    EventNode_t event;
+
+    this->reportDrops();
+
+#if ! ARDUINO_LORAWAN_CFG_EVENTLOG_MULTI_PRODUCER
+    auto const tail = __atomic_load_n(&this->m_tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+        {
+        return false;
+        }
+
+    if (tail - head > capacity)
+        {
+        __atomic_store_n(&this->m_nOverwritten, this->m_nOverwritten + (tail - head - capacity), __ATOMIC_RELAXED);
+        head = tail - capacity;
+        }
+
+    event = this->m_pQueue[head & this->m_mask];
+
+    if (this->m_policy == OverflowPolicy_t::kOverwriteOldest)
+        {
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&this->m_tail, __ATOMIC_RELAXED) - head >= capacity)
+            {
+            __atomic_store_n(&this->m_nOverwritten, this->m_nOverwritten + 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&this->m_head, head + 1, __ATOMIC_RELEASE);
+            return true;
+            }
+        }
+
+    // give the node back to the producer.
+    __atomic_store_n(&this->m_head, head + 1, __ATOMIC_RELEASE);
+#else
+    // a claimed node that isn't published yet also stops us here.
+    if (__atomic_load_n(&this->m_pSeq[head & this->m_mask], __ATOMIC_ACQUIRE) != head + 1)
         {
         return false;
         }
 
-    auto const pEvent = &this->m_queue[this->m_head];
+    event = this->m_pQueue[head & this->m_mask];
 
-    Serial.print(osticks2ms(pEvent->time));
-    Serial.print(" ms:");
-    pEvent->pCallBack(pEvent);
-    Serial.println();
+    // give the node back to the producers.
+    __atomic_store_n(&this->m_pSeq[head & this->m_mask], head + capacity, __ATOMIC_RELEASE);
+    __atomic_store_n(&this->m_head, head + 1, __ATOMIC_RELAXED);
+#endif
 
-    if (++m_head == sizeof(m_queue) / sizeof(m_queue[0]))
+    if (this->m_pSink != nullptr)
+        {
+        this->writeRecordFromLoop(
+            event.getCode(), event.time,
+            std::uint32_t(event.data[0]), std::uint32_t(event.data[1]), std::uint32_t(event.data[2])
+            );
+        }
+    else
         {
-        m_head = 0;
+        Serial.print(osticks2ms(event.time));
+        Serial.print(" ms:");
+        if (event.pCallBack != nullptr)
+            {
+            event.pCallBack(&event);
+            }
+        else
+            {
+            char buffer[96];
+            std::uint32_t const data[3] =
+                {
+                std::uint32_t(event.data[0]), std::uint32_t(event.data[1]), std::uint32_t(event.data[2])
+                };
+
+            event.pSchema->format(data, buffer, sizeof(buffer));
+            Serial.print(buffer);
+            }
+        Serial.println();
         }
 
     return true;
     }
 
 void
-Arduino_LoRaWAN::cEventLog::printCh(std::uint8_t channel) const
+Arduino_LoRaWAN::cEventLogBase::printCh(std::uint8_t channel) const
     {
     Serial.print(F(" ch="));
     Serial.print(std::uint32_t(channel));
     }
 
 const char *
-Arduino_LoRaWAN::cEventLog::getSfName(std::uint8_t rps) const
+Arduino_LoRaWAN::cEventLogBase::getSfName(std::uint8_t rps) const
     {
     const char * const t[] = { "FSK", "SF7", "SF8", "SF9", "SF10", "SF11", "SF12", "SFrfu" };
     return t[getSf(rps)];
     }
 
 const char *
-Arduino_LoRaWAN::cEventLog::getBwName(std::uint8_t rps) const
+Arduino_LoRaWAN::cEventLogBase::getBwName(std::uint8_t rps) const
     {
     const char * const t[] = { "BW125", "BW250", "BW500", "BWrfu" };
     return t[getBw(rps)];
     }
 
 const char *
-Arduino_LoRaWAN::cEventLog::getCrName(std::uint8_t rps) const
+Arduino_LoRaWAN::cEventLogBase::getCrName(std::uint8_t rps) const
     {
     const char * const t[] = { "CR 4/5", "CR 4/6", "CR 4/7", "CR 4/8" };
     return t[getCr(rps)];
     }
 
 const char *
-Arduino_LoRaWAN::cEventLog::getCrcName(std::uint8_t rps) const
+Arduino_LoRaWAN::cEventLogBase::getCrcName(std::uint8_t rps) const
     {
     return getNocrc(rps) ? "NoCrc" : "Crc";
     }
 
 void
-Arduino_LoRaWAN::cEventLog::printHex2(unsigned v) const
+Arduino_LoRaWAN::cEventLogBase::printHex2(unsigned v) const
     {
     v &= 0xff;
     if (v < 16)
@@ -151,20 +641,20 @@ Arduino_LoRaWAN::cEventLog::printHex2(unsigned v) const
     }
 
 void
-Arduino_LoRaWAN::cEventLog::printHex4(unsigned v) const
+Arduino_LoRaWAN::cEventLogBase::printHex4(unsigned v) const
     {
     printHex2(v >> 8u);
     printHex2(v);
     }
 
 void
-Arduino_LoRaWAN::cEventLog::printSpace(void) const
+Arduino_LoRaWAN::cEventLogBase::printSpace(void) const
     {
     Serial.print(' ');
     }
 
 void
-Arduino_LoRaWAN::cEventLog::printFreq(u4_t freq) const
+Arduino_LoRaWAN::cEventLogBase::printFreq(u4_t freq) const
     {
     Serial.print(F(": freq="));
     Serial.print(freq / 1000000);
@@ -172,7 +662,7 @@ Arduino_LoRaWAN::cEventLog::printFreq(u4_t freq) const
     Serial.print((freq % 1000000) / 100000);
     }
 
-void Arduino_LoRaWAN::cEventLog::printRps(std::uint8_t rps) const
+void Arduino_LoRaWAN::cEventLogBase::printRps(std::uint8_t rps) const
     {
     Serial.print(F(" rps=0x")); printHex2(rps);
     Serial.print(F(" (")); Serial.print(getSfName(rps));
@@ -0,0 +1,245 @@
+/*
+
+Module:	arduino_lorawan_cEventLogRetainedSink.cpp
+
+Function:
+	Arduino_LoRaWAN::cEventLogRetainedSink methods.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN_EventLog.h>
+
+/****************************************************************************\
+|
+|	Methods
+|
+\****************************************************************************/
+
+Arduino_LoRaWAN::cEventLogRetainedSink::Header_t
+Arduino_LoRaWAN::cEventLogRetainedSink::getHeader() const
+    {
+    Header_t header;
+
+    std::memcpy(&header, this->m_pBuffer, sizeof(header));
+    return header;
+    }
+
+void
+Arduino_LoRaWAN::cEventLogRetainedSink::putHeader(
+    const Header_t &header
+    )
+    {
+    std::memcpy(this->m_pBuffer, &header, sizeof(header));
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cEventLogRetainedSink::begin()
+
+Function:
+	Recover the retained log after a reset, or start a new one.
+
+Definition:
+	bool Arduino_LoRaWAN::cEventLogRetainedSink::begin(
+		void
+		);
+
+Description:
+	After power-up the buffer holds garbage, so the header is checked
+	carefully: the magic number, the ring size, and the ring offsets
+	must all be right. A reset in the middle of write() can leave a
+	partial record in the ring; readers skip it, just as they skip
+	noise on a UART.
+
+	Either way, a Code_t::kBoot record is written, giving the
+	generation and whether the old records were kept.
+
+Returns:
+	true if records from before the reset were recovered.
+
+*/
+
+bool
+Arduino_LoRaWAN::cEventLogRetainedSink::begin()
+    {
+    if (this->m_pBuffer == nullptr ||
+        this->m_nBuffer < sizeof(Header_t) + Arduino_LoRaWAN_EventRecord::kMaxSize)
+        return false;
+
+    auto const ringSize = std::uint32_t(this->m_nBuffer - sizeof(Header_t));
+    auto header = this->getHeader();
+    bool const fRecovered = header.magic == kMagic &&
+                            header.size == ringSize &&
+                            header.first < ringSize &&
+                            header.used <= ringSize;
+
+    if (fRecovered)
+        {
+        ++header.generation;
+        }
+    else
+        {
+        header.magic = kMagic;
+        header.size = ringSize;
+        header.generation = 0;
+        header.first = 0;
+        header.used = 0;
+        }
+
+    this->putHeader(header);
+
+    Arduino_LoRaWAN_EventRecord record;
+    std::uint8_t buffer[Arduino_LoRaWAN_EventRecord::kMaxSize];
+
+    record.code = Arduino_LoRaWAN_EventRecord::Code_t::kBoot;
+    record.time = 0;
+    record.data[0] = header.generation;
+    record.data[1] = fRecovered;
+    record.data[2] = 0;
+    this->write(buffer, record.encode(buffer));
+
+    return fRecovered;
+    }
+
+void
+Arduino_LoRaWAN::cEventLogRetainedSink::clear()
+    {
+    auto header = this->getHeader();
+
+    if (header.magic != kMagic)
+        return;
+
+    header.first = 0;
+    header.used = 0;
+    this->putHeader(header);
+    }
+
+void
+Arduino_LoRaWAN::cEventLogRetainedSink::dropOldest(
+    Header_t &header
+    )
+    {
+    std::uint8_t buffer[Arduino_LoRaWAN_EventRecord::kMaxSize];
+    Arduino_LoRaWAN_EventRecord record;
+    std::size_t nBuffer = sizeof(buffer);
+
+    if (nBuffer > header.used)
+        nBuffer = header.used;
+
+    for (std::size_t i = 0; i < nBuffer; ++i)
+        buffer[i] = this->getRing()[(header.first + i) % header.size];
+
+    // anything that isn't a whole record is dropped a byte at a time.
+    auto n = record.decode(buffer, nBuffer);
+    if (n <= 0)
+        n = 1;
+
+    header.first = (header.first + n) % header.size;
+    header.used -= n;
+    }
+
+bool
+Arduino_LoRaWAN::cEventLogRetainedSink::write(
+    const std::uint8_t *pRecord,
+    std::size_t nRecord
+    )
+    {
+    auto header = this->getHeader();
+
+    if (header.magic != kMagic || nRecord > header.size)
+        return false;
+
+    if (header.size - header.used < nRecord)
+        {
+        while (header.size - header.used < nRecord)
+            this->dropOldest(header);
+
+        this->putHeader(header);
+        }
+
+    auto iNext = (header.first + header.used) % header.size;
+    auto const pRing = this->getRing();
+
+    for (std::size_t i = 0; i < nRecord; ++i)
+        {
+        pRing[iNext] = pRecord[i];
+        if (++iNext == header.size)
+            iNext = 0;
+        }
+
+    header.used += nRecord;
+    this->putHeader(header);
+    return true;
+    }
+
+std::uint32_t
+Arduino_LoRaWAN::cEventLogRetainedSink::getGeneration() const
+    {
+    auto const header = this->getHeader();
+
+    return header.magic == kMagic ? header.generation : 0;
+    }
+
+std::size_t
+Arduino_LoRaWAN::cEventLogRetainedSink::getSize() const
+    {
+    auto const header = this->getHeader();
+
+    return header.magic == kMagic ? header.used : 0;
+    }
+
+std::size_t
+Arduino_LoRaWAN::cEventLogRetainedSink::read(
+    std::size_t offset,
+    std::uint8_t *pData,
+    std::size_t nData
+    ) const
+    {
+    auto const header = this->getHeader();
+
+    if (header.magic != kMagic || offset >= header.used)
+        return 0;
+
+    if (nData > header.used - offset)
+        nData = header.used - offset;
+
+    auto const pRing = this->getRing();
+    auto i = (header.first + offset) % header.size;
+
+    for (std::size_t n = 0; n < nData; ++n)
+        {
+        pData[n] = pRing[i];
+        if (++i == header.size)
+            i = 0;
+        }
+
+    return nData;
+    }
+
+void
+Arduino_LoRaWAN::cEventLogRetainedSink::dump(
+    Print &print
+    ) const
+    {
+    std::uint8_t buffer[32];
+    std::size_t offset = 0;
+    std::size_t n;
+
+    while ((n = this->read(offset, buffer, sizeof(buffer))) != 0)
+        {
+        print.write(buffer, n);
+        offset += n;
+        }
+    }
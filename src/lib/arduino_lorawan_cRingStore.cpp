@@ -0,0 +1,574 @@
+/*
+
+Module:	arduino_lorawan_cRingStore.cpp
+
+Function:
+	Arduino_LoRaWAN::cRingStore methods.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN_RingStore.h>
+
+/****************************************************************************\
+|
+|	Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+// size of the stack buffer used when checking and copying records.
+static constexpr size_t kChunk = 32;
+
+/****************************************************************************\
+|
+|	Local functions
+|
+\****************************************************************************/
+
+// return true if every byte in the buffer is erased.
+static bool
+isErased(const void *pBuffer, size_t nBuffer)
+    {
+    auto p = static_cast<const uint8_t *>(pBuffer);
+
+    for (; nBuffer != 0; --nBuffer)
+        {
+        if (*p++ != 0xFF)
+            return false;
+        }
+
+    return true;
+    }
+
+/****************************************************************************\
+|
+|	Methods
+|
+\****************************************************************************/
+
+/*
+
+Name:	Arduino_LoRaWAN::cRingStore::begin()
+
+Function:
+	Attach the ring store to a device and recover its state.
+
+Definition:
+	public bool Arduino_LoRaWAN::cRingStore::begin(
+		cPageDevice *pDevice
+		);
+
+Description:
+	The header of every page is read, and the valid page with the
+	highest sequence number (compared modulo 2^32) becomes the current
+	page. Only the records of that page are then scanned; the scan stops
+	at the first erased record header. A record that is damaged (for
+	example, by a power failure during a write) ends the scan and marks
+	the page as full, so the next append() starts a new page.
+
+	If no page has a valid header, the device is formatted.
+
+Returns:
+	true if the store is ready for use; false if the device geometry
+	is not usable or the device reports an error.
+
+*/
+
+bool
+Arduino_LoRaWAN::cRingStore::begin(
+    cPageDevice *pDevice
+    )
+    {
+    this->m_pDevice = pDevice;
+    if (pDevice == nullptr)
+        return false;
+
+    this->m_pageSize = pDevice->getPageSize();
+    this->m_nPages = pDevice->getPageCount();
+
+    // we need two pages to rotate, and offsets must fit in 16 bits.
+    if (this->m_nPages < 2 ||
+        this->m_pageSize < sizeof(PageHeader_t) + kNumKinds * sizeof(RecordHeader_t) ||
+        this->m_pageSize > 0xFFFFu ||
+        (this->m_pageSize & 3) != 0)
+        {
+        this->m_pDevice = nullptr;
+        return false;
+        }
+
+    bool fFound = false;
+
+    for (unsigned iPage = 0; iPage < this->m_nPages; ++iPage)
+        {
+        uint32_t seq;
+
+        if (! this->readPageHeader(iPage, seq))
+            continue;
+
+        if (! fFound || int32_t(seq - this->m_pageSeq) > 0)
+            {
+            this->m_iPage = iPage;
+            this->m_pageSeq = seq;
+            fFound = true;
+            }
+        }
+
+    if (! fFound)
+        return this->format();
+
+    this->scanPage();
+    return true;
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cRingStore::format()
+
+Function:
+	Erase the device and start an empty store.
+
+Definition:
+	public bool Arduino_LoRaWAN::cRingStore::format();
+
+Description:
+	Every page is erased (so that no stale page header can win at the
+	next begin()), and page 0 is given a fresh header.
+
+Returns:
+	true if successful.
+
+*/
+
+bool
+Arduino_LoRaWAN::cRingStore::format()
+    {
+    if (this->m_pDevice == nullptr)
+        return false;
+
+    for (unsigned iPage = 0; iPage < this->m_nPages; ++iPage)
+        {
+        if (! this->m_pDevice->erase(iPage))
+            return false;
+        }
+
+    PageHeader_t header;
+
+    header.magic = kPageMagic;
+    header.seq = this->m_pageSeq + 1;
+    header.rsv = 0xFFFFFFFFu;
+    header.crc = Arduino_LoRaWAN::Crc32(&header, offsetof(PageHeader_t, crc));
+
+    if (! this->m_pDevice->write(0, 0, &header, sizeof(header)))
+        return false;
+
+    this->m_iPage = 0;
+    this->m_pageSeq = header.seq;
+    this->m_offset = sizeof(PageHeader_t);
+    this->m_fPageFull = false;
+    for (auto &latest : this->m_latest)
+        latest.fValid = false;
+
+    return true;
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cRingStore::append()
+
+Function:
+	Append a record to the store.
+
+Definition:
+	public bool Arduino_LoRaWAN::cRingStore::append(
+		RecordKind kind,
+		const void *pData,
+		size_t nData
+		);
+
+Description:
+	If the record fits in the current page, it is written there.
+	Otherwise a new page is started; the record is written to the new
+	page along with the latest record of each other kind, and only then
+	is the new page's header written. A power failure at any point
+	leaves either the old page or the new page current, each with a
+	complete set of records.
+
+Returns:
+	true if the record was written.
+
+*/
+
+bool
+Arduino_LoRaWAN::cRingStore::append(
+    RecordKind kind,
+    const void *pData,
+    size_t nData
+    )
+    {
+    auto const iKind = unsigned(kind);
+
+    if (this->m_pDevice == nullptr || iKind >= kNumKinds || nData > 0xFFFFu)
+        return false;
+
+    auto const nNeeded = sizeof(RecordHeader_t) + roundUp(nData);
+
+    if (! this->m_fPageFull && this->m_offset + nNeeded <= this->m_pageSize)
+        {
+        if (this->writeRecord(this->m_iPage, kind, pData, nData))
+            return true;
+
+        // a failed write leaves the rest of the page in doubt.
+        this->m_fPageFull = true;
+        }
+
+    return this->startNewPage(kind, pData, nData);
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cRingStore::read()
+
+Function:
+	Read the latest record of a given kind.
+
+Definition:
+	public bool Arduino_LoRaWAN::cRingStore::read(
+		RecordKind kind,
+		void *pData,
+		size_t nData,
+		size_t *pnActual = nullptr
+		);
+
+Description:
+	The record is read from the current page and its CRC is checked.
+	If the record is longer than nData, only the first nData bytes are
+	copied, but the CRC is still checked over the whole record.
+
+Returns:
+	true if a record was found and is intact.
+
+*/
+
+bool
+Arduino_LoRaWAN::cRingStore::read(
+    RecordKind kind,
+    void *pData,
+    size_t nData,
+    size_t *pnActual
+    )
+    {
+    auto const iKind = unsigned(kind);
+
+    if (pnActual != nullptr)
+        *pnActual = 0;
+
+    if (this->m_pDevice == nullptr || iKind >= kNumKinds || ! this->m_latest[iKind].fValid)
+        return false;
+
+    auto const &latest = this->m_latest[iKind];
+    RecordHeader_t header;
+
+    if (! this->m_pDevice->read(this->m_iPage, latest.offset, &header, sizeof(header)))
+        return false;
+
+    auto crc = Arduino_LoRaWAN::Crc32(&header, offsetof(RecordHeader_t, crc));
+    auto const pBuffer = static_cast<uint8_t *>(pData);
+    size_t const offsetData = latest.offset + sizeof(header);
+    uint8_t chunk[kChunk];
+
+    for (size_t i = 0; i < header.size; )
+        {
+        // read straight into the caller's buffer while there's room.
+        uint8_t *pChunk;
+        size_t nChunk;
+
+        if (i < nData)
+            {
+            pChunk = pBuffer + i;
+            nChunk = nData - i;
+            }
+        else
+            {
+            pChunk = chunk;
+            nChunk = sizeof(chunk);
+            }
+
+        if (nChunk > header.size - i)
+            nChunk = header.size - i;
+
+        if (! this->m_pDevice->read(this->m_iPage, offsetData + i, pChunk, nChunk))
+            return false;
+
+        crc = Arduino_LoRaWAN::Crc32(pChunk, nChunk, crc);
+        i += nChunk;
+        }
+
+    if (crc != header.crc)
+        return false;
+
+    if (pnActual != nullptr)
+        *pnActual = header.size;
+
+    return true;
+    }
+
+/****************************************************************************\
+|
+|	Internal methods
+|
+\****************************************************************************/
+
+bool
+Arduino_LoRaWAN::cRingStore::readPageHeader(
+    unsigned iPage,
+    uint32_t &seq
+    )
+    {
+    PageHeader_t header;
+
+    if (! this->m_pDevice->read(iPage, 0, &header, sizeof(header)))
+        return false;
+
+    if (header.magic != kPageMagic ||
+        header.crc != Arduino_LoRaWAN::Crc32(&header, offsetof(PageHeader_t, crc)))
+        return false;
+
+    seq = header.seq;
+    return true;
+    }
+
+void
+Arduino_LoRaWAN::cRingStore::scanPage()
+    {
+    size_t offset = sizeof(PageHeader_t);
+
+    this->m_fPageFull = false;
+    for (auto &latest : this->m_latest)
+        latest.fValid = false;
+
+    while (offset + sizeof(RecordHeader_t) <= this->m_pageSize)
+        {
+        RecordHeader_t header;
+
+        if (! this->m_pDevice->read(this->m_iPage, offset, &header, sizeof(header)))
+            {
+            this->m_fPageFull = true;
+            break;
+            }
+
+        // an erased header is the end of the log.
+        if (isErased(&header, sizeof(header)))
+            break;
+
+        auto const iKind = unsigned(header.kind);
+        auto const nRecord = sizeof(header) + roundUp(header.size);
+
+        if (header.magic != kRecordMagic ||
+            iKind >= kNumKinds ||
+            offset + nRecord > this->m_pageSize)
+            {
+            this->m_fPageFull = true;
+            break;
+            }
+
+        // check the CRC.
+        auto crc = Arduino_LoRaWAN::Crc32(&header, offsetof(RecordHeader_t, crc));
+        uint8_t chunk[kChunk];
+        bool fOk = true;
+
+        for (size_t i = 0; i < header.size; )
+            {
+            auto nChunk = header.size - i;
+
+            if (nChunk > sizeof(chunk))
+                nChunk = sizeof(chunk);
+
+            if (! this->m_pDevice->read(this->m_iPage, offset + sizeof(header) + i, chunk, nChunk))
+                {
+                fOk = false;
+                break;
+                }
+
+            crc = Arduino_LoRaWAN::Crc32(chunk, nChunk, crc);
+            i += nChunk;
+            }
+
+        if (! fOk || crc != header.crc)
+            {
+            this->m_fPageFull = true;
+            break;
+            }
+
+        auto &latest = this->m_latest[iKind];
+
+        latest.seq = header.seq;
+        latest.offset = uint16_t(offset);
+        latest.size = header.size;
+        latest.fValid = true;
+
+        if (int32_t(header.seq - this->m_recordSeq) >= 0)
+            this->m_recordSeq = header.seq + 1;
+
+        offset += nRecord;
+        }
+
+    this->m_offset = offset;
+    }
+
+bool
+Arduino_LoRaWAN::cRingStore::writeRecord(
+    unsigned iPage,
+    RecordKind kind,
+    const void *pData,
+    size_t nData
+    )
+    {
+    RecordHeader_t header;
+
+    header.magic = kRecordMagic;
+    header.kind = uint8_t(kind);
+    header.rsv = 0xFF;
+    header.size = uint16_t(nData);
+    header.rsv2 = 0xFFFF;
+    header.seq = this->m_recordSeq;
+    header.crc = Arduino_LoRaWAN::Crc32(&header, offsetof(RecordHeader_t, crc));
+    header.crc = Arduino_LoRaWAN::Crc32(pData, nData, header.crc);
+
+    auto const offset = this->m_offset;
+    auto const nBody = nData & ~size_t(3);
+    auto const pBody = static_cast<const uint8_t *>(pData);
+
+    // header first: if the data is torn, the CRC will show it.
+    if (! this->m_pDevice->write(iPage, offset, &header, sizeof(header)))
+        return false;
+
+    if (nBody != 0 &&
+        ! this->m_pDevice->write(iPage, offset + sizeof(header), pBody, nBody))
+        return false;
+
+    if (nBody != nData)
+        {
+        uint8_t tail[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+
+        std::memcpy(tail, pBody + nBody, nData - nBody);
+        if (! this->m_pDevice->write(iPage, offset + sizeof(header) + nBody, tail, sizeof(tail)))
+            return false;
+        }
+
+    auto &latest = this->m_latest[unsigned(kind)];
+
+    latest.seq = header.seq;
+    latest.offset = uint16_t(offset);
+    latest.size = header.size;
+    latest.fValid = true;
+
+    this->m_offset = offset + sizeof(header) + roundUp(nData);
+    ++this->m_recordSeq;
+    return true;
+    }
+
+bool
+Arduino_LoRaWAN::cRingStore::copyRecord(
+    unsigned iPageFrom,
+    unsigned iPageTo,
+    Latest_t &latest
+    )
+    {
+    auto const nRecord = sizeof(RecordHeader_t) + roundUp(latest.size);
+    uint8_t chunk[kChunk];
+
+    for (size_t i = 0; i < nRecord; )
+        {
+        auto nChunk = nRecord - i;
+
+        if (nChunk > sizeof(chunk))
+            nChunk = sizeof(chunk);
+
+        if (! this->m_pDevice->read(iPageFrom, latest.offset + i, chunk, nChunk) ||
+            ! this->m_pDevice->write(iPageTo, this->m_offset + i, chunk, nChunk))
+            return false;
+
+        i += nChunk;
+        }
+
+    latest.offset = uint16_t(this->m_offset);
+    this->m_offset += nRecord;
+    return true;
+    }
+
+bool
+Arduino_LoRaWAN::cRingStore::startNewPage(
+    RecordKind kind,
+    const void *pData,
+    size_t nData
+    )
+    {
+    auto const iOldPage = this->m_iPage;
+    auto const iNewPage = (iOldPage + 1) % this->m_nPages;
+    Latest_t latest[kNumKinds];
+
+    // work on a copy, so a failure leaves the old page in use.
+    std::memcpy(latest, this->m_latest, sizeof(latest));
+
+    if (! this->m_pDevice->erase(iNewPage))
+        return false;
+
+    this->m_offset = sizeof(PageHeader_t);
+    this->m_fPageFull = true;
+
+    // carry forward the latest record of every other kind.
+    for (unsigned iKind = 0; iKind < kNumKinds; ++iKind)
+        {
+        if (iKind == unsigned(kind) || ! latest[iKind].fValid)
+            continue;
+
+        if (this->m_offset + sizeof(RecordHeader_t) + roundUp(latest[iKind].size) > this->m_pageSize ||
+            ! this->copyRecord(iOldPage, iNewPage, latest[iKind]))
+            return false;
+        }
+
+    if (this->m_offset + sizeof(RecordHeader_t) + roundUp(nData) > this->m_pageSize)
+        return false;
+
+    // write the new record; this updates m_latest[kind].
+    auto const latestOld = this->m_latest[unsigned(kind)];
+
+    if (! this->writeRecord(iNewPage, kind, pData, nData))
+        {
+        this->m_latest[unsigned(kind)] = latestOld;
+        return false;
+        }
+
+    latest[unsigned(kind)] = this->m_latest[unsigned(kind)];
+
+    // the page header goes last: until it's written, the old page is current.
+    PageHeader_t header;
+
+    header.magic = kPageMagic;
+    header.seq = this->m_pageSeq + 1;
+    header.rsv = 0xFFFFFFFFu;
+    header.crc = Arduino_LoRaWAN::Crc32(&header, offsetof(PageHeader_t, crc));
+
+    if (! this->m_pDevice->write(iNewPage, 0, &header, sizeof(header)))
+        {
+        this->m_latest[unsigned(kind)] = latestOld;
+        return false;
+        }
+
+    this->m_iPage = iNewPage;
+    this->m_pageSeq = header.seq;
+    this->m_fPageFull = false;
+    std::memcpy(this->m_latest, latest, sizeof(latest));
+    return true;
+    }
@@ -0,0 +1,173 @@
+/*
+
+Module:	arduino_lorawan_cUplinkAggregator.cpp
+
+Function:
+	Arduino_LoRaWAN::cUplinkAggregator methods.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN_UplinkAggregator.h>
+
+/****************************************************************************\
+|
+|	Aggregator methods
+|
+\****************************************************************************/
+
+void
+Arduino_LoRaWAN::cUplinkAggregator::setup(
+    Arduino_LoRaWAN *pLoRaWAN,
+    std::uint8_t port,
+    std::uint32_t maxAgeMs,
+    bool fLengthPrefix
+    )
+    {
+    this->m_pLoRaWAN = pLoRaWAN;
+    this->m_port = port;
+    this->m_maxAgeMs = maxAgeMs;
+    this->m_fLengthPrefix = fLengthPrefix;
+
+    for (auto &frame : this->m_frame)
+        {
+        frame.pOwner = this;
+        frame.nData = 0;
+        frame.fBusy = false;
+        }
+    }
+
+void
+Arduino_LoRaWAN::cUplinkAggregator::loop()
+    {
+    auto const pFrame = &this->m_frame[this->m_iFill];
+
+    if (pFrame->nData == 0)
+        return;
+
+    if (this->m_fFlushPending ||
+        (this->m_maxAgeMs != 0 && millis() - pFrame->tFirst >= this->m_maxAgeMs))
+        {
+        this->flush();
+        }
+    }
+
+std::size_t
+Arduino_LoRaWAN::cUplinkAggregator::getFrameLimit() const
+    {
+    auto limit = this->m_pLoRaWAN->GetMaxPayloadSize();
+
+    // if the data rate isn't known, assume the smallest common limit.
+    if (limit == 0)
+        limit = 51;
+    if (limit > kMaxFrame)
+        limit = kMaxFrame;
+
+    return limit;
+    }
+
+bool
+Arduino_LoRaWAN::cUplinkAggregator::append(
+    const std::uint8_t *pRecord,
+    std::size_t nRecord
+    )
+    {
+    auto const nNeeded = nRecord + (this->m_fLengthPrefix ? 1 : 0);
+    auto const limit = this->getFrameLimit();
+
+    if (nNeeded > limit || nRecord > 255)
+        return false;
+
+    auto pFrame = &this->m_frame[this->m_iFill];
+
+    // flush on size: if it won't fit, send what we have first.
+    if (pFrame->nData + nNeeded > limit)
+        {
+        if (! this->flush())
+            return false;
+
+        pFrame = &this->m_frame[this->m_iFill];
+        }
+
+    if (pFrame->nData == 0)
+        pFrame->tFirst = millis();
+
+    if (this->m_fLengthPrefix)
+        pFrame->data[pFrame->nData++] = std::uint8_t(nRecord);
+
+    std::memcpy(pFrame->data + pFrame->nData, pRecord, nRecord);
+    pFrame->nData += std::uint8_t(nRecord);
+
+    // if the frame is full, send it now.
+    if (pFrame->nData >= limit)
+        this->flush();
+
+    return true;
+    }
+
+bool
+Arduino_LoRaWAN::cUplinkAggregator::flush()
+    {
+    auto const pFrame = &this->m_frame[this->m_iFill];
+
+    this->m_fFlushPending = false;
+    if (pFrame->nData == 0)
+        return true;
+
+    auto const iNext = this->m_iFill ^ 1;
+
+    // the other buffer is still on its way; try again later.
+    if (this->m_frame[iNext].fBusy)
+        {
+        this->m_fFlushPending = true;
+        return false;
+        }
+
+    this->m_iFill = iNext;
+    pFrame->fBusy = true;
+
+    // the completion might be called before this returns.
+    this->m_pLoRaWAN->SendBufferNoCopy(
+        pFrame->data,
+        pFrame->nData,
+        sendDone,
+        (void *)pFrame,
+        /* confirmed */ false,
+        this->m_port
+        );
+
+    return true;
+    }
+
+void
+Arduino_LoRaWAN::cUplinkAggregator::sendDone(
+    void *pCtx,
+    bool fSuccess
+    )
+    {
+    auto const pFrame = (Frame_t *)pCtx;
+    auto const pThis = pFrame->pOwner;
+
+    if (fSuccess)
+        ++pThis->m_nFramesSent;
+    else
+        ++pThis->m_nFramesFailed;
+
+    pFrame->nData = 0;
+    pFrame->fBusy = false;
+
+    // a flush was waiting for this buffer; do it now.
+    if (pThis->m_fFlushPending)
+        pThis->flush();
+    }
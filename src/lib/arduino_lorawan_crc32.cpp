@@ -0,0 +1,83 @@
+/*
+
+Module:	arduino_lorawan_crc32.cpp
+
+Function:
+	Arduino_LoRaWAN::Crc32()
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN.h>
+
+/****************************************************************************\
+|
+|	Read-only data.
+|
+\****************************************************************************/
+
+// CRC-32 (polynomial 0xEDB88320, reflected), four bits at a time. This
+// keeps the table to 64 bytes, which matters more to us than speed.
+static const uint32_t s_crc32Nibble[16] =
+    {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+
+/*
+
+Name:	Arduino_LoRaWAN::Crc32()
+
+Function:
+	Compute an IEEE 802.3 CRC-32.
+
+Definition:
+	public static uint32_t Arduino_LoRaWAN::Crc32(
+		const void *pData,
+		size_t nData,
+		uint32_t crc = 0
+		);
+
+Description:
+	The standard CRC-32 (as used by Ethernet and zlib) is computed
+	over the buffer. The pre- and post-inversion are done here, so
+	the result of one call can be passed as crc to the next to
+	compute the CRC of a concatenation of buffers.
+
+Returns:
+	The CRC.
+
+*/
+
+uint32_t
+Arduino_LoRaWAN::Crc32(
+    const void *pData,
+    size_t nData,
+    uint32_t crc
+    )
+    {
+    auto p = static_cast<const uint8_t *>(pData);
+
+    crc = ~crc;
+    for (; nData != 0; --nData)
+        {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ s_crc32Nibble[crc & 0xF];
+        crc = (crc >> 4) ^ s_crc32Nibble[crc & 0xF];
+        }
+
+    return ~crc;
+    }
@@ -0,0 +1,289 @@
+/*
+
+Module:	arduino_lorawan_datarate.cpp
+
+Function:
+	Arduino_LoRaWAN::cLMIC data-rate tables and time-on-air calculation.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN_lmic.h>
+
+/****************************************************************************\
+|
+|	Read-only data.
+|
+\****************************************************************************/
+
+// the uplink data rates for each region, from the LoRaWAN Regional
+// Parameters. maxPayload is "N", the largest FRMPayload with no FOpts.
+// Entries with maxPayload == 0 are not valid for uplinks.
+namespace {
+
+using DataRateInfo_t = Arduino_LoRaWAN::cLMIC::DataRateInfo_t;
+
+constexpr DataRateInfo_t kDrUnused = { 0, 0, 0 };
+
+#if CFG_region == LMIC_REGION_eu868 || CFG_region == LMIC_REGION_eu433 || \
+    CFG_region == LMIC_REGION_in866
+constexpr DataRateInfo_t kUplinkDataRates[] =
+    {
+    { 125, 12, 51 },	// DR0
+    { 125, 11, 51 },	// DR1
+    { 125, 10, 51 },	// DR2
+    { 125,  9, 115 },	// DR3
+    { 125,  8, 222 },	// DR4
+    { 125,  7, 222 },	// DR5
+# if CFG_region == LMIC_REGION_in866
+    kDrUnused,		// DR6 is RFU in IN866
+# else
+    { 250,  7, 222 },	// DR6
+# endif
+    {   0,  0, 222 },	// DR7: FSK 50 kbps
+    };
+#endif
+
+#if CFG_region == LMIC_REGION_as923
+// without the dwell-time limit, DR4 and up allow 242 bytes, not the
+// 222 of EU868.
+constexpr DataRateInfo_t kUplinkDataRates[] =
+    {
+    { 125, 12, 51 },	// DR0
+    { 125, 11, 51 },	// DR1
+    { 125, 10, 51 },	// DR2
+    { 125,  9, 115 },	// DR3
+    { 125,  8, 242 },	// DR4
+    { 125,  7, 242 },	// DR5
+    { 250,  7, 242 },	// DR6
+    {   0,  0, 242 },	// DR7: FSK 50 kbps
+    };
+
+// when the uplink dwell-time limit is in effect, payloads are limited
+// to keep time-on-air under 400 ms.
+constexpr DataRateInfo_t kUplinkDataRatesDwell[] =
+    {
+    kDrUnused,		// DR0
+    kDrUnused,		// DR1
+    { 125, 10, 11 },	// DR2
+    { 125,  9, 53 },	// DR3
+    { 125,  8, 125 },	// DR4
+    { 125,  7, 242 },	// DR5
+    { 250,  7, 242 },	// DR6
+    {   0,  0, 242 },	// DR7: FSK 50 kbps
+    };
+#endif
+
+#if CFG_region == LMIC_REGION_kr920
+constexpr DataRateInfo_t kUplinkDataRates[] =
+    {
+    { 125, 12, 51 },	// DR0
+    { 125, 11, 51 },	// DR1
+    { 125, 10, 51 },	// DR2
+    { 125,  9, 115 },	// DR3
+    { 125,  8, 222 },	// DR4
+    { 125,  7, 222 },	// DR5
+    };
+#endif
+
+#if CFG_region == LMIC_REGION_us915
+constexpr DataRateInfo_t kUplinkDataRates[] =
+    {
+    { 125, 10, 11 },	// DR0
+    { 125,  9, 53 },	// DR1
+    { 125,  8, 125 },	// DR2
+    { 125,  7, 242 },	// DR3
+    { 500,  8, 242 },	// DR4
+    };
+#endif
+
+#if CFG_region == LMIC_REGION_au915
+constexpr DataRateInfo_t kUplinkDataRates[] =
+    {
+    { 125, 12, 51 },	// DR0
+    { 125, 11, 51 },	// DR1
+    { 125, 10, 51 },	// DR2
+    { 125,  9, 115 },	// DR3
+    { 125,  8, 222 },	// DR4
+    { 125,  7, 222 },	// DR5
+    { 500,  8, 222 },	// DR6
+    };
+#endif
+
+} // namespace
+
+/****************************************************************************\
+|
+|	Methods
+|
+\****************************************************************************/
+
+/*
+
+Name:	Arduino_LoRaWAN::cLMIC::GetUplinkDataRateInfo()
+
+Function:
+	Return the radio settings and payload limit of an uplink data rate.
+
+Definition:
+	static bool Arduino_LoRaWAN::cLMIC::GetUplinkDataRateInfo(
+		uint8_t dr,
+		Arduino_LoRaWAN::cLMIC::DataRateInfo_t &info
+		);
+
+Description:
+	The table for the configured region is consulted. In AS923, the
+	payload limits depend on whether the network has set the uplink
+	dwell-time limit.
+
+Returns:
+	true if dr is a valid uplink data rate, in which case info is
+	filled in; false otherwise.
+
+*/
+
+bool
+Arduino_LoRaWAN::cLMIC::GetUplinkDataRateInfo(
+    uint8_t dr,
+    DataRateInfo_t &info
+    )
+    {
+#if CFG_region == LMIC_REGION_eu868 || CFG_region == LMIC_REGION_eu433 || \
+    CFG_region == LMIC_REGION_in866 || CFG_region == LMIC_REGION_as923 || \
+    CFG_region == LMIC_REGION_kr920 || CFG_region == LMIC_REGION_us915 || \
+    CFG_region == LMIC_REGION_au915
+    const DataRateInfo_t *pTable = kUplinkDataRates;
+    size_t nTable = sizeof(kUplinkDataRates) / sizeof(kUplinkDataRates[0]);
+
+# if CFG_region == LMIC_REGION_as923 && LMIC_ENABLE_TxParamSetupReq
+    // bit 4 of TxParam is UplinkDwellTime; 0xFF means "regional default",
+    // which for AS923 has the limit in effect.
+    if (LMIC.txParam & 0x10)
+        {
+        pTable = kUplinkDataRatesDwell;
+        nTable = sizeof(kUplinkDataRatesDwell) / sizeof(kUplinkDataRatesDwell[0]);
+        }
+# endif
+
+    if (dr >= nTable)
+        return false;
+
+    auto const &entry = pTable[dr];
+    if (entry.maxPayload == 0)
+        return false;
+
+    info = entry;
+    return true;
+#else
+    // no table for this region.
+    (void) dr;
+    (void) info;
+    return false;
+#endif
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cLMIC::GetAirtimeUs()
+
+Function:
+	Compute the time-on-air of an uplink frame.
+
+Definition:
+	static uint32_t Arduino_LoRaWAN::cLMIC::GetAirtimeUs(
+		const Arduino_LoRaWAN::cLMIC::DataRateInfo_t &info,
+		size_t nPhyPayload
+		);
+
+Description:
+	For LoRa, this uses the formula from the Semtech SX1276 datasheet,
+	with the settings used for LoRaWAN uplinks: 8 preamble symbols,
+	explicit header, CRC on, coding rate 4/5, and low data-rate
+	optimization for SF11 and SF12 at 125 kHz.
+
+	For FSK (50 kbps), the frame has 5 bytes of preamble, 3 bytes
+	of sync word, a length byte, and a 2-byte CRC, at 160 us per byte.
+
+Returns:
+	Time-on-air, in microseconds.
+
+*/
+
+uint32_t
+Arduino_LoRaWAN::cLMIC::GetAirtimeUs(
+    const DataRateInfo_t &info,
+    size_t nPhyPayload
+    )
+    {
+    if (info.sf == 0)
+        return (uint32_t(nPhyPayload) + 11) * 160;
+
+    // symbol time is exact in microseconds for all LoRaWAN settings.
+    const uint32_t tSym = (uint32_t(1) << info.sf) * 1000 / info.bwKHz;
+    const int32_t sf = info.sf;
+    const int32_t de = (sf >= 11 && info.bwKHz == 125) ? 1 : 0;
+    const int32_t num = 8 * int32_t(nPhyPayload) - 4 * sf + 28 + 16;
+    const int32_t den = 4 * (sf - 2 * de);
+
+    uint32_t nPayloadSym = 8;
+    if (num > 0)
+        nPayloadSym += uint32_t((num + den - 1) / den) * 5;
+
+    // 8 preamble symbols plus 4.25 symbols of sync.
+    return tSym * (49 + 4 * nPayloadSym) / 4;
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::cLMIC::GetRpsInfo()
+
+Function:
+	Return the radio settings of an LMIC rps_t.
+
+Definition:
+	static void Arduino_LoRaWAN::cLMIC::GetRpsInfo(
+		rps_t rps,
+		Arduino_LoRaWAN::cLMIC::DataRateInfo_t &info
+		);
+
+Description:
+	The spreading factor and bandwidth are decoded from rps, for
+	example LMIC.rps while a receive window is open. maxPayload is
+	set to 255, the largest LoRa frame.
+
+Returns:
+	No explicit result.
+
+*/
+
+void
+Arduino_LoRaWAN::cLMIC::GetRpsInfo(
+    rps_t rps,
+    DataRateInfo_t &info
+    )
+    {
+    auto const sf = getSf(rps);
+
+    info.maxPayload = 255;
+    if (sf == FSK)
+        {
+        info.sf = 0;
+        info.bwKHz = 0;
+        }
+    else
+        {
+        info.sf = uint8_t(7 + sf - SF7);
+        info.bwKHz = uint16_t(125u << getBw(rps));
+        }
+    }
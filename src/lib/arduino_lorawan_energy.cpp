@@ -0,0 +1,345 @@
+/*
+
+Module:	arduino_lorawan_energy.cpp
+
+Function:
+	Arduino_LoRaWAN: radio-on time and charge accounting.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN.h>
+#include <Arduino_LoRaWAN_lmic.h>
+
+/****************************************************************************\
+|
+|	Read-only data
+|
+\****************************************************************************/
+
+namespace {
+
+// SX1276 supply current when transmitting, from the datasheet: RFO up
+// to 14 dBm, PA_BOOST above.
+constexpr Arduino_LoRaWAN::TxCurrentPoint_t kSx1276TxCurrent[] =
+    {
+    { 2, 24000 },
+    { 5, 25000 },
+    { 8, 26000 },
+    { 11, 31000 },
+    { 14, 44000 },
+    { 17, 87000 },
+    { 20, 120000 },
+    };
+
+// a join request is always 23 bytes; used if LMIC.dataLen isn't set.
+constexpr size_t kJoinRequestSize = 23;
+
+// a join accept with a CFList is 33 bytes; without, 17. Assume the worst.
+constexpr size_t kJoinAcceptSize = 33;
+
+// convert picocoulombs (microamps times microseconds) to microcoulombs.
+inline uint64_t pcToUc(uint64_t pc)
+    {
+    return (pc + 500000) / 1000000;
+    }
+
+} // namespace
+
+const Arduino_LoRaWAN::EnergyProfile_t Arduino_LoRaWAN::kDefaultEnergyProfile =
+    {
+    kSx1276TxCurrent,
+    uint8_t(sizeof(kSx1276TxCurrent) / sizeof(kSx1276TxCurrent[0])),
+    11500,
+    };
+
+/****************************************************************************\
+|
+|	Methods
+|
+\****************************************************************************/
+
+void
+Arduino_LoRaWAN::SetEnergyProfile(
+    const EnergyProfile_t *pProfile
+    )
+    {
+    if (pProfile == nullptr || pProfile->pTxCurrent == nullptr || pProfile->nTxCurrent == 0)
+        pProfile = &kDefaultEnergyProfile;
+
+    this->m_pEnergyProfile = pProfile;
+    }
+
+void
+Arduino_LoRaWAN::GetEnergyCounters(
+    EnergyCounters_t &counters
+    ) const
+    {
+    auto const &e = this->m_Energy;
+
+    counters.nTransmissions = e.nTransmissions;
+    counters.nJoinAttempts = e.nJoinAttempts;
+    counters.nRxWindows = e.nRxWindows;
+    counters.nDownlinks = e.nDownlinks;
+    counters.nMessages = e.nMessages;
+    counters.txAirtimeUs = e.txAirtimeUs;
+    counters.rxOpenUs = e.rxOpenUs;
+    counters.txChargeUc = pcToUc(e.txChargePc);
+    counters.rxChargeUc = pcToUc(e.rxChargePc);
+    counters.joinChargeUc = pcToUc(e.joinChargePc);
+    counters.lastMessageChargeUc = uint32_t(pcToUc(e.lastMessageChargePc));
+    }
+
+void
+Arduino_LoRaWAN::ResetEnergyCounters()
+    {
+    this->m_Energy = EnergyState_t {};
+    }
+
+uint32_t
+Arduino_LoRaWAN::GetTxMicroamps(
+    int8_t dBm
+    ) const
+    {
+    auto const pTable = this->m_pEnergyProfile->pTxCurrent;
+    auto const nTable = this->m_pEnergyProfile->nTxCurrent;
+
+    if (dBm <= pTable[0].dBm)
+        return pTable[0].microamps;
+
+    for (unsigned i = 1; i < nTable; ++i)
+        {
+        if (dBm <= pTable[i].dBm)
+            {
+            auto const &lo = pTable[i - 1];
+            auto const &hi = pTable[i];
+
+            return lo.microamps +
+                   int32_t(hi.microamps - lo.microamps) * (dBm - lo.dBm) / (hi.dBm - lo.dBm);
+            }
+        }
+
+    return pTable[nTable - 1].microamps;
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::GetMessageChargeEstimate()
+
+Function:
+	Estimate the charge needed to send a message now.
+
+Definition:
+	public uint32_t Arduino_LoRaWAN::GetMessageChargeEstimate(
+		size_t nBuffer
+		) const;
+
+Description:
+	The transmit charge is the time-on-air at LMIC.datarate, times
+	the profile's current at LMIC.txpow. The receive windows depend on
+	what the network sends, so the average receive charge of the
+	messages sent so far is added. Retransmissions are not included.
+
+	The frame has an FPort byte if nBuffer isn't zero, whatever the
+	port, so the port isn't needed.
+
+Returns:
+	The charge in microcoulombs, or zero if the data rate is not known.
+
+*/
+
+uint32_t
+Arduino_LoRaWAN::GetMessageChargeEstimate(
+    size_t nBuffer
+    ) const
+    {
+    cLMIC::DataRateInfo_t info;
+
+    if (! cLMIC::GetUplinkDataRateInfo(LMIC.datarate, info))
+        return 0;
+
+    auto const &e = this->m_Energy;
+    uint64_t chargePc = uint64_t(cLMIC::GetAirtimeUs(info, cLMIC::GetUplinkPhySize(nBuffer))) *
+                        this->GetTxMicroamps(LMIC.txpow);
+
+    if (e.nMessages != 0)
+        chargePc += e.messageRxChargePc / e.nMessages;
+
+    return uint32_t(pcToUc(chargePc));
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::UpdateEnergy()
+
+Function:
+	Update the energy counters for an LMIC event.
+
+Definition:
+	private void Arduino_LoRaWAN::UpdateEnergy(
+		uint32_t ev
+		);
+
+Description:
+	Called for every event, from the event processor.
+
+	EV_TXSTART: the LMIC is about to transmit. The time-on-air is
+	computed from LMIC.datarate and LMIC.dataLen, which is the size
+	of the frame being sent, FOpts included. It's charged at the
+	current for LMIC.txpow.
+
+	EV_RXSTART: the LMIC is opening a receive window; the radio
+	listens for LMIC.rxsyms symbols at LMIC.rps. This is sent from
+	the LMIC's time-critical path, so only arithmetic is done.
+
+	EV_TXCOMPLETE, EV_RXCOMPLETE and EV_JOINED: if a frame was
+	received, the receiver stayed on from the start of the window
+	until the end of the frame, rather than for the window. An uplink
+	message is complete at EV_TXCOMPLETE; a join, at EV_JOINED or
+	EV_JOIN_TXCOMPLETE.
+
+Returns:
+	No explicit result.
+
+Notes:
+	These are estimates. Downlink time-on-air is computed as for an
+	uplink (with CRC), and the FOpts of a downlink without a port
+	aren't counted.
+
+*/
+
+void
+Arduino_LoRaWAN::UpdateEnergy(
+    uint32_t ev
+    )
+    {
+    auto &e = this->m_Energy;
+
+    switch (ev)
+        {
+        case EV_TXSTART:
+            {
+            cLMIC::DataRateInfo_t info;
+            bool const fJoin = (LMIC.opmode & OP_JOINING) != 0;
+
+            if (! cLMIC::GetUplinkDataRateInfo(LMIC.datarate, info))
+                break;
+
+            // at EV_TXSTART, the LMIC has built the frame in LMIC.frame.
+            size_t nPhy = LMIC.dataLen;
+
+            if (nPhy == 0 && fJoin)
+                nPhy = kJoinRequestSize;
+
+            uint32_t const tUs = cLMIC::GetAirtimeUs(info, nPhy);
+            uint64_t const chargePc = uint64_t(tUs) * this->GetTxMicroamps(LMIC.txpow);
+
+            ++e.nTransmissions;
+            e.txAirtimeUs += tUs;
+            e.txChargePc += chargePc;
+            e.messageChargePc += chargePc;
+            if (fJoin)
+                {
+                ++e.nJoinAttempts;
+                e.joinChargePc += chargePc;
+                }
+            }
+            break;
+
+        case EV_RXSTART:
+            {
+            cLMIC::DataRateInfo_t info;
+
+            cLMIC::GetRpsInfo(LMIC.rps, info);
+
+            // a symbol is 2^sf / bw; FSK "symbols" are bytes at 50 kbps.
+            uint32_t const tSymUs = info.sf == 0
+                                        ? 160
+                                        : (uint32_t(1) << info.sf) * 1000 / info.bwKHz;
+
+            ++e.nRxWindows;
+            e.rxWindowUs = LMIC.rxsyms * tSymUs;
+            this->AddRxEnergy(e.rxWindowUs, (LMIC.opmode & OP_JOINING) != 0);
+            }
+            break;
+
+        case EV_TXCOMPLETE:
+        case EV_RXCOMPLETE:
+        case EV_JOINED:
+            {
+            size_t nPhy = 0;
+
+            if (ev == EV_JOINED)
+                nPhy = kJoinAcceptSize;
+            else if (LMIC.txrxFlags & (TXRX_DNW1 | TXRX_DNW2))
+                {
+                // MHDR through FPort, the data, and the MIC; without a
+                // port, just the headers.
+                nPhy = (LMIC.txrxFlags & TXRX_PORT)
+                            ? size_t(LMIC.dataBeg) + LMIC.dataLen + 4
+                            : 12;
+                }
+
+            if (nPhy != 0)
+                {
+                cLMIC::DataRateInfo_t info;
+
+                cLMIC::GetRpsInfo(LMIC.rps, info);
+                ++e.nDownlinks;
+
+                // the frame started in the window, which is already counted.
+                auto const tUs = cLMIC::GetAirtimeUs(info, nPhy);
+
+                if (tUs > e.rxWindowUs)
+                    this->AddRxEnergy(tUs - e.rxWindowUs, ev == EV_JOINED);
+                }
+
+            if (ev == EV_TXCOMPLETE)
+                {
+                ++e.nMessages;
+                e.lastMessageChargePc = e.messageChargePc;
+                e.messageChargePc = 0;
+                }
+            else if (ev == EV_JOINED)
+                e.messageChargePc = 0;
+            }
+            break;
+
+        case EV_JOIN_TXCOMPLETE:
+            // no join accept: the attempt is over.
+            e.messageChargePc = 0;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+void
+Arduino_LoRaWAN::AddRxEnergy(
+    uint32_t tUs,
+    bool fJoin
+    )
+    {
+    auto &e = this->m_Energy;
+    uint64_t const chargePc = uint64_t(tUs) * this->m_pEnergyProfile->rxMicroamps;
+
+    e.rxOpenUs += tUs;
+    e.rxChargePc += chargePc;
+    e.messageChargePc += chargePc;
+    if (fJoin)
+        e.joinChargePc += chargePc;
+    else
+        e.messageRxChargePc += chargePc;
+    }
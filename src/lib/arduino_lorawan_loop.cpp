@@ -40,4 +40,13 @@ Revision history:
 void Arduino_LoRaWAN::loop()
         {
         os_runloop_once();
+
+        // normally the queue is drained from the SendBuffer() completion;
+        // this catches messages that were queued while the LMIC was busy
+        // with a transmit of its own.
+        if (this->m_nUplinkQueue != 0)
+                this->ProcessUplinkQueue();
+
+        // print any LogPrintf() messages that were deferred.
+        this->ProcessDeferredLog();
         }
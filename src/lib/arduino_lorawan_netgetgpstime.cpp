@@ -0,0 +1,71 @@
+/*
+
+Module:	arduino_lorawan_netgetgpstime.cpp
+
+Function:
+	Arduino_LoRaWAN::NetGetGpsTime()
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN.h>
+#include <Arduino_LoRaWAN_lmic.h>
+
+/*
+
+Name:	Arduino_LoRaWAN::NetGetGpsTime()
+
+Function:
+	Default clock for stamping saved session state.
+
+Definition:
+	protected: virtual bool Arduino_LoRaWAN::NetGetGpsTime(
+		uint32_t &gpsTime
+		) const;
+
+Description:
+	If the LMIC has a network time reference (from a DeviceTimeAns),
+	the current GPS time is computed from it and os_getTime(). The
+	reference is only usable while the os_getTime() difference fits
+	in an ostime_t (about 9.5 hours at the usual tick rate); after
+	that, the sketch must request the network time again.
+
+Returns:
+	true if gpsTime was set, false if no time is known.
+
+*/
+
+bool
+Arduino_LoRaWAN::NetGetGpsTime(
+    uint32_t &gpsTime
+    ) const
+    {
+#if LMIC_ENABLE_DeviceTimeReq
+    lmic_time_reference_t ref;
+
+    if (LMIC_getNetworkTimeReference(&ref))
+        {
+        auto const tDelta = os_getTime() - ref.tLocal;
+
+        if (tDelta >= 0)
+            {
+            gpsTime = uint32_t(ref.tNetwork) + uint32_t(tDelta / OSTICKS_PER_SEC);
+            return true;
+            }
+        }
+#endif
+
+    MCCIADK_API_PARAMETER(gpsTime);
+    return false;
+    }
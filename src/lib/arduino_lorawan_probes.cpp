@@ -0,0 +1,353 @@
+/*
+
+Module:	arduino_lorawan_probes.cpp
+
+Function:
+	Arduino_LoRaWAN_Probes: statistics, and the probe counter.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN.h>
+
+#include <stdio.h>
+#include <string.h>
+
+/****************************************************************************\
+|
+|	The counter
+|
+\****************************************************************************/
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__)
+# define ARDUINO_LORAWAN_PROBES_DWT_	1
+#else
+# define ARDUINO_LORAWAN_PROBES_DWT_	0
+#endif
+
+namespace {
+
+#if ARDUINO_LORAWAN_PROBES_DWT_
+// the Cortex-M debug registers for the cycle counter.
+volatile std::uint32_t &rDEMCR = *reinterpret_cast<volatile std::uint32_t *>(0xE000EDFCu);
+volatile std::uint32_t &rDWT_CTRL = *reinterpret_cast<volatile std::uint32_t *>(0xE0001000u);
+volatile std::uint32_t &rDWT_CYCCNT = *reinterpret_cast<volatile std::uint32_t *>(0xE0001004u);
+volatile std::uint32_t &rDWT_LAR = *reinterpret_cast<volatile std::uint32_t *>(0xE0001FB0u);
+
+std::uint32_t readCycles()
+    {
+    return rDWT_CYCCNT;
+    }
+
+constexpr Arduino_LoRaWAN_Probes::CounterFn_t *kDefaultCounter = readCycles;
+constexpr const char *kDefaultCounterUnits = "cycles";
+#elif defined(ARDUINO_ARCH_ESP32)
+std::uint32_t readCycles()
+    {
+    return ESP.getCycleCount();
+    }
+
+constexpr Arduino_LoRaWAN_Probes::CounterFn_t *kDefaultCounter = readCycles;
+constexpr const char *kDefaultCounterUnits = "cycles";
+#else
+constexpr Arduino_LoRaWAN_Probes::CounterFn_t *kDefaultCounter = Arduino_LoRaWAN_Probes::readMicros;
+constexpr const char *kDefaultCounterUnits = "us";
+#endif
+
+} // namespace
+
+Arduino_LoRaWAN_Probes::CounterFn_t *Arduino_LoRaWAN_Probes::s_pCounter = kDefaultCounter;
+const char *Arduino_LoRaWAN_Probes::s_pCounterUnits = kDefaultCounterUnits;
+volatile std::uint32_t Arduino_LoRaWAN_Probes::s_tIrq;
+volatile bool Arduino_LoRaWAN_Probes::s_fIrq;
+
+void
+Arduino_LoRaWAN_Probes::setCounter(
+    CounterFn_t *pFn,
+    const char *pUnits
+    )
+    {
+    bool const fDefault = pFn == nullptr;
+
+    if (fDefault)
+        {
+        pFn = kDefaultCounter;
+        pUnits = kDefaultCounterUnits;
+        }
+    else if (pUnits == nullptr)
+        pUnits = "counts";
+
+    s_pCounter = pFn;
+    s_pCounterUnits = pUnits;
+
+    // check the default again, in case it doesn't count.
+    if (fDefault)
+        beginCounter();
+    }
+
+void
+Arduino_LoRaWAN_Probes::beginCounter()
+    {
+#if ARDUINO_LORAWAN_PROBES_DWT_
+    rDEMCR |= std::uint32_t(1) << 24;           // TRCENA
+# if defined(__ARM_ARCH_7EM__)
+    // the Cortex-M7 DWT ignores writes until it's unlocked.
+    rDWT_LAR = 0xC5ACCE55u;
+# endif
+    rDWT_CTRL |= 1;                             // CYCCNTENA
+
+    // some parts don't have CYCCNT, or gate it off; use micros() then.
+    if (s_pCounter == readCycles)
+        {
+        auto const tStart = rDWT_CYCCNT;
+
+        for (volatile unsigned i = 0; i < 4; ++i)
+            /* let some cycles go by */;
+
+        if (rDWT_CYCCNT == tStart)
+            {
+            s_pCounter = readMicros;
+            s_pCounterUnits = "us";
+            }
+        }
+#endif
+    }
+
+std::uint32_t
+Arduino_LoRaWAN_Probes::readMicros()
+    {
+    return micros();
+    }
+
+void
+Arduino_LoRaWAN_Probes::markIrq()
+    {
+    s_tIrq = readCounter();
+    s_fIrq = true;
+    }
+
+bool
+Arduino_LoRaWAN_Probes::takeIrq(
+    std::uint32_t &tIrq
+    )
+    {
+    if (! s_fIrq)
+        return false;
+
+    // if another interrupt comes in here, its time is lost; that's
+    // better than disabling interrupts on the event path.
+    tIrq = s_tIrq;
+    s_fIrq = false;
+    return true;
+    }
+
+/****************************************************************************\
+|
+|	The statistics
+|
+\****************************************************************************/
+
+namespace {
+
+struct ProbeName_t
+    {
+    Arduino_LoRaWAN_Probes::ProbeId id;
+    const char *pName;
+    };
+
+// indexed by ProbeId.
+constexpr ProbeName_t kProbeNames[] =
+    {
+    { Arduino_LoRaWAN_Probes::ProbeId::OnEvent,                 "onEvent" },
+    { Arduino_LoRaWAN_Probes::ProbeId::DispatchEvent,           "DispatchEvent" },
+    { Arduino_LoRaWAN_Probes::ProbeId::SaveSessionState,        "SaveSessionState" },
+    { Arduino_LoRaWAN_Probes::ProbeId::NetRxComplete,           "NetRxComplete" },
+    { Arduino_LoRaWAN_Probes::ProbeId::SendBuffer,              "SendBuffer" },
+    { Arduino_LoRaWAN_Probes::ProbeId::IrqToEvent,              "irq->onEvent" },
+    { Arduino_LoRaWAN_Probes::ProbeId::TxCompleteToSendBuffer,  "txcomplete->SendBuffer" },
+    };
+
+static_assert(Arduino_LoRaWAN_NameTable::isIndexed(kProbeNames),
+    "kProbeNames is out of order");
+static_assert(Arduino_LoRaWAN_NameTable::size(kProbeNames) == Arduino_LoRaWAN_Probes::kProbeCount,
+    "kProbeNames needs an entry for every ProbeId");
+
+// the histogram bucket for v: the number of its highest bit set, or zero.
+unsigned getBucket(std::uint32_t v)
+    {
+    unsigned result = 0;
+
+    while (v > 1)
+        {
+        v >>= 1;
+        ++result;
+        }
+
+    return result;
+    }
+
+} // namespace
+
+const char *
+Arduino_LoRaWAN_Probes::getName(
+    ProbeId id
+    )
+    {
+    if (unsigned(id) >= kProbeCount)
+        return "<<unknown>>";
+
+    return kProbeNames[unsigned(id)].pName;
+    }
+
+void
+Arduino_LoRaWAN_Probes::addSample(
+    ProbeId id,
+    std::uint32_t count
+    )
+    {
+    if (unsigned(id) >= kProbeCount)
+        return;
+
+    auto &stats = this->m_stats[unsigned(id)];
+
+    if (stats.nSamples == 0 || count < stats.min)
+        stats.min = count;
+    if (count > stats.max)
+        stats.max = count;
+
+    ++stats.nSamples;
+    stats.sum += count;
+
+    auto &bucket = stats.buckets[getBucket(count)];
+
+    if (bucket != 0xFFFF)
+        ++bucket;
+    }
+
+bool
+Arduino_LoRaWAN_Probes::getStats(
+    ProbeId id,
+    Stats_t &stats
+    ) const
+    {
+    if (unsigned(id) >= kProbeCount)
+        return false;
+
+    stats = this->m_stats[unsigned(id)];
+    return true;
+    }
+
+void
+Arduino_LoRaWAN_Probes::reset()
+    {
+    memset(this->m_stats, 0, sizeof(this->m_stats));
+    this->m_fInterval = 0;
+    }
+
+void
+Arduino_LoRaWAN_Probes::reset(
+    ProbeId id
+    )
+    {
+    if (unsigned(id) >= kProbeCount)
+        return;
+
+    memset(&this->m_stats[unsigned(id)], 0, sizeof(this->m_stats[0]));
+    this->m_fInterval &= ~(std::uint32_t(1) << unsigned(id));
+    }
+
+void
+Arduino_LoRaWAN_Probes::beginInterval(
+    ProbeId id
+    )
+    {
+    if (unsigned(id) >= kProbeCount)
+        return;
+
+    this->m_tInterval[unsigned(id)] = readCounter();
+    this->m_fInterval |= std::uint32_t(1) << unsigned(id);
+    }
+
+void
+Arduino_LoRaWAN_Probes::endInterval(
+    ProbeId id
+    )
+    {
+    auto const mask = std::uint32_t(1) << unsigned(id);
+
+    if (unsigned(id) >= kProbeCount || (this->m_fInterval & mask) == 0)
+        return;
+
+    this->m_fInterval &= ~mask;
+    this->addSample(id, readCounter() - this->m_tInterval[unsigned(id)]);
+    }
+
+void
+Arduino_LoRaWAN_Probes::print(
+    Print &out
+    ) const
+    {
+    char line[96];
+    auto const write = [&out](const char *s)
+        {
+        out.write(reinterpret_cast<const uint8_t *>(s), strlen(s));
+        };
+
+    snprintf(line, sizeof(line), "%-22s %8s %10s %10s %10s (%s)\n",
+        "probe", "samples", "min", "mean", "max", getCounterUnits()
+        );
+    write(line);
+
+    for (unsigned iProbe = 0; iProbe < kProbeCount; ++iProbe)
+        {
+        auto const &stats = this->m_stats[iProbe];
+
+        if (stats.nSamples == 0)
+            continue;
+
+        snprintf(line, sizeof(line), "%-22s %8lu %10lu %10lu %10lu\n",
+            kProbeNames[iProbe].pName,
+            (unsigned long) stats.nSamples,
+            (unsigned long) stats.min,
+            (unsigned long) stats.mean(),
+            (unsigned long) stats.max
+            );
+        write(line);
+
+        // the histogram, on its own line.
+        size_t n = 0;
+
+        line[0] = '\0';
+        for (unsigned iBucket = 0; iBucket < kBuckets && n < sizeof(line); ++iBucket)
+            {
+            if (stats.buckets[iBucket] == 0)
+                continue;
+
+            auto const nWritten = snprintf(line + n, sizeof(line) - n, " %u:%u",
+                iBucket, unsigned(stats.buckets[iBucket])
+                );
+
+            if (nWritten < 0)
+                break;
+            n += size_t(nWritten);
+            }
+
+        if (n >= sizeof(line))
+            n = sizeof(line) - 1;
+
+        write("    log2:");
+        write(line);
+        write("\n");
+        }
+    }
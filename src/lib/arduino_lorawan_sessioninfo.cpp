@@ -0,0 +1,94 @@
+/*
+
+Module:	arduino_lorawan_sessioninfo.cpp
+
+Function:
+	Arduino_LoRaWAN::SessionInfo methods.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN.h>
+
+/*
+
+Name:	Arduino_LoRaWAN::SessionInfo::isValid()
+
+Function:
+	Check a SessionInfo record.
+
+Definition:
+	bool Arduino_LoRaWAN::SessionInfo::isValid() const;
+
+Description:
+	The record must be the current version (V3), with the expected
+	size and a matching CRC.
+
+Returns:
+	true if the record is intact.
+
+*/
+
+bool
+Arduino_LoRaWAN::SessionInfo::isValid() const
+    {
+    return this->Header.Tag == kSessionInfoTag_V3 &&
+           this->Header.Size == sizeof(*this) &&
+           this->V3.Crc == this->computeCrc();
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::SessionInfo::upgrade()
+
+Function:
+	Convert an older SessionInfo record to the current version.
+
+Definition:
+	bool Arduino_LoRaWAN::SessionInfo::upgrade();
+
+Description:
+	V1 and V2 records have the same NetID, DevAddr and keys as V3, at
+	the same offsets, but no CRC. So converting one is just a matter of
+	changing the tag and adding the CRC. The frame counts that V1 kept
+	after the keys are overwritten; they are restored from SessionState.
+
+	A record that is already V3 is left alone.
+
+Returns:
+	The result of isValid() after the conversion.
+
+*/
+
+bool
+Arduino_LoRaWAN::SessionInfo::upgrade()
+    {
+    if ((this->Header.Tag == kSessionInfoTag_V1 ||
+         this->Header.Tag == kSessionInfoTag_V2) &&
+        this->Header.Size == sizeof(*this))
+        {
+        this->V3.Tag = kSessionInfoTag_V3;
+        this->V3.Rsv2 = 0;
+        this->V3.Rsv3 = 0;
+        this->V3.Crc = this->computeCrc();
+        }
+
+    return this->isValid();
+    }
+
+uint32_t
+Arduino_LoRaWAN::SessionInfo::computeCrc() const
+    {
+    return Arduino_LoRaWAN::Crc32(this, offsetof(SessionInfoV3, Crc));
+    }
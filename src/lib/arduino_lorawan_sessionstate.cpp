@@ -23,6 +23,25 @@ Author:
 
 #include <arduino_lmic_hal_boards.h>
 #include <Arduino_LoRaWAN_lmic.h>
+
+/****************************************************************************\
+|
+|	Local functions
+|
+\****************************************************************************/
+
+// shorten a saved wait (in ticks, relative to the save) by the time
+// that has passed since. A wait that was already over stays as it was.
+static inline int32_t
+reduceWait(uint32_t tSavedWait, int32_t tElapsed)
+    {
+    auto const tWait = int32_t(tSavedWait);
+
+    if (tWait <= 0)
+        return tWait;
+
+    return tWait > tElapsed ? tWait - tElapsed : 0;
+    }
 
 /*
 
@@ -38,7 +57,8 @@ Definition:
 
 Description:
 	Session state is extracted from the LMIC data structure and
-	placed into `State`.
+	placed into `State`. The fields that change on every uplink
+	are filled in by BuildSessionStateCounters().
 
 Returns:
 	No explicit result.
@@ -59,16 +79,10 @@ Arduino_LoRaWAN::BuildSessionState(
 
     memset(&State, 0, sizeof(State));
 
-    State.Header.Tag = kSessionStateTag_V1;
-    State.Header.Size = sizeof(State);
+    State.Header.Tag = kSessionStateTag_V2;
+    State.Header.Size = sizeof(SessionStateV2);
     State.V1.Region = uint8_t(this->GetRegion());
     State.V1.LinkDR = LMIC.datarate;
-
-    State.V1.FCntUp = LMIC.seqnoUp;
-    State.V1.FCntDown = LMIC.seqnoDn;
-    // TODO(tmm@mcci.com): set GPS time to our best idea
-    // State.V1.gpsTime = 0; -- already try via memset().
-    State.V1.globalAvail = LMIC.globalDutyAvail - tNow;
     State.V1.Rx2Frequency = LMIC.dn2Freq;
 
 #if !defined(DISABLE_PING)
@@ -76,7 +90,6 @@ Arduino_LoRaWAN::BuildSessionState(
 #endif
 
     State.V1.Country = uint16_t(this->GetCountryCode());
-    State.V1.LinkIntegrity = LMIC.adrAckReq;
     State.V1.TxPower = LMIC.adrTxPow;
     State.V1.Redundancy = LMIC.upRepeat;
     State.V1.DutyCycle = LMIC.globalDutyRate;
@@ -103,9 +116,6 @@ Arduino_LoRaWAN::BuildSessionState(
     State.V1.Channels.EUlike.clearAll();
     constexpr unsigned maxCh = MAX_CHANNELS < State.V1.Channels.EUlike.nCh ? MAX_CHANNELS : State.V1.Channels.EUlike.nCh;
     State.V1.Channels.EUlike.ChannelMap = LMIC.channelMap;
-#if ARDUINO_LMIC_VERSION_COMPARE_GE(ARDUINO_LMIC_VERSION, ARDUINO_LMIC_VERSION_CALC(3,99,0,1))
-    State.V1.Channels.EUlike.ChannelShuffleMap = LMIC.channelShuffleMap;
-#endif
 
     // EU: save channel settings
     for (unsigned ch = 0; ch < maxCh; ++ch)
@@ -127,25 +137,12 @@ Arduino_LoRaWAN::BuildSessionState(
 
         band.txDutyDenom = LMIC.bands[iBand].txpow;
         band.txPower = LMIC.bands[iBand].txpow;
-        band.lastChannel = LMIC.bands[iBand].lastchnl;
-
-        // don't record tAval from the past, and only record into the future.
-        auto const tDelta = LMIC.bands[iBand].avail - tNow;
-        band.ostimeAvail = tDelta > 0 ? tDelta : 0;
         }
 
 #elif CFG_LMIC_US_like
     State.V1.Channels.Header.Tag = State.V1.Channels.Header.kUSlike;
     State.V1.Channels.Header.Size = sizeof(State.V1.Channels.USlike);
 
-#if ARDUINO_LMIC_VERSION_COMPARE_GE(ARDUINO_LMIC_VERSION, ARDUINO_LMIC_VERSION_CALC(3,99,0,1))
-    static_assert(
-        sizeof(State.V1.Channels.USlike.ChannelShuffleMap) == sizeof(LMIC.channelShuffleMap),
-        "USlink.ChannelShuffleMap size is wrong"
-        );
-    memcpy(State.V1.Channels.USlike.ChannelShuffleMap, LMIC.channelShuffleMap, sizeof(State.V1.Channels.USlike.ChannelShuffleMap));
-#endif
-
     State.V1.Channels.USlike.clearAll();
     for (unsigned ch = 0; ch < State.V1.Channels.USlike.nCh; ++ch)
         {
@@ -153,9 +150,79 @@ Arduino_LoRaWAN::BuildSessionState(
         State.V1.Channels.USlike.enable(ch, state);
         }
 #endif
+
+    this->BuildSessionStateCounters(State, tNow);
+    State.updateCrc();
 	}
 
 #undef FUNCTION
+
+/*
+
+Name:	Arduino_LoRaWAN::BuildSessionStateCounters()
+
+Function:
+	Update the session-state fields that change on every uplink.
+
+Definition:
+	void Arduino_LoRaWAN::BuildSessionStateCounters(
+		Arduino_LoRaWAN::SessionState &State,
+		uint32_t tNow
+		) const;
+
+Description:
+	The frame counts, the time stamp, the link-integrity count, the
+	duty-cycle timers, and the channel rotation state are copied from
+	the LMIC into `State`. Everything else is left alone, so a saved
+	state can be brought up to date without rebuilding it. The CRC is
+	not updated.
+
+Returns:
+	No explicit result.
+
+*/
+
+void
+Arduino_LoRaWAN::BuildSessionStateCounters(
+    Arduino_LoRaWAN::SessionState &State,
+    uint32_t tNow
+    ) const
+    {
+    State.V1.FCntUp = LMIC.seqnoUp;
+    State.V1.FCntDown = LMIC.seqnoDn;
+    // stamp the time, if we know it, so the relative times below can
+    // be corrected at restore; otherwise leave gpsTime zero.
+    uint32_t gpsTime;
+    State.V1.gpsTime = this->NetGetGpsTime(gpsTime) ? gpsTime : 0;
+    State.V1.globalAvail = LMIC.globalDutyAvail - tNow;
+    State.V1.LinkIntegrity = LMIC.adrAckReq;
+
+#if CFG_LMIC_EU_like
+# if ARDUINO_LMIC_VERSION_COMPARE_GE(ARDUINO_LMIC_VERSION, ARDUINO_LMIC_VERSION_CALC(3,99,0,1))
+    State.V1.Channels.EUlike.ChannelShuffleMap = LMIC.channelShuffleMap;
+# endif
+
+    for (unsigned iBand = 0; iBand < State.V1.Channels.EUlike.nBands; ++iBand)
+        {
+        auto & band = State.V1.Channels.EUlike.Bands[iBand];
+
+        band.lastChannel = LMIC.bands[iBand].lastchnl;
+
+        // don't record tAval from the past, and only record into the future.
+        auto const tDelta = int32_t(LMIC.bands[iBand].avail - tNow);
+        band.ostimeAvail = tDelta > 0 ? tDelta : 0;
+        }
+
+#elif CFG_LMIC_US_like
+# if ARDUINO_LMIC_VERSION_COMPARE_GE(ARDUINO_LMIC_VERSION, ARDUINO_LMIC_VERSION_CALC(3,99,0,1))
+    static_assert(
+        sizeof(State.V1.Channels.USlike.ChannelShuffleMap) == sizeof(LMIC.channelShuffleMap),
+        "USlink.ChannelShuffleMap size is wrong"
+        );
+    memcpy(State.V1.Channels.USlike.ChannelShuffleMap, LMIC.channelShuffleMap, sizeof(State.V1.Channels.USlike.ChannelShuffleMap));
+# endif
+#endif
+    }
 
 /*
 
@@ -170,31 +237,302 @@ Definition:
         );
 
 Description:
-    This is just a convenience wrapper: first build, then
-    save the session state. The client must have supplied
-    a virtual override for NetSaveSessionState() to actually
-    do the save.
+    The work done depends on m_SessionStateDirty, which the event
+    processor sets according to what each event can change. If nothing
+    is marked, nothing is saved. If only the counters are marked, the
+    last state saved (or restored) is copied and brought up to date
+    with BuildSessionStateCounters(), and only the counter fields are
+    compared. Otherwise the state is rebuilt, and compared in full.
+    The CRC is part of the state, so a delta save always includes it.
+
+    In journal mode (see SetFCntJournalInterval()), the state is first
+    passed through ApplyFCntJournal(), which may decide that no save
+    is needed.
+
+    If the previous state is valid, the changed bytes are gathered
+    into at most kSessionStateDeltaMaxRanges ranges, and each range
+    is offered to NetSaveSessionStateDelta(). If there are too many
+    ranges, or the client declines a range, NetSaveSessionState()
+    is called to save the whole state. The client must have supplied
+    a virtual override for one or both to actually do the save.
 
 Returns:
     No explicit result.
 
 Notes:
-
+    The LMIC changes its configuration only in response to a join, a
+    downlink (MAC commands), a reset, or ADR backoff; the event
+    processor marks the configuration dirty for those. A sketch that
+    changes the LMIC configuration itself must call
+    NoteSessionStateChanged().
 
 */
 
+namespace {
+
+struct SessionStateRange_t
+    {
+    size_t offset;
+    size_t nBytes;
+    };
+
+// find the bytes in [iBegin, iEnd) that differ, and add them to
+// pRanges[]. Changes separated by fewer than minGap unchanged bytes are
+// merged, including with the last range already found. Returns false
+// if there are too many ranges.
+bool
+addChangedRanges(
+    const uint8_t *pNew,
+    const uint8_t *pOld,
+    size_t iBegin,
+    size_t iEnd,
+    size_t minGap,
+    SessionStateRange_t *pRanges,
+    unsigned maxRanges,
+    unsigned &nRanges
+    )
+    {
+    for (size_t i = iBegin; i < iEnd; )
+        {
+        if (pNew[i] == pOld[i])
+            {
+            ++i;
+            continue;
+            }
+
+        // i starts a changed range; extend it until we see a long
+        // enough run of unchanged bytes.
+        size_t iLast = i + 1;
+        size_t j = iLast;
+
+        for (; j < iEnd && j - iLast < minGap; ++j)
+            {
+            if (pNew[j] != pOld[j])
+                iLast = j + 1;
+            }
+
+        auto const pPrev = nRanges == 0 ? nullptr : &pRanges[nRanges - 1];
+
+        if (pPrev != nullptr && i - (pPrev->offset + pPrev->nBytes) < minGap)
+            pPrev->nBytes = iLast - pPrev->offset;
+        else if (nRanges == maxRanges)
+            return false;
+        else
+            {
+            pRanges[nRanges].offset = i;
+            pRanges[nRanges].nBytes = iLast - i;
+            ++nRanges;
+            }
+
+        i = j;
+        }
+
+    return true;
+    }
+
+} // namespace
+
 void Arduino_LoRaWAN::SaveSessionState()
     {
+    ARDUINO_LORAWAN_PROBE_SCOPE(this->m_Probes, SaveSessionState);
+
+    auto const dirty = this->m_SessionStateDirty;
+    // m_savedSessionState is only ever set to a valid state, so the
+    // tag is enough; checking the CRC would cost as much as a build.
+    bool const fSavedValid = this->m_savedSessionState.Header.Tag == kSessionStateTag_V2;
+
+    if (dirty == 0 && fSavedValid)
+        return;
+
+    this->m_SessionStateDirty = 0;
+
     SessionState State;
+    bool const fCountersOnly = fSavedValid && dirty == kSessionStateDirty_Counters;
+
+    if (fCountersOnly)
+        {
+        State = this->m_savedSessionState;
+        this->BuildSessionStateCounters(State, os_getTime());
+        }
+    else
+        this->BuildSessionState(State);
+
+    // BuildSessionState() sets the CRC; otherwise it's out of date.
+    bool fUpdateCrc = fCountersOnly;
+
+    if (this->m_FCntJournalInterval != 0)
+        {
+        if (! this->ApplyFCntJournal(State))
+            return;
+
+        // FCntUp might have changed.
+        fUpdateCrc = true;
+        }
 
-    this->BuildSessionState(State);
-    if (memcmp(&State, &this->m_savedSessionState, sizeof(State)) != 0)
+    if (fUpdateCrc)
+        State.updateCrc();
+
+    auto const pNew = reinterpret_cast<const uint8_t *>(&State);
+    auto const pOld = reinterpret_cast<const uint8_t *>(&this->m_savedSessionState);
+    SessionStateRange_t ranges[kSessionStateDeltaMaxRanges];
+    unsigned nRanges = 0;
+
+    // a delta is only meaningful against a complete saved state.
+    bool fFullSave = ! fSavedValid;
+
+    if (! fFullSave && ! fCountersOnly)
         {
-        this->m_savedSessionState = State;
+        fFullSave = ! addChangedRanges(
+                        pNew, pOld, 0, sizeof(State), kSessionStateDeltaMinGap,
+                        ranges, kSessionStateDeltaMaxRanges, nRanges
+                        );
+        }
+    else if (! fFullSave)
+        {
+        // only the fields written by BuildSessionStateCounters(), and the CRC.
+        static constexpr SessionStateRange_t kCounterFields[] =
+            {
+            { offsetof(SessionStateV1, FCntUp), offsetof(SessionStateV1, Rx2Frequency) - offsetof(SessionStateV1, FCntUp) },
+            { offsetof(SessionStateV1, LinkIntegrity), sizeof(SessionStateV1::LinkIntegrity) },
+#if CFG_LMIC_EU_like
+            {
+            offsetof(SessionStateV1, Channels) + offsetof(SessionChannelMask_EU_like<16>, ChannelShuffleMap),
+            sizeof(SessionChannelMask_EU_like<16>::ChannelShuffleMap)
+            },
+            {
+            offsetof(SessionStateV1, Channels) + offsetof(SessionChannelMask_EU_like<16>, Bands),
+            sizeof(SessionChannelMask_EU_like<16>::Bands)
+            },
+#elif CFG_LMIC_US_like
+            {
+            offsetof(SessionStateV1, Channels) + offsetof(SessionChannelMask_US_like<64 + 8>, ChannelShuffleMap),
+            sizeof(SessionChannelMask_US_like<64 + 8>::ChannelShuffleMap)
+            },
+#endif
+            { offsetof(SessionStateV2, Crc), sizeof(SessionStateV2::Crc) },
+            };
+
+        for (auto const &field : kCounterFields)
+            {
+            if (! addChangedRanges(
+                    pNew, pOld, field.offset, field.offset + field.nBytes, kSessionStateDeltaMinGap,
+                    ranges, kSessionStateDeltaMaxRanges, nRanges
+                    ))
+                {
+                fFullSave = true;
+                break;
+                }
+            }
+        }
+
+    if (! fFullSave && nRanges == 0)
+        return;
+
+    this->m_savedSessionState = State;
+
+    for (unsigned iRange = 0; iRange < nRanges && ! fFullSave; ++iRange)
+        {
+        if (! this->NetSaveSessionStateDelta(State, ranges[iRange].offset, ranges[iRange].nBytes))
+            fFullSave = true;
+        }
+
+    if (fFullSave)
         this->NetSaveSessionState(State);
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::ApplyFCntJournal()
+
+Function:
+    Internal: apply the FCnt journal policy to a new session state.
+
+Definition:
+    bool Arduino_LoRaWAN::ApplyFCntJournal(
+        Arduino_LoRaWAN::SessionState &State
+        ) const;
+
+Description:
+    The saved FCntUp is a reservation: the LMIC may use any count below
+    it without another save. While LMIC.seqnoUp is below the saved
+    reservation, State.V1.FCntUp is set back to the reservation. Once
+    the LMIC reaches it, a new reservation m_FCntJournalInterval ahead
+    is made.
+
+    We then check whether anything other than the downlink count, the
+    link-integrity count, the time stamp, the duty-cycle timers, and the
+    channel rotation state has changed.
+    Those are always stale after a restart anyway, and the LMIC
+    recovers from stale values; so by themselves they don't justify
+    a write.
+
+    Because the reservation is made before any count in it is used,
+    a restored FCntUp has never been sent, even if the device resets
+    just before a save.
+
+Returns:
+    true if State should be saved, false otherwise.
+
+Notes:
+    The downlink count is not advanced on restore: the network's count
+    is what matters, and jumping ahead would reject valid downlinks.
+    A stale link-integrity count (LMIC.adrAckReq) only delays the ADR
+    back-off after a restart.
+
+*/
+
+bool
+Arduino_LoRaWAN::ApplyFCntJournal(
+    Arduino_LoRaWAN::SessionState &State
+    ) const
+    {
+    auto const &Saved = this->m_savedSessionState;
+
+    if (Saved.Header.Tag != kSessionStateTag_V2)
+        {
+        State.V1.FCntUp = LMIC.seqnoUp + this->m_FCntJournalInterval;
+        return true;
         }
+
+    if (int32_t(LMIC.seqnoUp - Saved.V1.FCntUp) < 0)
+        {
+        // still inside the reservation.
+        State.V1.FCntUp = Saved.V1.FCntUp;
+        }
+    else
+        {
+        State.V1.FCntUp = LMIC.seqnoUp + this->m_FCntJournalInterval;
+        return true;
+        }
+
+    // compare, ignoring the fields that change without any change
+    // in configuration.
+    SessionState Trial = State;
+
+    Trial.V1.FCntDown = Saved.V1.FCntDown;
+    Trial.V1.LinkIntegrity = Saved.V1.LinkIntegrity;
+    Trial.V1.gpsTime = Saved.V1.gpsTime;
+    Trial.V1.globalAvail = Saved.V1.globalAvail;
+    Trial.V2.Crc = Saved.V2.Crc;
+
+#if CFG_LMIC_EU_like
+    Trial.V1.Channels.EUlike.ChannelShuffleMap = Saved.V1.Channels.EUlike.ChannelShuffleMap;
+    for (unsigned iBand = 0; iBand < Trial.V1.Channels.EUlike.nBands; ++iBand)
+        {
+        Trial.V1.Channels.EUlike.Bands[iBand].lastChannel = Saved.V1.Channels.EUlike.Bands[iBand].lastChannel;
+        Trial.V1.Channels.EUlike.Bands[iBand].ostimeAvail = Saved.V1.Channels.EUlike.Bands[iBand].ostimeAvail;
+        }
+#elif CFG_LMIC_US_like
+    std::memcpy(
+        Trial.V1.Channels.USlike.ChannelShuffleMap,
+        Saved.V1.Channels.USlike.ChannelShuffleMap,
+        sizeof(Trial.V1.Channels.USlike.ChannelShuffleMap)
+        );
+#endif
+
+    return std::memcmp(&Trial, &Saved, sizeof(Trial)) != 0;
     }
-
+
 /*
 
 Name:	Arduino_LoRaWAN::SaveSessionState()
@@ -211,8 +549,10 @@ Description:
     This is just a convenience wrapper: first fetch, then
     apply the session state. The client must have supplied
     a virtual override for NetSaveSessionState() to actually
-    do the save. The restored state must generally match
-    the configured region, or it will be ignored.
+    do the save. An older version of the state is upgraded
+    first; a state that fails its CRC is ignored. The restored
+    state must also match the configured region, or it will
+    be ignored.
 
 Returns:
     No explicit result.
@@ -229,6 +569,17 @@ bool Arduino_LoRaWAN::RestoreSessionState()
     if (! this->NetGetSessionState(State))
         return false;
 
+    if (! State.upgrade())
+        {
+        ARDUINO_LORAWAN_PRINTF(
+            LogVerbose,
+            "saved session state rejected (tag %u, size %u)\n",
+            unsigned(State.Header.Tag),
+            unsigned(State.Header.Size)
+            );
+        return false;
+        }
+
     return this->ApplySessionState(State);
     }
 
@@ -274,10 +625,36 @@ bool Arduino_LoRaWAN::IsValidState(const Arduino_LoRaWAN::SessionState &state) c
 
 bool Arduino_LoRaWAN::SessionState::isValid() const
     {
-    if (! (this->Header.Tag == kSessionStateTag_V1 &&
-           this->Header.Size == sizeof(*this)))
+    if (! (this->Header.Tag == kSessionStateTag_V2 &&
+           this->Header.Size == sizeof(SessionStateV2)))
           return false;
 
+    // the CRC catches torn or partial writes; then check the contents.
+    return this->V2.Crc == this->computeCrc() && this->isValidChannels();
+    }
+
+bool Arduino_LoRaWAN::SessionState::upgrade()
+    {
+    // V1 is V2 without the CRC; all we can do is check the layout.
+    if (this->Header.Tag == kSessionStateTag_V1 &&
+        this->Header.Size == sizeof(SessionStateV1) &&
+        this->isValidChannels())
+        {
+        this->V1.Tag = kSessionStateTag_V2;
+        this->V1.Size = sizeof(SessionStateV2);
+        this->updateCrc();
+        }
+
+    return this->isValid();
+    }
+
+uint32_t Arduino_LoRaWAN::SessionState::computeCrc() const
+    {
+    return Arduino_LoRaWAN::Crc32(&this->V2.Body, sizeof(this->V2.Body));
+    }
+
+bool Arduino_LoRaWAN::SessionState::isValidChannels() const
+    {
     switch (this->V1.Channels.Header.Tag)
         {
     case Arduino_LoRaWAN::SessionChannelMask_Header::eMaskKind::kEUlike:
@@ -294,6 +671,51 @@ bool Arduino_LoRaWAN::SessionState::isValid() const
         }
     }
 
+/*
+
+Name:	Arduino_LoRaWAN::GetSessionStateAge()
+
+Function:
+    Internal: work out how long ago a session state was saved.
+
+Definition:
+    int32_t Arduino_LoRaWAN::GetSessionStateAge(
+        const Arduino_LoRaWAN::SessionState &State
+        ) const;
+
+Description:
+    If the state has a time stamp and NetGetGpsTime() gives the current
+    time, the difference is returned in os_getTime() ticks. The stamp
+    is only good to a second, so one second is taken off, to be sure
+    we never shorten a regulatory wait. Ages too large for an ostime_t
+    are limited to the largest that fits; that's far longer than any
+    wait we'd save.
+
+Returns:
+    Age in ticks, or zero if unknown (including if the clock seems to
+    have gone backwards).
+
+*/
+
+int32_t
+Arduino_LoRaWAN::GetSessionStateAge(
+    const Arduino_LoRaWAN::SessionState &State
+    ) const
+    {
+    constexpr uint32_t kMaxAgeSec = INT32_MAX / OSTICKS_PER_SEC;
+    uint32_t gpsNow;
+
+    if (State.V1.gpsTime == 0 || ! this->NetGetGpsTime(gpsNow))
+        return 0;
+
+    auto const dt = int32_t(gpsNow - State.V1.gpsTime) - 1;
+
+    if (dt <= 0)
+        return 0;
+
+    return sec2osticks(uint32_t(dt) < kMaxAgeSec ? uint32_t(dt) : kMaxAgeSec);
+    }
+
 #define FUNCTION "Arduino_LoRaWAN::ApplySessionState"
 
 bool
@@ -307,8 +729,10 @@ Arduino_LoRaWAN::ApplySessionState(
 
     auto const tNow = os_getTime();
 
-    // record that we've done it.
+    // record that we've done it. The LMIC may not take the state
+    // exactly as saved, so compare it all at the next save.
     this->m_savedSessionState = State;
+    this->MarkSessionStateDirty(kSessionStateDirty_Config);
 
     // set FcntUp, FcntDown, and session state
     LMIC.datarate   = State.V1.LinkDR;
@@ -317,14 +741,10 @@ Arduino_LoRaWAN::ApplySessionState(
     LMIC.seqnoDn    = State.V1.FCntDown;
     LMIC.seqnoUp    = State.V1.FCntUp;
 
-    //
-    // TODO(tmm@mcci.com): State.V1.gpsTime can be used to tweak the saved cycle
-    // time and also as a fallback if the system clock is not robust. but right
-    // now we ignore it.
-    //
+    // take off the time that passed while we were down.
+    auto const tElapsed = this->GetSessionStateAge(State);
 
-    // conservatively set the global avail time.
-    LMIC.globalDutyAvail = tNow + State.V1.globalAvail;
+    LMIC.globalDutyAvail = tNow + reduceWait(State.V1.globalAvail, tElapsed);
 
     // set the Rx2 frequency
     LMIC.dn2Freq    = State.V1.Rx2Frequency;
@@ -387,10 +807,9 @@ Arduino_LoRaWAN::ApplySessionState(
         LMIC.bands[band].txcap = euLike.Bands[band].txDutyDenom;
         LMIC.bands[band].txpow = euLike.Bands[band].txPower;
         LMIC.bands[band].lastchnl = euLike.Bands[band].lastChannel;
-        // Heuristic; we don't know how long has passed since we saved
-        // this, because we don't currently have GPS time available.
-        // Conservatively reserve time from now.
-        LMIC.bands[band].avail = tNow + euLike.Bands[band].ostimeAvail;
+        // if we don't know how long has passed since we saved this,
+        // tElapsed is zero, and we conservatively reserve time from now.
+        LMIC.bands[band].avail = tNow + reduceWait(euLike.Bands[band].ostimeAvail, tElapsed);
         }
 
 #elif CFG_LMIC_US_like
@@ -0,0 +1,228 @@
+/*
+
+Module:	arduino_lorawan_sessionstatecodec.cpp
+
+Function:
+	Arduino_LoRaWAN::cSessionStateCodecBase methods.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN_SessionStateCodec.h>
+#include <Arduino_LoRaWAN_lmic.h>
+
+/****************************************************************************\
+|
+|	Methods
+|
+\****************************************************************************/
+
+/*
+
+Name:	Arduino_LoRaWAN::cSessionStateCodecBase::encodeCommon()
+
+Function:
+	Encode the SessionState fields that don't depend on the region.
+
+Definition:
+	protected static void Arduino_LoRaWAN::cSessionStateCodecBase::encodeCommon(
+		BitWriter_t &writer,
+		const SessionState &State
+		);
+
+Description:
+	Each field is written with the number of bits its range needs.
+	The frame counters and times are usually small (or zero), so they
+	are written with putVariable(); globalAvail may be in the past, so
+	it's written with putSigned(). Frequencies are written in 100 Hz
+	units, as the LoRaWAN MAC
+	commands carry them. Fields for LMIC features that this build
+	leaves out are not written; BuildSessionState() always leaves them
+	zero, and a non-zero value is an error (so that decoding gives back
+	exactly what was encoded).
+
+Returns:
+	No explicit result; errors are recorded in writer.
+
+*/
+
+void
+Arduino_LoRaWAN::cSessionStateCodecBase::encodeCommon(
+    BitWriter_t &writer,
+    const SessionState &State
+    )
+    {
+    auto const &s = State.V1;
+
+    writer.put(s.Region, 4);
+    writer.put(s.LinkDR, 4);
+    writer.putVariable(s.FCntUp);
+    writer.putVariable(s.FCntDown);
+    writer.putVariable(s.gpsTime);
+    writer.putSigned(s.globalAvail);
+    writer.putFrequency(s.Rx2Frequency);
+    writer.put(s.Country, 16);
+    writer.put(uint16_t(s.LinkIntegrity), 16);
+    writer.put(s.TxPower, 8);
+    writer.put(s.Redundancy, 4);
+    writer.put(s.DutyCycle, 4);
+    writer.put(s.Rx1DRoffset, 3);
+    writer.put(s.Rx2DataRate, 4);
+    writer.put(s.RxDelay, 4);
+    writer.put(s.MacRxParamAns, 8);
+    writer.put(s.MacDlChannelAns, 8);
+    writer.put(s.MacRxTimingSetupAns, 8);
+
+    // a zero-bit field is an error unless the value is zero.
+#if LMIC_ENABLE_TxParamSetupReq
+    writer.put(s.TxParam, 8);
+#else
+    writer.put(s.TxParam, 0);
+#endif
+
+#if !defined(DISABLE_BEACONS)
+    writer.put(s.BeaconChannel, 8);
+#else
+    writer.put(s.BeaconChannel, 0);
+#endif
+
+#if !defined(DISABLE_PING)
+    writer.putFrequency(s.PingFrequency);
+    writer.put(s.PingDr, 4);
+#else
+    writer.put(s.PingFrequency, 0);
+    writer.put(s.PingDr, 0);
+#endif
+    }
+
+void
+Arduino_LoRaWAN::cSessionStateCodecBase::decodeCommon(
+    BitReader_t &reader,
+    SessionState &State
+    )
+    {
+    auto &s = State.V1;
+
+    s.Region = uint8_t(reader.get(4));
+    s.LinkDR = uint8_t(reader.get(4));
+    s.FCntUp = reader.getVariable();
+    s.FCntDown = reader.getVariable();
+    s.gpsTime = reader.getVariable();
+    s.globalAvail = reader.getSigned();
+    s.Rx2Frequency = reader.getFrequency();
+    s.Country = uint16_t(reader.get(16));
+    s.LinkIntegrity = int16_t(uint16_t(reader.get(16)));
+    s.TxPower = uint8_t(reader.get(8));
+    s.Redundancy = uint8_t(reader.get(4));
+    s.DutyCycle = uint8_t(reader.get(4));
+    s.Rx1DRoffset = uint8_t(reader.get(3));
+    s.Rx2DataRate = uint8_t(reader.get(4));
+    s.RxDelay = uint8_t(reader.get(4));
+    s.MacRxParamAns = uint8_t(reader.get(8));
+    s.MacDlChannelAns = uint8_t(reader.get(8));
+    s.MacRxTimingSetupAns = uint8_t(reader.get(8));
+
+#if LMIC_ENABLE_TxParamSetupReq
+    s.TxParam = uint8_t(reader.get(8));
+#endif
+
+#if !defined(DISABLE_BEACONS)
+    s.BeaconChannel = uint8_t(reader.get(8));
+#endif
+
+#if !defined(DISABLE_PING)
+    s.PingFrequency = reader.getFrequency();
+    s.PingDr = uint8_t(reader.get(4));
+#endif
+    }
+
+bool
+Arduino_LoRaWAN::cSessionStateCodecBase::beginEncode(
+    const SessionState &State,
+    uint8_t format,
+    uint8_t *pBuffer,
+    size_t nBuffer
+    )
+    {
+    if (pBuffer == nullptr || nBuffer < kOverhead || ! State.isValid())
+        return false;
+
+    pBuffer[0] = format;
+    return true;
+    }
+
+size_t
+Arduino_LoRaWAN::cSessionStateCodecBase::endEncode(
+    const BitWriter_t &writer,
+    uint8_t *pBuffer,
+    size_t nBuffer
+    )
+    {
+    auto const nData = 1 + writer.getBytes();
+
+    if (writer.isError() || nData + 4 > nBuffer)
+        return 0;
+
+    auto const crc = Arduino_LoRaWAN::Crc32(pBuffer, nData);
+
+    pBuffer[nData + 0] = uint8_t(crc);
+    pBuffer[nData + 1] = uint8_t(crc >> 8);
+    pBuffer[nData + 2] = uint8_t(crc >> 16);
+    pBuffer[nData + 3] = uint8_t(crc >> 24);
+
+    return nData + 4;
+    }
+
+bool
+Arduino_LoRaWAN::cSessionStateCodecBase::beginDecode(
+    const uint8_t *pBuffer,
+    size_t nBuffer,
+    uint8_t format,
+    SessionState &State
+    )
+    {
+    if (pBuffer == nullptr || nBuffer < kOverhead || pBuffer[0] != format)
+        return false;
+
+    // anything not in the encoding is zero, as in BuildSessionState().
+    memset(&State, 0, sizeof(State));
+    State.V1.Tag = kSessionStateTag_V2;
+    State.V1.Size = sizeof(SessionStateV2);
+    return true;
+    }
+
+bool
+Arduino_LoRaWAN::cSessionStateCodecBase::endDecode(
+    const BitReader_t &reader,
+    const uint8_t *pBuffer,
+    size_t nBuffer,
+    SessionState &State
+    )
+    {
+    auto const nData = 1 + reader.getBytes();
+
+    if (reader.isError() || nData + 4 > nBuffer)
+        return false;
+
+    auto const crc = uint32_t(pBuffer[nData + 0]) |
+                     (uint32_t(pBuffer[nData + 1]) << 8) |
+                     (uint32_t(pBuffer[nData + 2]) << 16) |
+                     (uint32_t(pBuffer[nData + 3]) << 24);
+
+    if (crc != Arduino_LoRaWAN::Crc32(pBuffer, nData))
+        return false;
+
+    State.updateCrc();
+    return State.isValid();
+    }
@@ -38,4 +38,7 @@ Revision history:
 void Arduino_LoRaWAN::Shutdown(void)
 	{
 	LMIC_shutdown();
+
+	// nothing more will be sent; complete anything still waiting.
+	this->FlushUplinkQueue();
 	}
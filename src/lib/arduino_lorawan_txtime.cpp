@@ -0,0 +1,204 @@
+/*
+
+Module:	arduino_lorawan_txtime.cpp
+
+Function:
+	Arduino_LoRaWAN::GetNextTxTime() and related methods.
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN.h>
+#include <Arduino_LoRaWAN_lmic.h>
+
+/****************************************************************************\
+|
+|	Methods
+|
+\****************************************************************************/
+
+/*
+
+Name:	Arduino_LoRaWAN::GetMaxPayloadSize()
+
+Function:
+	Return the largest message that can be sent at the current data rate.
+
+Definition:
+	public size_t Arduino_LoRaWAN::GetMaxPayloadSize() const;
+
+Description:
+	The limit is taken from the regional table for LMIC.datarate. MAC
+	options piggybacked by the LMIC are not accounted for.
+
+Returns:
+	Maximum message size in bytes, or zero if the current data rate
+	is not known.
+
+*/
+
+size_t
+Arduino_LoRaWAN::GetMaxPayloadSize() const
+    {
+    cLMIC::DataRateInfo_t info;
+
+    if (! cLMIC::GetUplinkDataRateInfo(LMIC.datarate, info))
+        return 0;
+
+    return info.maxPayload;
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::GetTxAirtime()
+
+Function:
+	Return the time-on-air of a message at the current data rate.
+
+Definition:
+	public uint32_t Arduino_LoRaWAN::GetTxAirtime(
+		size_t nBuffer,
+		uint8_t port = 1
+		) const;
+
+Description:
+	The time-on-air of an uplink with nBuffer bytes of data is computed
+	for LMIC.datarate. The port does not change the result; it is
+	accepted to match SendBuffer().
+
+Returns:
+	Time-on-air in os_getTime() ticks (rounded up), or zero if the
+	current data rate is not known.
+
+*/
+
+uint32_t
+Arduino_LoRaWAN::GetTxAirtime(
+    size_t nBuffer,
+    uint8_t port
+    ) const
+    {
+    cLMIC::DataRateInfo_t info;
+
+    (void) port;
+    if (! cLMIC::GetUplinkDataRateInfo(LMIC.datarate, info))
+        return 0;
+
+    return us2osticksCeil(cLMIC::GetAirtimeUs(info, cLMIC::GetUplinkPhySize(nBuffer)));
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::GetNextTxTime()
+
+Function:
+	Compute the earliest time at which a message could be transmitted.
+
+Definition:
+	public bool Arduino_LoRaWAN::GetNextTxTime(
+		size_t nBuffer,
+		uint8_t port,
+		uint32_t &tNext,
+		uint32_t *pAirtime = nullptr
+		) const;
+
+Description:
+	The earliest transmit time is the latest of:
+
+	- now;
+	- the end of the global duty-cycle wait (LMIC.globalDutyAvail);
+	- in EU-like regions, the earliest time that a band with an enabled
+	  channel for the current data rate is available. This is how the
+	  LMIC chooses its next channel;
+	- if a transmit is in progress, the approximate end of its receive
+	  windows.
+
+	Messages waiting in the uplink queue are not taken into account.
+	So a sketch that wants to sleep until it can send should call
+	this when GetTxReady() is true.
+
+Returns:
+	true if the message can be sent at the current data rate, in
+	which case tNext (and *pAirtime, if given) are set. false if the
+	message is too long, or the data rate is not known; tNext is set
+	to the current time.
+
+*/
+
+bool
+Arduino_LoRaWAN::GetNextTxTime(
+    size_t nBuffer,
+    uint8_t port,
+    uint32_t &tNext,
+    uint32_t *pAirtime
+    ) const
+    {
+    const ostime_t tNow = os_getTime();
+    cLMIC::DataRateInfo_t info;
+
+    (void) port;
+    tNext = tNow;
+    if (! cLMIC::GetUplinkDataRateInfo(LMIC.datarate, info) ||
+        nBuffer > info.maxPayload)
+        return false;
+
+    if (pAirtime != nullptr)
+        *pAirtime = us2osticksCeil(cLMIC::GetAirtimeUs(info, cLMIC::GetUplinkPhySize(nBuffer)));
+
+    ostime_t tEarliest = tNow;
+    auto const fnNotBefore =
+        [&tEarliest](ostime_t t) -> void
+            {
+            if (int32_t(t - tEarliest) > 0)
+                tEarliest = t;
+            };
+
+    fnNotBefore(LMIC.globalDutyAvail);
+
+#if CFG_LMIC_EU_like
+    {
+    bool fFound = false;
+    ostime_t tBand = tNow;
+
+    for (unsigned ch = 0; ch < MAX_CHANNELS; ++ch)
+        {
+        if ((LMIC.channelMap & (1 << ch)) == 0 ||
+            LMIC.channelFreq[ch] == 0 ||
+            (LMIC.channelDrMap[ch] & (1 << (LMIC.datarate & 0xF))) == 0)
+            continue;
+
+        // the LMIC keeps the band index in the low bits of the frequency.
+        auto const tAvail = LMIC.bands[LMIC.channelFreq[ch] & 0x3].avail;
+
+        if (! fFound || int32_t(tAvail - tBand) < 0)
+            tBand = tAvail;
+        fFound = true;
+        }
+
+    if (fFound)
+        fnNotBefore(tBand);
+    }
+#endif
+
+    if ((LMIC.opmode & OP_TXRXPEND) != 0)
+        {
+        // RX2 opens RxDelay + 1 seconds after the end of the uplink.
+        auto const rxDelay = LMIC.rxDelay != 0 ? LMIC.rxDelay : 1;
+
+        fnNotBefore(LMIC.txend + sec2osticks(rxDelay + 1));
+        }
+
+    tNext = tEarliest;
+    return true;
+    }
@@ -0,0 +1,393 @@
+/*
+
+Module:	arduino_lorawan_uplinkqueue.cpp
+
+Function:
+	The uplink queue behind Arduino_LoRaWAN::SendBuffer().
+
+Copyright and License:
+	This file copyright (C) 2026 by
+
+		MCCI Corporation
+		3520 Krums Corners Road
+		Ithaca, NY  14850
+
+	See accompanying LICENSE file for copyright and license information.
+
+Author:
+	Terry Moore, MCCI Corporation	October 2026
+
+*/
+
+#include <Arduino_LoRaWAN.h>
+#include <Arduino_LoRaWAN_lmic.h>
+
+/****************************************************************************\
+|
+|	Local functions
+|
+\****************************************************************************/
+
+// return true if tDeadline is set and tNow is past it.
+static inline bool
+isDeadlinePast(uint32_t tDeadline, uint32_t tNow)
+    {
+    return tDeadline != 0 && int32_t(tNow - tDeadline) > 0;
+    }
+
+/****************************************************************************\
+|
+|	Queue methods
+|
+\****************************************************************************/
+
+/*
+
+Name:	Arduino_LoRaWAN::QueueUplink()
+
+Function:
+	Start or queue an uplink for SendBuffer() and SendBufferNoCopy().
+
+Definition:
+	private bool Arduino_LoRaWAN::QueueUplink(
+		const uint8_t *pBuffer,
+		size_t nBuffer,
+		SendBufferCbFn *pDoneFn,
+		void *pDoneCtx,
+		bool fConfirmed,
+		uint8_t port,
+		UplinkPriority priority,
+		uint32_t tDeadline,
+		bool fCopy
+		);
+
+Description:
+	If the LMIC is idle and nothing is waiting, the message is handed
+	straight to the LMIC (which copies the data). Otherwise, the message
+	is added to the uplink queue. If fCopy is true, the data is
+	copied into the queue entry; otherwise the entry refers to the
+	caller's buffer.
+
+	If the queue is full, expired messages are dropped first. If it's
+	still full, the newest message with the lowest priority is dropped,
+	provided its priority is lower than that of the new message.
+
+	If the message doesn't fit, can't be queued, or its deadline has
+	already passed, pDoneFn is called with fSuccess false.
+
+Returns:
+	true if the message was started or queued, false if it was
+	completed with an error.
+
+*/
+
+bool
+Arduino_LoRaWAN::QueueUplink(
+    const uint8_t *pBuffer,
+    size_t nBuffer,
+    SendBufferCbFn *pDoneFn,
+    void *pDoneCtx,
+    bool fConfirmed,
+    uint8_t port,
+    UplinkPriority priority,
+    uint32_t tDeadline,
+    bool fCopy
+    )
+    {
+    bool fOk = ! isDeadlinePast(tDeadline, os_getTime());
+
+    if (fOk && this->GetTxReady())
+        {
+        return this->SubmitUplink(pBuffer, nBuffer, pDoneFn, pDoneCtx, fConfirmed, port);
+        }
+
+    if (nBuffer > MAX_LEN_PAYLOAD ||
+        (fCopy && nBuffer > kUplinkQueueBufferSize))
+        fOk = false;
+
+    if (fOk && this->m_nUplinkQueue >= kUplinkQueueDepth)
+        {
+        this->ExpireUplinkQueue();
+        }
+
+    if (fOk && this->m_nUplinkQueue >= kUplinkQueueDepth)
+        {
+        // find the victim: lowest priority, and newest within that.
+        UplinkQueueEntry_t *pVictim = nullptr;
+
+        for (auto &e : this->m_UplinkQueue)
+            {
+            if (! e.fInUse)
+                continue;
+            if (pVictim == nullptr ||
+                e.priority < pVictim->priority ||
+                (e.priority == pVictim->priority &&
+                 int32_t(e.uSeq - pVictim->uSeq) > 0))
+                pVictim = &e;
+            }
+
+        if (pVictim != nullptr && pVictim->priority < priority)
+            this->CompleteUplink(pVictim, false);
+        else
+            fOk = false;
+        }
+
+    // the completion above might have queued something; check again.
+    if (fOk && this->m_nUplinkQueue >= kUplinkQueueDepth)
+        fOk = false;
+
+    if (! fOk)
+        {
+        if (pDoneFn)
+            (*pDoneFn)(pDoneCtx, false);
+        return false;
+        }
+
+    UplinkQueueEntry_t *pEntry = nullptr;
+
+    for (auto &e : this->m_UplinkQueue)
+        {
+        if (! e.fInUse)
+            {
+            pEntry = &e;
+            break;
+            }
+        }
+
+    // can't happen if m_nUplinkQueue is right; don't trust it.
+    if (pEntry == nullptr)
+        {
+        if (pDoneFn)
+            (*pDoneFn)(pDoneCtx, false);
+        return false;
+        }
+
+    if (fCopy)
+        {
+        std::memcpy(pEntry->Buffer, pBuffer, nBuffer);
+        pEntry->pBuffer = pEntry->Buffer;
+        }
+    else
+        {
+        pEntry->pBuffer = pBuffer;
+        }
+
+    pEntry->nBuffer = uint8_t(nBuffer);
+    pEntry->pDoneFn = pDoneFn;
+    pEntry->pDoneCtx = pDoneCtx;
+    pEntry->fConfirmed = fConfirmed;
+    pEntry->port = port;
+    pEntry->priority = priority;
+    pEntry->tDeadline = tDeadline;
+    pEntry->uSeq = this->m_UplinkQueueSeq++;
+    pEntry->fInUse = true;
+
+    ++this->m_nUplinkQueue;
+    return true;
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::GetNextUplink()
+
+Function:
+	Find the queued message that should be sent next.
+
+Definition:
+	private Arduino_LoRaWAN::UplinkQueueEntry_t *
+		Arduino_LoRaWAN::GetNextUplink();
+
+Description:
+	The queue is scanned for the message with the highest priority;
+	among messages of that priority, the oldest is chosen.
+
+Returns:
+	Pointer to the entry, or nullptr if the queue is empty.
+
+*/
+
+Arduino_LoRaWAN::UplinkQueueEntry_t *
+Arduino_LoRaWAN::GetNextUplink()
+    {
+    UplinkQueueEntry_t *pResult = nullptr;
+
+    for (auto &e : this->m_UplinkQueue)
+        {
+        if (! e.fInUse)
+            continue;
+        if (pResult == nullptr ||
+            e.priority > pResult->priority ||
+            (e.priority == pResult->priority &&
+             int32_t(e.uSeq - pResult->uSeq) < 0))
+            pResult = &e;
+        }
+
+    return pResult;
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::CompleteUplink()
+
+Function:
+	Remove a message from the uplink queue and complete it.
+
+Definition:
+	private void Arduino_LoRaWAN::CompleteUplink(
+		UplinkQueueEntry_t *pEntry,
+		bool fSuccess
+		);
+
+Description:
+	The entry is freed, and then the completion function (if any) is
+	called. The completion function may queue another message, which
+	may reuse the entry.
+
+Returns:
+	No explicit result.
+
+*/
+
+void
+Arduino_LoRaWAN::CompleteUplink(
+    UplinkQueueEntry_t *pEntry,
+    bool fSuccess
+    )
+    {
+    auto const pDoneFn = pEntry->pDoneFn;
+    auto const pDoneCtx = pEntry->pDoneCtx;
+
+    pEntry->fInUse = false;
+    --this->m_nUplinkQueue;
+
+    if (pDoneFn)
+        (*pDoneFn)(pDoneCtx, fSuccess);
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::ExpireUplinkQueue()
+
+Function:
+	Drop queued messages whose deadline has passed.
+
+Definition:
+	private void Arduino_LoRaWAN::ExpireUplinkQueue();
+
+Description:
+	Each message whose deadline has passed is removed from the queue
+	and completed with fSuccess false, so that it never uses airtime.
+
+Returns:
+	No explicit result.
+
+*/
+
+void
+Arduino_LoRaWAN::ExpireUplinkQueue()
+    {
+    for (auto &e : this->m_UplinkQueue)
+        {
+        if (e.fInUse && isDeadlinePast(e.tDeadline, os_getTime()))
+            this->CompleteUplink(&e, false);
+        }
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::ProcessUplinkQueue()
+
+Function:
+	Drop expired messages, and start the next message in the uplink
+	queue, if possible.
+
+Definition:
+	private void Arduino_LoRaWAN::ProcessUplinkQueue();
+
+Description:
+	Expired messages are completed with fSuccess false. Then, if the
+	LMIC is idle, the highest-priority queued message is removed from
+	the queue and handed to the LMIC. If the LMIC refuses it, the message
+	is completed with fSuccess false, and we try the next one.
+
+	This is called from the SendBuffer() completion callback and
+	from loop(). It's not called from the EV_TXCOMPLETE case of
+	StandardEventProcessor(): the LMIC reports EV_TXCOMPLETE before it
+	calls the per-message completion, so starting a message there
+	would cause the LMIC to complete the new message with the status
+	of the old one.
+
+Returns:
+	No explicit result.
+
+*/
+
+void
+Arduino_LoRaWAN::ProcessUplinkQueue()
+    {
+    this->ExpireUplinkQueue();
+
+    while (this->m_nUplinkQueue != 0)
+        {
+        // don't start if a message (ours, or one the LMIC generated) is
+        // still in progress.
+        if (this->m_SendBufferData.fTxPending ||
+            (LMIC.opmode & (OP_TXRXPEND | OP_TXDATA)) != 0)
+            return;
+
+        auto const pEntry = this->GetNextUplink();
+
+        // expiry is checked once more, right before using airtime.
+        if (isDeadlinePast(pEntry->tDeadline, os_getTime()))
+            {
+            this->CompleteUplink(pEntry, false);
+            continue;
+            }
+
+        // take the entry off the queue before submitting, so that a
+        // completion function can queue another message. The LMIC
+        // copies the data before any completion function can run, so
+        // it's safe for the entry to be reused.
+        pEntry->fInUse = false;
+        --this->m_nUplinkQueue;
+
+        if (this->SubmitUplink(
+                pEntry->pBuffer,
+                pEntry->nBuffer,
+                pEntry->pDoneFn,
+                pEntry->pDoneCtx,
+                pEntry->fConfirmed,
+                pEntry->port
+                ))
+            return;
+        }
+    }
+
+/*
+
+Name:	Arduino_LoRaWAN::FlushUplinkQueue()
+
+Function:
+	Abandon all messages in the uplink queue.
+
+Definition:
+	private void Arduino_LoRaWAN::FlushUplinkQueue();
+
+Description:
+	Each queued message is removed, and its completion function is
+	called with fSuccess false. Messages queued by completion
+	functions during the flush are also abandoned.
+
+Returns:
+	No explicit result.
+
+*/
+
+void
+Arduino_LoRaWAN::FlushUplinkQueue()
+    {
+    while (this->m_nUplinkQueue != 0)
+        {
+        this->CompleteUplink(this->GetNextUplink(), false);
+        }
+    }